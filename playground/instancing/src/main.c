@@ -0,0 +1,113 @@
+#include "raykit.h"
+#include "raylib.h"
+#include "raymath.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define STRESS_MIN_CUBES 100
+#define STRESS_MAX_CUBES 102400
+#define STRESS_START_CUBES 6400
+#define STRESS_SPACING 1.5f
+#define STRESS_FRAMES 60
+
+// Cubes on a square grid around the origin, bobbing so every transform
+// changes each frame
+static void place_cubes(Matrix *transforms, int count, float time)
+{
+    int side = (int)ceilf(sqrtf((float)count));
+    float offset = (side - 1) * STRESS_SPACING * 0.5f;
+
+    for (int i = 0; i < count; i++)
+    {
+        float x = (i % side) * STRESS_SPACING - offset;
+        float z = (i / side) * STRESS_SPACING - offset;
+        float y = sinf(time * 2.0f + x * 0.3f + z * 0.2f) * 0.5f;
+
+        transforms[i] = MatrixMultiply(MatrixRotateY(time + i * 0.01f), MatrixTranslate(x, y, z));
+    }
+}
+
+int main(void)
+{
+    InitWindow(CONFIG_SCREEN_WIDTH, CONFIG_SCREEN_HEIGHT, "Playground - Instancing");
+
+    Mesh cube = GenMeshCube(1.0f, 1.0f, 1.0f);
+    struct Instancing instanced = create_instancing(ORANGE, true);
+    struct Instancing fallback = create_instancing(SKYBLUE, false);
+    struct RenderList list = create_render_list();
+
+    Matrix *transforms = malloc(STRESS_MAX_CUBES * sizeof(*transforms));
+    if (transforms == NULL)
+        TraceLog(LOG_FATAL, "STRESS: Failure to allocate %d transforms", STRESS_MAX_CUBES);
+
+    Camera3D camera = {
+        .position = (Vector3){60.0f, 60.0f, 60.0f},
+        .target = (Vector3){0.0f, 0.0f, 0.0f},
+        .up = (Vector3){0.0f, 1.0f, 0.0f},
+        .fovy = 45.0f,
+        .projection = CAMERA_PERSPECTIVE,
+    };
+
+    int count = STRESS_START_CUBES;
+    bool instancing = instanced.instanced;
+    // frame times over the last STRESS_FRAMES frames
+    float frames[STRESS_FRAMES] = {0};
+    int frame = 0;
+
+    while (!WindowShouldClose())
+    {
+        // Input
+        if (IsKeyPressed(KEY_UP) && count < STRESS_MAX_CUBES)
+            count *= 2;
+        if (IsKeyPressed(KEY_DOWN) && count > STRESS_MIN_CUBES)
+            count /= 2;
+        if (IsKeyPressed(KEY_I))
+            instancing = !instancing && instanced.instanced;
+
+        UpdateCamera(&camera, CAMERA_ORBITAL);
+
+        frames[frame++ % STRESS_FRAMES] = GetFrameTime();
+        float average = 0.0f;
+        float worst = 0.0f;
+        for (int i = 0; i < STRESS_FRAMES; i++)
+        {
+            average += frames[i] / STRESS_FRAMES;
+            worst = fmaxf(worst, frames[i]);
+        }
+
+        // Recording
+        reset_render_list(&list);
+
+        place_cubes(transforms, count, (float)GetTime());
+        record_instances(&list, &cube, instancing ? &instanced : &fallback, transforms, count);
+        record_grid(&list, 100, STRESS_SPACING);
+
+        record_fps(&list, 10, 10);
+        record_text(&list, TextFormat("Cubes: %d (UP / DOWN)", count), 10, 36, 20, RAYWHITE);
+        record_text(&list,
+                    TextFormat("Path: %s (I)", instancing ? "DrawMeshInstanced" : "one DrawMesh per cube"), 10, 60,
+                    20, RAYWHITE);
+        record_text(&list, TextFormat("Frame: %.2f ms average, %.2f ms worst", average * 1000.0f, worst * 1000.0f),
+                    10, 84, 20, RAYWHITE);
+        // the list is sorted when drawn, so these are the last frame's
+        record_text(&list, TextFormat("Draw calls: %d", list.stats.draw_calls), 10, 108, 20, RAYWHITE);
+
+        // Drawing
+        BeginDrawing();
+        ClearBackground(CONFIG_SCREEN_BACKGROUND_COLOR);
+
+        flush_render_list(&list, &camera);
+
+        EndDrawing();
+    }
+
+    free(transforms);
+    destroy_render_list(&list);
+    destroy_instancing(&fallback);
+    destroy_instancing(&instanced);
+    UnloadMesh(cube);
+    CloseWindow();
+
+    return 0;
+}
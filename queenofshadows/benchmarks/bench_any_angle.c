@@ -0,0 +1,150 @@
+// bench_any_angle.c
+// String pulling A* paths on generated open maps: cost of the pass against
+// the search, waypoints kept and path length in tiles before and after.
+// Reports a mismatch if a pulled segment crosses a blocked tile.
+#include "path.h"
+#include "timings.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUERIES 200
+// samples per tile when walking a segment to verify it
+#define SAMPLES 16
+
+static const int sizes[] = {256, 512};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// open map: small rectangular blocks over ~10% of the tiles, some water
+static void generate_open(struct World *world, uint32_t *seed)
+{
+    int blocks = world->width * world->height / 100;
+
+    world_init(world);
+    for (int i = 0; i < blocks; i++)
+    {
+        int x0 = next(seed) % world->width;
+        int y0 = next(seed) % world->height;
+        int w = 1 + next(seed) % 4;
+        int h = 1 + next(seed) % 4;
+        bool water = next(seed) % 4 == 0;
+
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++)
+            {
+                if (water)
+                    set_terrain(world, x, y, TERRAIN_WATER);
+                else
+                    set_walkable(world, x, y, false);
+            }
+    }
+}
+
+// Length in tiles of the polyline from (startX, startY) through the path
+static double length_path(const struct PathScratch *scratch, int width, int startX, int startY)
+{
+    double total = 0;
+    int x = startX, y = startY;
+
+    for (int i = 0; i < scratch->length; i++)
+    {
+        int nx = scratch->path[i] % width;
+        int ny = scratch->path[i] / width;
+        total += sqrt((double)(nx - x) * (nx - x) + (double)(ny - y) * (ny - y));
+        x = nx;
+        y = ny;
+    }
+
+    return total;
+}
+
+// Every sample along every segment lies on a walkable tile
+static bool walkable_path(const struct PathScratch *scratch, const struct World *world, int startX, int startY)
+{
+    int x = startX, y = startY;
+
+    for (int i = 0; i < scratch->length; i++)
+    {
+        int nx = scratch->path[i] % world->width;
+        int ny = scratch->path[i] / world->width;
+        int steps = SAMPLES * (abs(nx - x) + abs(ny - y));
+
+        for (int s = 1; s <= steps; s++)
+        {
+            double t = (double)s / steps;
+            int tx = (int)floor(x + (nx - x) * t + 0.5);
+            int ty = (int)floor(y + (ny - y) * t + 0.5);
+            if (!is_walkable(world, tx, ty))
+                return false;
+        }
+        x = nx;
+        y = ny;
+    }
+
+    return true;
+}
+
+static void bench(int size)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    uint32_t seed = 0x2545f491u ^ (uint32_t)size;
+    const struct PathOptions astar = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+    double search = 0, pull = 0, before = 0, after = 0;
+    long tiles = 0, waypoints = 0;
+    int mismatches = 0, queries = 0;
+
+    generate_open(&world, &seed);
+
+    while (queries < QUERIES)
+    {
+        int x = next(&seed) % size;
+        int y = next(&seed) % size;
+        int goalX = next(&seed) % size;
+        int goalY = next(&seed) % size;
+
+        if (!is_walkable(&world, x, y))
+            continue;
+
+        double t = now_timings();
+        if (!search_path(&scratch, &world, &astar, x, y, goalX, goalY))
+            continue;
+        search += now_timings() - t;
+
+        tiles += scratch.length;
+        before += length_path(&scratch, size, x, y);
+
+        t = now_timings();
+        pull_path(&scratch, &world, x, y);
+        pull += now_timings() - t;
+
+        waypoints += scratch.length;
+        after += length_path(&scratch, size, x, y);
+        mismatches += !walkable_path(&scratch, &world, x, y);
+        queries++;
+    }
+
+    printf("%5dx%-5d | search %8.3f ms | pull %8.3f us | nodes %7.1f -> %5.1f (%4.1f%%) | length %7.1f -> %7.1f tiles%s\n",
+           size, size, search * 1e3 / queries, pull * 1e6 / queries, (double)tiles / queries,
+           (double)waypoints / queries, 100.0 * waypoints / tiles, before / queries, after / queries,
+           mismatches ? " MISMATCH" : "");
+
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+
+    return 0;
+}
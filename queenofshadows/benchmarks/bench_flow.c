@@ -0,0 +1,145 @@
+// bench_flow.c
+// One flow field against N individual A* searches to the same goal on
+// generated open maps, N = 10..10000, and the per unit cost of sampling the
+// field. Reports a mismatch if a field cost differs from the A* path cost.
+#include "flow.h"
+#include "path.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BUILDS 10
+
+static const int sizes[] = {256, 512};
+static const int units[] = {10, 100, 1000, 10000};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// open map: small rectangular blocks over ~10% of the tiles, some water
+static void generate_open(struct World *world, uint32_t *seed)
+{
+    int blocks = world->width * world->height / 100;
+
+    world_init(world);
+    for (int i = 0; i < blocks; i++)
+    {
+        int x0 = next(seed) % world->width;
+        int y0 = next(seed) % world->height;
+        int w = 1 + next(seed) % 4;
+        int h = 1 + next(seed) % 4;
+        bool water = next(seed) % 4 == 0;
+
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++)
+            {
+                if (water)
+                    set_terrain(world, x, y, TERRAIN_WATER);
+                else
+                    set_walkable(world, x, y, false);
+            }
+    }
+}
+
+static void bench(int size)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    uint32_t seed = 0x2545f491u ^ (uint32_t)size;
+    int goalX, goalY;
+
+    generate_open(&world, &seed);
+    do
+    {
+        goalX = next(&seed) % size;
+        goalY = next(&seed) % size;
+    } while (!is_walkable(&world, goalX, goalY));
+
+    struct FlowCache *cache = create_flow_cache(&world);
+    const struct FlowField *flow = get_flow(cache, goalX, goalY);
+
+    // every edit invalidates the field, so each request rebuilds it
+    double t = now_timings();
+    for (int i = 0; i < BUILDS; i++)
+    {
+        set_terrain(&world, 0, 0, get_terrain(&world, 0, 0));
+        set_walkable(&world, 0, 0, !is_walkable(&world, 0, 0));
+        set_walkable(&world, 0, 0, !is_walkable(&world, 0, 0));
+        flow = get_flow(cache, goalX, goalY);
+    }
+    double build = (now_timings() - t) / BUILDS;
+    printf("%5dx%-5d | field %9.3f ms\n", size, size, build * 1e3);
+
+    const struct PathOptions astar = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+    int count = units[sizeof(units) / sizeof(units[0]) - 1];
+    int *starts = malloc((size_t)count * sizeof(*starts));
+    Vector3 *positions = malloc((size_t)count * sizeof(*positions));
+    if (starts == NULL || positions == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int x, y;
+        do
+        {
+            x = next(&seed) % size;
+            y = next(&seed) % size;
+        } while (!is_walkable(&world, x, y));
+        starts[i] = y * size + x;
+        positions[i] = grid_to_world(&world, x, y);
+    }
+
+    for (size_t u = 0; u < sizeof(units) / sizeof(units[0]); u++)
+    {
+        int mismatches = 0;
+
+        t = now_timings();
+        for (int i = 0; i < units[u]; i++)
+        {
+            bool found = search_path(&scratch, &world, &astar, starts[i] % size, starts[i] / size, goalX, goalY);
+
+            int32_t total = found ? 0 : INT32_MAX;
+            for (int k = 0; k < scratch.length && found; k++)
+                total += PATH_COST_STRAIGHT * movement_cost(&world, scratch.path[k] % size, scratch.path[k] / size);
+            mismatches += total != flow->cost[starts[i]];
+        }
+        double elapsed = now_timings() - t;
+
+        printf("            | %5d searches %9.3f ms %7.1fx field%s\n", units[u], elapsed * 1e3, elapsed / build,
+               mismatches ? " MISMATCH" : "");
+    }
+
+    // one frame of every unit reading its next tile
+    Vector3 sum = {0};
+    t = now_timings();
+    for (int i = 0; i < count; i++)
+    {
+        Vector3 target = next_flow(flow, positions[i]);
+        sum.x += target.x;
+        sum.z += target.z;
+    }
+    printf("            | sample %8.1f ns per unit (%.0f)\n", (now_timings() - t) * 1e9 / count, sum.x + sum.z);
+
+    free(starts);
+    free(positions);
+    destroy_flow_cache(cache);
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+
+    return 0;
+}
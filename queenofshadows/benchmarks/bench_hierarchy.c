@@ -0,0 +1,153 @@
+// bench_hierarchy.c
+// HPA* against A* on generated open maps: query latency, path cost over
+// the optimal cost, first build of the clusters and the rebuild cost after
+// a single tile edit. Both searches must agree on which goals are reachable.
+#include "hierarchy.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUERIES 100
+#define EDITS 1000
+
+static const int sizes[] = {256, 1024, 2048};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// open map: small rectangular blocks over ~10% of the tiles
+static void generate_open(struct World *world, uint32_t *seed)
+{
+    int blocks = world->width * world->height / 100;
+
+    world_init(world);
+    for (int i = 0; i < blocks; i++)
+    {
+        int x0 = next(seed) % world->width;
+        int y0 = next(seed) % world->height;
+        int w = 1 + next(seed) % 4;
+        int h = 1 + next(seed) % 4;
+
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++)
+                set_walkable(world, x, y, false);
+    }
+}
+
+// cost of a tile path from start, -1 if a step is not a walkable neighbour
+static int cost(const struct World *world, const struct PathScratch *scratch, int start)
+{
+    int total = 0;
+
+    for (int i = 0, previous = start; i < scratch->length; previous = scratch->path[i++])
+    {
+        int x = scratch->path[i] % world->width;
+        int y = scratch->path[i] / world->width;
+        if (abs(x - previous % world->width) + abs(y - previous / world->width) != 1 || !is_walkable(world, x, y))
+            return -1;
+        total += PATH_COST_STRAIGHT * movement_cost(world, x, y);
+    }
+
+    return total;
+}
+
+static void bench(int size)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    uint32_t seed = 0x2545f491u ^ (uint32_t)size;
+    int tiles = size * size;
+    int starts[QUERIES], goals[QUERIES], expected[QUERIES];
+    const struct PathOptions astar = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+
+    generate_open(&world, &seed);
+
+    for (int i = 0; i < QUERIES; i++)
+    {
+        do
+            starts[i] = next(&seed) % tiles;
+        while (!is_walkable(&world, starts[i] % size, starts[i] / size));
+        do
+            goals[i] = next(&seed) % tiles;
+        while (!is_walkable(&world, goals[i] % size, goals[i] / size) || goals[i] == starts[i]);
+    }
+
+    // warm up: first touch of the scratch pages
+    for (int i = 0; i < QUERIES; i++)
+        search_path(&scratch, &world, &astar, starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+
+    double t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+    {
+        bool found = search_path(&scratch, &world, &astar, starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+        expected[i] = found ? cost(&world, &scratch, starts[i]) : -1;
+    }
+    printf("%5dx%-5d | astar %8.3f ms\n", size, size, (now_timings() - t) * 1e3 / QUERIES);
+
+    struct Hierarchy *hierarchy = create_hierarchy(&world);
+
+    // first pass builds the clusters the queries touch
+    t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+        search_hierarchy(hierarchy, &scratch, starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+    printf("            | build %8.3f ms %8d clusters\n", (now_timings() - t) * 1e3, hierarchy->rebuilt);
+
+    long expanded = 0;
+    double ratio = 0;
+    int mismatches = 0, compared = 0;
+
+    t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+    {
+        bool found = search_hierarchy(hierarchy, &scratch, starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+        int total = found ? cost(&world, &scratch, starts[i]) : -1;
+        expanded += hierarchy->expanded;
+
+        if ((total < 0) != (expected[i] < 0) || (found && total < 0))
+            mismatches++;
+        else if (total > 0)
+        {
+            ratio += (double)total / expected[i];
+            compared++;
+        }
+    }
+    double elapsed = now_timings() - t;
+
+    printf("            | hpa   %8.3f ms %8ld expanded %6.3f cost ratio%s\n", elapsed * 1e3 / QUERIES, expanded / QUERIES,
+           compared ? ratio / compared : 0.0, mismatches ? " MISMATCH" : "");
+
+    // one tile toggled, then one query to pay for the rebuild
+    int rebuilt = hierarchy->rebuilt;
+    t = now_timings();
+    for (int i = 0; i < EDITS; i++)
+    {
+        int x = next(&seed) % size;
+        int y = next(&seed) % size;
+        int q = i % QUERIES;
+
+        set_walkable(&world, x, y, !is_walkable(&world, x, y));
+        search_hierarchy(hierarchy, &scratch, starts[q] % size, starts[q] / size, goals[q] % size, goals[q] / size);
+    }
+    elapsed = now_timings() - t;
+
+    printf("            | edit  %8.3f ms %8.2f clusters rebuilt per edit, query included\n", elapsed * 1e3 / EDITS,
+           (double)(hierarchy->rebuilt - rebuilt) / EDITS);
+
+    destroy_hierarchy(hierarchy);
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+// bench_jps.c
+// Jump Point Search against the previous 4 neighbour BFS and A* on
+// generated open maps (sparse blocks) and maze maps. JPS on 4 neighbours
+// must match the BFS length, JPS on 8 neighbours the A* cost.
+#include "path.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUERIES 100
+
+static const int sizes[] = {256, 1024};
+
+enum Map
+{
+    MAP_OPEN,
+    MAP_MAZE,
+};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// previous find_path: BFS over 4 neighbours, returns steps or -1
+static int bfs(const struct World *world, int *queue, int *distance, int start, int goal)
+{
+    int width = world->width;
+    int head = 0, tail = 0;
+    const int dx[] = {0, 0, -1, 1};
+    const int dy[] = {-1, 1, 0, 0};
+
+    for (int i = 0; i < world->width * world->height; i++)
+        distance[i] = -1;
+
+    queue[tail++] = start;
+    distance[start] = 0;
+
+    while (head < tail)
+    {
+        int current = queue[head++];
+        if (current == goal)
+            return distance[current];
+
+        for (int i = 0; i < 4; i++)
+        {
+            int x = current % width + dx[i];
+            int y = current / width + dy[i];
+            if (is_walkable(world, x, y) && distance[y * width + x] < 0)
+            {
+                distance[y * width + x] = distance[current] + 1;
+                queue[tail++] = y * width + x;
+            }
+        }
+    }
+
+    return -1;
+}
+
+// open map: small rectangular blocks over ~10% of the tiles
+static void generate_open(struct World *world, uint32_t *seed)
+{
+    int blocks = world->width * world->height / 100;
+
+    world_init(world);
+    for (int i = 0; i < blocks; i++)
+    {
+        int x0 = next(seed) % world->width;
+        int y0 = next(seed) % world->height;
+        int w = 1 + next(seed) % 4;
+        int h = 1 + next(seed) % 4;
+
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++)
+                set_walkable(world, x, y, false);
+    }
+}
+
+// maze: iterative backtracker carving corridors between odd cells
+static void generate_maze(struct World *world, uint32_t *seed, int *stack)
+{
+    int width = world->width;
+    int height = world->height;
+    int top = 0;
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            set_walkable(world, x, y, false);
+
+    set_walkable(world, 1, 1, true);
+    stack[top++] = 1 * width + 1;
+
+    while (top > 0)
+    {
+        int cell = stack[top - 1];
+        int x = cell % width;
+        int y = cell / width;
+        int options[4], count = 0;
+        const int cx[] = {0, 0, -2, 2};
+        const int cy[] = {-2, 2, 0, 0};
+
+        for (int i = 0; i < 4; i++)
+        {
+            int nx = x + cx[i];
+            int ny = y + cy[i];
+            if (nx > 0 && ny > 0 && nx < width - 1 && ny < height - 1 && !is_walkable(world, nx, ny))
+                options[count++] = i;
+        }
+
+        if (count == 0)
+        {
+            top--;
+            continue;
+        }
+
+        int i = options[next(seed) % count];
+        set_walkable(world, x + cx[i] / 2, y + cy[i] / 2, true);
+        set_walkable(world, x + cx[i], y + cy[i], true);
+        stack[top++] = (y + cy[i]) * width + x + cx[i];
+    }
+}
+
+// cost of a tile path from start, straight 10 and diagonal 14
+static int cost(const struct PathScratch *scratch, int width, int start)
+{
+    int total = 0;
+
+    for (int i = 0, previous = start; i < scratch->length; previous = scratch->path[i++])
+    {
+        bool diagonal = scratch->path[i] % width != previous % width && scratch->path[i] / width != previous / width;
+        total += diagonal ? PATH_COST_DIAGONAL : PATH_COST_STRAIGHT;
+    }
+
+    return total;
+}
+
+static void bench(int size, enum Map map)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    uint32_t seed = 0x2545f491u ^ (uint32_t)(size * 7 + map);
+    int tiles = size * size;
+    int *queue = malloc((size_t)tiles * sizeof(int));
+    int *distance = malloc((size_t)tiles * sizeof(int));
+    int starts[QUERIES], goals[QUERIES], expected[QUERIES], expected_cost[QUERIES];
+
+    if (queue == NULL || distance == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (map == MAP_OPEN)
+        generate_open(&world, &seed);
+    else
+        generate_maze(&world, &seed, queue);
+
+    for (int i = 0; i < QUERIES; i++)
+    {
+        do
+            starts[i] = next(&seed) % tiles;
+        while (!is_walkable(&world, starts[i] % size, starts[i] / size));
+        do
+            goals[i] = next(&seed) % tiles;
+        while (!is_walkable(&world, goals[i] % size, goals[i] / size) || goals[i] == starts[i]);
+    }
+
+    double t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+        expected[i] = bfs(&world, queue, distance, starts[i], goals[i]);
+    printf("%5dx%-5d %-4s | bfs4 %8.3f ms\n", size, size, map == MAP_OPEN ? "open" : "maze", (now_timings() - t) * 1e3 / QUERIES);
+
+    const struct PathOptions modes[] = {
+        {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN},
+        {.mode = PATH_JPS, .heuristic = HEURISTIC_MANHATTAN},
+        {.mode = PATH_ASTAR, .heuristic = HEURISTIC_OCTILE, .diagonal = true},
+        {.mode = PATH_JPS, .heuristic = HEURISTIC_OCTILE, .diagonal = true},
+    };
+    const char *names[] = {"astar4", "jps4", "astar8", "jps8"};
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        long expanded = 0;
+        int mismatches = 0;
+
+        // warm up: first touch of the scratch pages
+        for (int i = 0; i < QUERIES; i++)
+            search_path(&scratch, &world, &modes[m], starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+
+        t = now_timings();
+        for (int i = 0; i < QUERIES; i++)
+        {
+            bool found = search_path(&scratch, &world, &modes[m], starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+            expanded += scratch.expanded;
+
+            // 4 neighbours: BFS length, 8 neighbours: cost of the A* run
+            if (!modes[m].diagonal)
+                mismatches += (found ? scratch.length : -1) != expected[i];
+            else if (modes[m].mode == PATH_ASTAR)
+                expected_cost[i] = found ? cost(&scratch, size, starts[i]) : -1;
+            else
+                mismatches += (found ? cost(&scratch, size, starts[i]) : -1) != expected_cost[i];
+        }
+        double elapsed = now_timings() - t;
+
+        printf("                 | %-6s %8.3f ms %8ld expanded%s\n", names[m], elapsed * 1e3 / QUERIES, expanded / QUERIES,
+               mismatches ? " MISMATCH" : "");
+    }
+
+    free(queue);
+    free(distance);
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        bench(sizes[i], MAP_OPEN);
+        bench(sizes[i], MAP_MAZE);
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// bench_path.c
+// A* against the previous unweighted BFS on generated maps. Checks that
+// path lengths match BFS on uniform cost maps.
+#include "path.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUERIES 200
+
+static const int sizes[] = {64, 256, 1024};
+// percent of blocked tiles
+static const int densities[] = {0, 10, 25};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// previous find_path: BFS over 4 neighbours, returns steps or -1
+static int bfs(const struct World *world, int *queue, int *distance, int start, int goal)
+{
+    int width = world->width;
+    int head = 0, tail = 0;
+    const int dx[] = {0, 0, -1, 1};
+    const int dy[] = {-1, 1, 0, 0};
+
+    for (int i = 0; i < world->width * world->height; i++)
+        distance[i] = -1;
+
+    queue[tail++] = start;
+    distance[start] = 0;
+
+    while (head < tail)
+    {
+        int current = queue[head++];
+        if (current == goal)
+            return distance[current];
+
+        for (int i = 0; i < 4; i++)
+        {
+            int x = current % width + dx[i];
+            int y = current / width + dy[i];
+            if (is_walkable(world, x, y) && distance[y * width + x] < 0)
+            {
+                distance[y * width + x] = distance[current] + 1;
+                queue[tail++] = y * width + x;
+            }
+        }
+    }
+
+    return -1;
+}
+
+static void generate(struct World *world, int density, uint32_t *seed)
+{
+    world_init(world);
+    for (int y = 0; y < world->height; y++)
+        for (int x = 0; x < world->width; x++)
+            if ((int)(next(seed) % 100) < density)
+                set_walkable(world, x, y, false);
+}
+
+static void bench(int size, int density)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    uint32_t seed = 0x12345678u ^ (uint32_t)(size * 131 + density);
+    generate(&world, density, &seed);
+
+    int tiles = size * size;
+    int *queue = malloc((size_t)tiles * sizeof(int));
+    int *distance = malloc((size_t)tiles * sizeof(int));
+    int starts[QUERIES], goals[QUERIES], expected[QUERIES];
+    if (queue == NULL || distance == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // walkable start and goal pairs
+    for (int i = 0; i < QUERIES; i++)
+    {
+        do
+            starts[i] = next(&seed) % tiles;
+        while (!is_walkable(&world, starts[i] % size, starts[i] / size));
+        do
+            goals[i] = next(&seed) % tiles;
+        while (!is_walkable(&world, goals[i] % size, goals[i] / size) || goals[i] == starts[i]);
+    }
+
+    double t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+        expected[i] = bfs(&world, queue, distance, starts[i], goals[i]);
+    double bfs_time = now_timings() - t;
+
+    const struct PathOptions options = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+    long expanded = 0;
+    int mismatches = 0;
+
+    // warm up: first touch of the scratch pages
+    for (int i = 0; i < QUERIES; i++)
+        search_path(&scratch, &world, &options, starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+
+    t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+    {
+        bool found = search_path(&scratch, &world, &options, starts[i] % size, starts[i] / size, goals[i] % size, goals[i] / size);
+        int length = found ? scratch.length : -1;
+        mismatches += length != expected[i];
+        expanded += scratch.expanded;
+    }
+    double elapsed = now_timings() - t;
+
+    printf("%5dx%-5d blocked %2d%% | bfs %8.3f ms/query | astar %8.3f ms/query %7ld expanded%s\n",
+           size, size, density, bfs_time * 1e3 / QUERIES, elapsed * 1e3 / QUERIES, expanded / QUERIES,
+           mismatches ? " LENGTH MISMATCH" : "");
+
+    free(queue);
+    free(distance);
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        for (size_t j = 0; j < sizeof(densities) / sizeof(densities[0]); j++)
+            bench(sizes[i], densities[j]);
+
+    return 0;
+}
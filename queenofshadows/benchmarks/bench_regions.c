@@ -0,0 +1,117 @@
+// bench_regions.c
+// Unreachable goals: the A* flood of the whole start region against the
+// region label check, and the cost of keeping the labels up to date per
+// tile edit, on open maps split in two by a wall.
+#include "regions.h"
+#include "path.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUERIES 20
+#define CHECKS 1000000
+#define EDITS 10000
+
+static const int sizes[] = {256, 1024};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// open map with sparse blocks, a wall down the middle
+static void generate_split(struct World *world, uint32_t *seed)
+{
+    int blocks = world->width * world->height / 100;
+
+    world_init(world);
+    for (int i = 0; i < blocks; i++)
+        set_walkable(world, next(seed) % world->width, next(seed) % world->height, false);
+    for (int y = 0; y < world->height; y++)
+        set_walkable(world, world->width / 2, y, false);
+}
+
+// walkable tile on the left or right half
+static void pick(const struct World *world, uint32_t *seed, bool right, int *x, int *y)
+{
+    int half = world->width / 2;
+
+    do
+    {
+        *x = next(seed) % half + (right ? half + 1 : 0);
+        *y = next(seed) % world->height;
+    } while (!is_walkable(world, *x, *y));
+}
+
+static void bench(int size)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    const struct PathOptions astar = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+    uint32_t seed = 0x2545f491u ^ (uint32_t)size;
+    int sx[QUERIES], sy[QUERIES], ex[QUERIES], ey[QUERIES];
+
+    generate_split(&world, &seed);
+    for (int i = 0; i < QUERIES; i++)
+    {
+        pick(&world, &seed, false, &sx[i], &sy[i]);
+        pick(&world, &seed, true, &ex[i], &ey[i]);
+    }
+
+    double t = now_timings();
+    struct Regions *regions = create_regions(&world);
+    printf("%5dx%-5d | label %8.3f ms\n", size, size, (now_timings() - t) * 1e3);
+
+    int wrong = 0;
+    t = now_timings();
+    for (int i = 0; i < QUERIES; i++)
+        wrong += search_path(&scratch, &world, &astar, sx[i], sy[i], ex[i], ey[i]);
+    printf("            | astar %8.3f ms per unreachable goal\n", (now_timings() - t) * 1e3 / QUERIES);
+
+    t = now_timings();
+    for (int i = 0; i < CHECKS; i++)
+        wrong += connected_regions(regions, sx[i % QUERIES], sy[i % QUERIES], ex[i % QUERIES], ey[i % QUERIES]);
+    printf("            | label %8.1f ns per unreachable goal%s\n", (now_timings() - t) * 1e9 / CHECKS, wrong ? " MISMATCH" : "");
+
+    // random blocks toggled on and off
+    long relabelled = regions->relabelled;
+    t = now_timings();
+    for (int i = 0; i < EDITS; i++)
+    {
+        int x = next(&seed) % size;
+        int y = next(&seed) % size;
+        if (x != size / 2)
+            set_walkable(&world, x, y, !is_walkable(&world, x, y));
+    }
+    double elapsed = now_timings() - t;
+    printf("            | edit  %8.3f us %8.2f tiles relabelled per edit\n", elapsed * 1e6 / EDITS,
+           (double)(regions->relabelled - relabelled) / EDITS);
+
+    // a gap with both sides open
+    int gap = 0;
+    while (!is_walkable(&world, size / 2 - 1, gap) || !is_walkable(&world, size / 2 + 1, gap))
+        gap++;
+
+    relabelled = regions->relabelled;
+    t = now_timings();
+    set_walkable(&world, size / 2, gap, true);
+    set_walkable(&world, size / 2, gap, false);
+    printf("            | wall  %8.3f ms to join and split the halves, %ld tiles relabelled\n", (now_timings() - t) * 1e3,
+           regions->relabelled - relabelled);
+
+    destroy_regions(regions);
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+
+    return 0;
+}
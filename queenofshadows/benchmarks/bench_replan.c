@@ -0,0 +1,176 @@
+// bench_replan.c
+// Repairing a D* Lite path after a wall is dropped across it, against a
+// fresh A* search, by distance of the edit from the unit, on generated open
+// maps. Reports a mismatch if a repaired cost differs from the A* path cost.
+#include "replanner.h"
+#include "path.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROUNDS 50
+// half length of the wall dropped across the path
+#define WALL 6
+
+static const int sizes[] = {256, 512};
+static const int distances[] = {1, 4, 16, 64, 256};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// open map: small rectangular blocks over ~10% of the tiles, some water
+static void generate_open(struct World *world, uint32_t *seed)
+{
+    int blocks = world->width * world->height / 100;
+
+    world_init(world);
+    for (int i = 0; i < blocks; i++)
+    {
+        int x0 = next(seed) % world->width;
+        int y0 = next(seed) % world->height;
+        int w = 1 + next(seed) % 4;
+        int h = 1 + next(seed) % 4;
+        bool water = next(seed) % 4 == 0;
+
+        for (int y = y0; y < y0 + h; y++)
+            for (int x = x0; x < x0 + w; x++)
+            {
+                if (water)
+                    set_terrain(world, x, y, TERRAIN_WATER);
+                else
+                    set_walkable(world, x, y, false);
+            }
+    }
+}
+
+static int32_t astar_cost(struct PathScratch *scratch, const struct World *world, int x, int y, int goalX, int goalY)
+{
+    const struct PathOptions astar = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+
+    if (!search_path(scratch, world, &astar, x, y, goalX, goalY))
+        return INT32_MAX;
+
+    int32_t total = 0;
+    for (int k = 0; k < scratch->length; k++)
+        total += PATH_COST_STRAIGHT * movement_cost(world, scratch->path[k] % world->width, scratch->path[k] / world->width);
+    return total;
+}
+
+// Wall of walkable tiles across the step from (x, y) to (nx, ny), centred
+// on (nx, ny); its tiles are written to wall, returns how many
+static int drop_wall(struct World *world, int x, int y, int nx, int ny, int *wall)
+{
+    int count = 0;
+
+    for (int i = -WALL; i <= WALL; i++)
+    {
+        int wx = nx + (ny != y) * i;
+        int wy = ny + (nx != x) * i;
+        if (!is_walkable(world, wx, wy))
+            continue;
+
+        set_walkable(world, wx, wy, false);
+        wall[count++] = wy * world->width + wx;
+    }
+
+    return count;
+}
+
+static void bench(int size)
+{
+    struct World world = create_world(size, size);
+    struct PathScratch scratch = create_path_scratch();
+    struct Replanner *replanner = create_replanner(&world);
+    uint32_t seed = 0x2545f491u ^ (uint32_t)size;
+    int wall[2 * WALL + 1];
+
+    generate_open(&world, &seed);
+    printf("%5dx%-5d | distance |    repair ms  expanded |     A* ms  expanded\n", size, size);
+
+    for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++)
+    {
+        double repair = 0, search = 0;
+        long repaired = 0, searched = 0;
+        int mismatches = 0, rounds = 0;
+
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            int x, y, goalX, goalY, nx, ny;
+            do
+            {
+                x = next(&seed) % size;
+                y = next(&seed) % size;
+                goalX = next(&seed) % size;
+                goalY = next(&seed) % size;
+            } while (!is_walkable(&world, x, y) || !is_walkable(&world, goalX, goalY) ||
+                     abs(goalX - x) + abs(goalY - y) < size / 2);
+
+            struct ReplanPath *path = open_replanner(replanner, x, y, goalX, goalY, NULL, NULL);
+            if (!step_replanner(path, x, y, &nx, &ny))
+            {
+                close_replanner(replanner, path);
+                continue;
+            }
+
+            // walk distances[d] steps along the path
+            int px = x, py = y, wx = x, wy = y;
+            for (int i = 0; i < distances[d] && !(wx == goalX && wy == goalY); i++)
+            {
+                px = wx;
+                py = wy;
+                wx = nx;
+                wy = ny;
+                step_replanner(path, wx, wy, &nx, &ny);
+            }
+            if (wx == goalX && wy == goalY)
+            {
+                close_replanner(replanner, path);
+                continue;
+            }
+
+            // back on (x, y), wall off the path where it steps into (wx, wy)
+            step_replanner(path, x, y, &nx, &ny);
+            int count = drop_wall(&world, px, py, wx, wy, wall);
+
+            double t = now_timings();
+            bool found = step_replanner(path, x, y, &nx, &ny);
+            repair += now_timings() - t;
+            repaired += path->expanded;
+
+            t = now_timings();
+            int32_t cost = astar_cost(&scratch, &world, x, y, goalX, goalY);
+            search += now_timings() - t;
+            searched += scratch.expanded;
+
+            mismatches += cost != (found ? cost_replanner(path) : INT32_MAX);
+            rounds++;
+
+            for (int i = 0; i < count; i++)
+                set_walkable(&world, wall[i] % size, wall[i] / size, true);
+            close_replanner(replanner, path);
+        }
+
+        if (rounds == 0)
+            continue;
+        printf("            | %8d | %12.3f %9ld | %9.3f %9ld%s\n", distances[d], repair * 1e3 / rounds,
+               repaired / rounds, search * 1e3 / rounds, searched / rounds, mismatches ? " MISMATCH" : "");
+    }
+
+    destroy_replanner(replanner);
+    destroy_path_scratch(&scratch);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+
+    return 0;
+}
@@ -0,0 +1,432 @@
+// bench_suite.c
+// The game's hot paths timed the same way, to compare one release with the
+// next: find_path on generated maps, world_to_grid + is_walkable,
+// update_hero, update_camera, raycast_camera and the logger's format, written
+// directly and through the asynchronous ring. Each
+// benchmark warms up, then times repeated runs of a fixed batch of
+// operations and reports the median and percentiles of the time per
+// operation, as a table or as CSV or JSON lines for scripts.
+#include "camera.h"
+#include "game.h"
+#include "navigation.h"
+#include "logging.h"
+#include "timings.h"
+#include "world.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_RUNS 30
+#define DEFAULT_WARMUP 5
+// percent of blocked tiles on the generated maps
+#define BLOCKED_PERCENT 20
+// seconds per simulation step
+#define STEP (1.0f / 60.0f)
+// random world positions and clicks, picked once per benchmark
+#define POSITIONS 4096
+// ring slots for logger/async, above a batch of lines
+#define BENCH_LOGGING_SLOTS 16384
+
+enum Format
+{
+    FORMAT_TABLE,
+    FORMAT_CSV,
+    FORMAT_JSON,
+};
+
+// What a benchmark works on, built before its runs and kept between them
+struct Fixture
+{
+    struct World world;
+    struct PathContext context;
+    struct Path path;
+    struct Hero hero;
+    struct Camera camera;
+    Vector3 positions[POSITIONS];
+    Vector2 clicks[POSITIONS];
+    int stdout_copy;
+    int null;
+};
+
+struct Benchmark
+{
+    const char *name;
+    // world side in tiles, for the benchmarks on a world
+    int size;
+    // per run, the time of a run is divided by it
+    int operations;
+    void (*setup)(struct Fixture *fixture, int size);
+    void (*run)(struct Fixture *fixture, int operations);
+    void (*teardown)(struct Fixture *fixture);
+};
+
+// results go here so the compiler cannot drop the work
+static volatile long sink;
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// not in logging.h, the entry point every level goes through
+int format(const char *level, const char *msg);
+
+// World
+
+static void setup_world(struct Fixture *fixture, int size)
+{
+    uint32_t seed = 0x2545f491u ^ (uint32_t)size;
+
+    fixture->world = create_world(size, size);
+    world_init(&fixture->world);
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+            if ((int)(next(&seed) % 100) < BLOCKED_PERCENT)
+                set_walkable(&fixture->world, x, y, false);
+
+    // walkable tiles only, as clicks land
+    for (int i = 0; i < POSITIONS; i++)
+    {
+        int x, y;
+        do
+        {
+            x = (int)(next(&seed) % (uint32_t)size);
+            y = (int)(next(&seed) % (uint32_t)size);
+        } while (!is_walkable(&fixture->world, x, y));
+
+        fixture->positions[i] = grid_to_world(&fixture->world, x, y);
+    }
+}
+
+static void teardown_world(struct Fixture *fixture)
+{
+    destroy_world(&fixture->world);
+}
+
+static void run_lookups(struct Fixture *fixture, int operations)
+{
+    long hits = 0;
+
+    for (int i = 0; i < operations; i++)
+    {
+        int x, y;
+        world_to_grid(&fixture->world, fixture->positions[i % POSITIONS], &x, &y);
+        hits += is_walkable(&fixture->world, x, y);
+    }
+
+    sink = hits;
+}
+
+// Pathfinding
+
+static void setup_paths(struct Fixture *fixture, int size)
+{
+    setup_world(fixture, size);
+    fixture->context = create_path_context(NULL);
+    fixture->path = create_path();
+}
+
+static void teardown_paths(struct Fixture *fixture)
+{
+    destroy_path(&fixture->path);
+    destroy_path_context(&fixture->context);
+    teardown_world(fixture);
+}
+
+// the same pairs every run, so runs time the same searches
+static void run_paths(struct Fixture *fixture, int operations)
+{
+    long nodes = 0;
+
+    for (int i = 0; i < operations; i++)
+    {
+        const Vector3 start = fixture->positions[(2 * i) % POSITIONS];
+        const Vector3 end = fixture->positions[(2 * i + 1) % POSITIONS];
+
+        if (find_path(&fixture->context, &fixture->world, start, end, &fixture->path))
+            nodes += fixture->path.length;
+    }
+
+    sink = nodes;
+}
+
+// Hero
+
+static void setup_hero(struct Fixture *fixture, int size)
+{
+    uint32_t seed = 0x68e31da4u;
+
+    (void)size;
+    for (int i = 0; i < POSITIONS; i++)
+        fixture->positions[i] = (Vector3){(next(&seed) % 2000) / 100.0f - 10.0f, 1.0f,
+                                          (next(&seed) % 2000) / 100.0f - 10.0f};
+    fixture->hero = create_hero((Vector3){0});
+}
+
+// always moving: a new target as soon as the hero stops
+static void run_hero(struct Fixture *fixture, int operations)
+{
+    struct Hero *hero = &fixture->hero;
+    int target = 0;
+
+    for (int i = 0; i < operations; i++)
+    {
+        if (!hero->is_moving)
+        {
+            // every other target run to
+            move_hero(hero, fixture->positions[target % POSITIONS], target % 2 == 0);
+            target++;
+        }
+        update_hero(hero, STEP);
+    }
+
+    sink = (long)hero->position.x;
+}
+
+// Camera
+
+static void setup_camera(struct Fixture *fixture, int size)
+{
+    uint32_t seed = 0x1b873593u;
+
+    setup_hero(fixture, size);
+    fixture->camera = create_camera((Vector3){0});
+    for (int i = 0; i < POSITIONS; i++)
+        fixture->clicks[i] = (Vector2){(float)(next(&seed) % 1920), (float)(next(&seed) % 1080)};
+}
+
+// following the hero, with a quarter turn now and then
+static void run_camera(struct Fixture *fixture, int operations)
+{
+    struct Camera *camera = &fixture->camera;
+
+    for (int i = 0; i < operations; i++)
+    {
+        if (i % 1000 == 0)
+            clockwise_rotate_camera(camera);
+        update_camera(camera, fixture->positions[i % POSITIONS], STEP);
+    }
+
+    sink = (long)camera->view.position.x;
+}
+
+// without a window raylib's screen is 0x0: the ray is not a real one, but
+// goes through the same math
+static void run_raycast(struct Fixture *fixture, int operations)
+{
+    float sum = 0.0f;
+
+    for (int i = 0; i < operations; i++)
+        sum += raycast_camera(&fixture->camera, fixture->clicks[i % POSITIONS]).x;
+
+    sink = (long)sum;
+}
+
+// Logger
+
+// the lines go to /dev/null, the write stays in what is timed
+static void setup_logger(struct Fixture *fixture, int size)
+{
+    (void)size;
+    fflush(stdout);
+    fixture->stdout_copy = dup(STDOUT_FILENO);
+
+    int null = open("/dev/null", O_WRONLY);
+    if (fixture->stdout_copy < 0 || null < 0 || dup2(null, STDOUT_FILENO) < 0)
+    {
+        fprintf(stderr, "cannot redirect the logger to /dev/null\n");
+        exit(EXIT_FAILURE);
+    }
+    close(null);
+}
+
+static void teardown_logger(struct Fixture *fixture)
+{
+    dup2(fixture->stdout_copy, STDOUT_FILENO);
+    close(fixture->stdout_copy);
+}
+
+static void run_logger(struct Fixture *fixture, int operations)
+{
+    long bytes = 0;
+
+    (void)fixture;
+    for (int i = 0; i < operations; i++)
+        bytes += format("\x1b[32mINFO\x1b[0m", "path: 42 nodes from (3, 4) to (120, 77), 1234 expanded");
+
+    sink = bytes;
+}
+
+// the same lines handed to the ring; the flusher writes them to /dev/null
+// on its own thread, a full ring makes the caller wait
+static void setup_async_logger(struct Fixture *fixture, int size)
+{
+    (void)size;
+    fixture->null = open("/dev/null", O_WRONLY);
+    if (fixture->null < 0 || !start_logging(fixture->null, BENCH_LOGGING_SLOTS, LOGGING_BLOCK))
+    {
+        fprintf(stderr, "cannot start the logger on /dev/null\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void teardown_async_logger(struct Fixture *fixture)
+{
+    stop_logging();
+    close(fixture->null);
+}
+
+static const struct Benchmark benchmarks[] = {
+    {"find_path/64", 64, 200, setup_paths, run_paths, teardown_paths},
+    {"find_path/256", 256, 50, setup_paths, run_paths, teardown_paths},
+    {"find_path/1024", 1024, 10, setup_paths, run_paths, teardown_paths},
+    {"world_to_grid+is_walkable", 256, 1000000, setup_world, run_lookups, teardown_world},
+    {"update_hero", 0, 1000000, setup_hero, run_hero, NULL},
+    {"update_camera", 0, 1000000, setup_camera, run_camera, NULL},
+    {"raycast_camera", 0, 100000, setup_camera, run_raycast, NULL},
+    {"logger/format", 0, 10000, setup_logger, run_logger, teardown_logger},
+    {"logger/async", 0, 10000, setup_async_logger, run_logger, teardown_async_logger},
+};
+
+static void report(const struct Benchmark *benchmark, struct Timings *timings, enum Format output, const char *version)
+{
+    // nanoseconds per operation
+    double median = percentile_timings(timings, 50.0) * 1e9;
+    double p90 = percentile_timings(timings, 90.0) * 1e9;
+    double p99 = percentile_timings(timings, 99.0) * 1e9;
+    double min = percentile_timings(timings, 0.0) * 1e9;
+    double max = percentile_timings(timings, 100.0) * 1e9;
+
+    switch (output)
+    {
+    case FORMAT_CSV:
+        printf("%s,%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f\n", version, benchmark->name, benchmark->operations,
+               timings->count, median, p90, p99, min, max);
+        break;
+    case FORMAT_JSON:
+        printf("{\"version\":\"%s\",\"benchmark\":\"%s\",\"operations\":%d,\"runs\":%d,\"median_ns\":%.3f,"
+               "\"p90_ns\":%.3f,\"p99_ns\":%.3f,\"min_ns\":%.3f,\"max_ns\":%.3f}\n",
+               version, benchmark->name, benchmark->operations, timings->count, median, p90, p99, min, max);
+        break;
+    default:
+        printf("%-26s %12.1f %12.1f %12.1f %12.1f %12.1f %14.0f\n", benchmark->name, median, p90, p99, min, max,
+               1e9 / median);
+        break;
+    }
+    fflush(stdout);
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [--runs N] [--warmup N] [--format table|csv|json] [--filter TEXT]\n"
+            "  --runs N       timed runs per benchmark (default %d)\n"
+            "  --warmup N     untimed runs first (default %d)\n"
+            "  --format F     table for people, csv or json lines for scripts (default table)\n"
+            "  --filter TEXT  only the benchmarks whose name contains TEXT\n",
+            program, DEFAULT_RUNS, DEFAULT_WARMUP);
+}
+
+int main(int argc, char **argv)
+{
+    int runs = DEFAULT_RUNS;
+    int warmup = DEFAULT_WARMUP;
+    enum Format output = FORMAT_TABLE;
+    const char *filter = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool value = i + 1 < argc;
+
+        if (strcmp(argv[i], "--runs") == 0 && value)
+            runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && value)
+            warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--format") == 0 && value)
+        {
+            const char *name = argv[++i];
+            if (strcmp(name, "table") == 0)
+                output = FORMAT_TABLE;
+            else if (strcmp(name, "csv") == 0)
+                output = FORMAT_CSV;
+            else if (strcmp(name, "json") == 0)
+                output = FORMAT_JSON;
+            else
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && value)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (runs <= 0 || warmup < 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // results carry the game version, to line up with a release
+    const struct Game game = create_game();
+
+    if (output == FORMAT_CSV)
+        printf("version,benchmark,operations,runs,median_ns,p90_ns,p99_ns,min_ns,max_ns\n");
+    else if (output == FORMAT_TABLE)
+        printf("%-26s %12s %12s %12s %12s %12s %14s\n", "ns per operation", "median", "p90", "p99", "min", "max",
+               "median ops/s");
+
+    struct Fixture *fixture = calloc(1, sizeof(*fixture));
+    if (fixture == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+    {
+        const struct Benchmark *benchmark = &benchmarks[i];
+        if (filter != NULL && strstr(benchmark->name, filter) == NULL)
+            continue;
+
+        benchmark->setup(fixture, benchmark->size);
+
+        // caches, branch predictors and the allocations of a first search
+        for (int run = 0; run < warmup; run++)
+            benchmark->run(fixture, benchmark->operations);
+
+        struct Timings timings = create_timings(runs);
+        for (int run = 0; run < runs; run++)
+        {
+            double begin = now_timings();
+            benchmark->run(fixture, benchmark->operations);
+            add_timings(&timings, (now_timings() - begin) / benchmark->operations);
+        }
+
+        if (benchmark->teardown != NULL)
+            benchmark->teardown(fixture);
+
+        report(benchmark, &timings, output, game.version);
+        destroy_timings(&timings);
+    }
+
+    free(fixture);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+// bench_units.c
+// Unit updates per second of the structure of arrays store, scalar against
+// SSE and AVX kernels, for 1k to 100k units with a quarter standing still,
+// against update_hero over an array of Hero. Reports a mismatch if a kernel
+// ends on different positions or speeds than update_hero.
+#include "units.h"
+#include "timings.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES 200
+// seconds per simulation step
+#define STEP (1.0f / 60.0f)
+
+static const int counts[] = {1000, 10000, 100000};
+static const char *names[] = {"scalar", "sse", "avx"};
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static float coordinate(uint32_t *seed)
+{
+    return (float)(next(seed) % 20000) / 100.0f - 100.0f;
+}
+
+static void bench(int count)
+{
+    struct Hero *heroes = malloc((size_t)count * sizeof(*heroes));
+    if (heroes == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t seed = 0x2545f491u ^ (uint32_t)count;
+    struct Units start = create_units();
+    for (int i = 0; i < count; i++)
+    {
+        Vector3 at = {coordinate(&seed), 0, coordinate(&seed)};
+        heroes[i] = create_hero(at);
+        // some arrive during the run, some never start
+        if (next(&seed) % 4 != 0)
+            move_hero(&heroes[i], (Vector3){at.x + coordinate(&seed) / 10, 0, at.z + coordinate(&seed) / 10},
+                      next(&seed) % 2);
+        add_units(&start, at);
+        set_units(&start, i, &heroes[i]);
+    }
+
+    double t = now_timings();
+    for (int f = 0; f < FRAMES; f++)
+        for (int i = 0; i < count; i++)
+            update_hero(&heroes[i], STEP);
+    double reference = now_timings() - t;
+    printf("%7d units | %-8s %8.1f M/s\n", count, "hero", (double)count * FRAMES / reference / 1e6);
+
+    for (int kernel = UNITS_SCALAR; kernel <= UNITS_AVX; kernel++)
+    {
+        if (!supported_units((enum UnitsKernel)kernel))
+            continue;
+
+        struct Units units = create_units();
+        for (int i = 0; i < count; i++)
+            add_units(&units, position_units(&start, i));
+        for (int i = 0; i < count; i++)
+        {
+            struct Hero hero = get_units(&start, i);
+            set_units(&units, i, &hero);
+        }
+
+        t = now_timings();
+        for (int f = 0; f < FRAMES; f++)
+            update_units_with(&units, (enum UnitsKernel)kernel, STEP);
+        double elapsed = now_timings() - t;
+
+        int mismatches = 0;
+        for (int i = 0; i < count; i++)
+        {
+            struct Hero hero = get_units(&units, i);
+            mismatches += memcmp(&hero.position, &heroes[i].position, sizeof(hero.position)) != 0 ||
+                          hero.speed != heroes[i].speed || hero.is_moving != heroes[i].is_moving;
+        }
+
+        printf("              | %-8s %8.1f M/s %6.1fx%s\n", names[kernel], (double)count * FRAMES / elapsed / 1e6,
+               reference / elapsed, mismatches ? " MISMATCH" : "");
+        destroy_units(&units);
+    }
+
+    destroy_units(&start);
+    free(heroes);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+        bench(counts[i]);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+// bench_world.c
+// Compares the chunked, bit-packed World against the previous layout:
+// one int per tile in a flat grid, with branching bounds and rounding.
+#include "world.h"
+#include "timings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOOKUPS 50000000
+#define LEGACY_TILE_SIZE 1.0f
+
+static const int sizes[] = {11, 256, 1024, 4096};
+
+// previous layout, 4 bytes per walkable flag
+struct LegacyWorld
+{
+    int size;
+    int half;
+    int *grid;
+};
+
+static bool legacy_is_walkable(const struct LegacyWorld *world, int x, int y)
+{
+    if (x < 0 || x >= world->size || y < 0 || y >= world->size)
+        return false;
+
+    return world->grid[x * world->size + y] == 1;
+}
+
+static void legacy_world_to_grid(const struct LegacyWorld *world, Vector3 worldPos, int *gridX, int *gridY)
+{
+    if (worldPos.x >= 0)
+        *gridX = (int)(worldPos.x / LEGACY_TILE_SIZE + 0.5f) + world->half;
+    if (worldPos.z >= 0)
+        *gridY = (int)(worldPos.z / LEGACY_TILE_SIZE + 0.5f) + world->half;
+    if (worldPos.x < 0)
+        *gridX = (int)(worldPos.x / LEGACY_TILE_SIZE - 0.5f) + world->half;
+    if (worldPos.z < 0)
+        *gridY = (int)(worldPos.z / LEGACY_TILE_SIZE - 0.5f) + world->half;
+}
+
+// xorshift, so both layouts see the same query stream
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void bench(int size)
+{
+    struct World world = create_world(size, size);
+    world_init(&world);
+
+    struct LegacyWorld legacy = {size, size / 2, malloc((size_t)size * size * sizeof(int))};
+    if (legacy.grid == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int x = 0; x < size; x++)
+        for (int y = 0; y < size; y++)
+            legacy.grid[x * size + y] = is_walkable(&world, x, y);
+
+    size_t tiles = (size_t)size * size;
+    size_t bytes = (size_t)world.chunks_x * world.chunks_y * (2 * sizeof(struct Chunk) + CHUNK_SIZE * CHUNK_SIZE);
+
+    // random world positions, a margin of 2 tiles outside the map on each side
+    float span = (float)(size + 4);
+    uint32_t seed;
+    long hits, legacy_hits;
+    double t;
+
+    seed = 0x9e3779b9u;
+    hits = 0;
+    t = now_timings();
+    for (int i = 0; i < LOOKUPS; i++)
+    {
+        Vector3 p = {(next(&seed) % 4096) / 4096.0f * span - span / 2, 0, (next(&seed) % 4096) / 4096.0f * span - span / 2};
+        int x, y;
+        world_to_grid(&world, p, &x, &y);
+        hits += is_walkable(&world, x, y);
+    }
+    double chunked = now_timings() - t;
+
+    seed = 0x9e3779b9u;
+    legacy_hits = 0;
+    t = now_timings();
+    for (int i = 0; i < LOOKUPS; i++)
+    {
+        Vector3 p = {(next(&seed) % 4096) / 4096.0f * span - span / 2, 0, (next(&seed) % 4096) / 4096.0f * span - span / 2};
+        int x, y;
+        legacy_world_to_grid(&legacy, p, &x, &y);
+        legacy_hits += legacy_is_walkable(&legacy, x, y);
+    }
+    double flat = now_timings() - t;
+
+    printf("%5dx%-5d bytes/tile: chunked %.3f legacy %.3f | lookups/s: chunked %.1fM legacy %.1fM | hits %ld/%ld\n",
+           size, size,
+           (double)bytes / tiles, (double)sizeof(int),
+           LOOKUPS / chunked / 1e6, LOOKUPS / flat / 1e6,
+           hits, legacy_hits);
+
+    free(legacy.grid);
+    destroy_world(&world);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+
+    return 0;
+}
@@ -0,0 +1,366 @@
+// decoder.c
+// Formats a binary log written with defer_logging (the game's --log FILE)
+// into the lines the logger prints: time, level and message. The game only
+// stored the id of each format and its raw arguments; the formats come from
+// the site records in the same log.
+#include "logging.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// sites per log, as many as the logger numbers
+#define DECODER_MAX_SITES 1024
+
+struct Site
+{
+    int level;
+    int line;
+    char file[LOGGING_LINE];
+    char fmt[LOGGING_LINE];
+    char kinds[LOGGING_MAX_ARGUMENTS];
+    int arguments;
+};
+
+// Reads fields out of a record, without going past its end
+struct Reader
+{
+    const char *record;
+    size_t length;
+    size_t at;
+    bool failed;
+};
+
+static void take(struct Reader *reader, void *value, size_t size)
+{
+    if (reader->at + size > reader->length)
+    {
+        reader->failed = true;
+        memset(value, 0, size);
+        return;
+    }
+
+    memcpy(value, reader->record + reader->at, size);
+    reader->at += size;
+}
+
+// Into text, always terminated
+static void take_string(struct Reader *reader, char *text, size_t capacity)
+{
+    uint16_t size;
+    take(reader, &size, sizeof(size));
+    if (size >= capacity || reader->at + size > reader->length)
+    {
+        reader->failed = true;
+        text[0] = '\0';
+        return;
+    }
+
+    memcpy(text, reader->record + reader->at, size);
+    text[size] = '\0';
+    reader->at += size;
+}
+
+static void print_time(int64_t nanoseconds)
+{
+    time_t seconds = (time_t)(nanoseconds / 1000000000);
+    struct tm local;
+    char text[64];
+
+    if (localtime_r(&seconds, &local) == NULL || strftime(text, sizeof(text), "%F %T %z", &local) == 0)
+        printf("%lld", (long long)nanoseconds);
+    else
+        fputs(text, stdout);
+}
+
+// The level without its colors
+static void print_level(const char *level, bool plain)
+{
+    for (const char *c = level; *c != '\0'; c++)
+    {
+        if (plain && *c == '\x1b')
+        {
+            while (*c != '\0' && *c != 'm')
+                c++;
+            if (*c == '\0')
+                break;
+            continue;
+        }
+        putchar(*c);
+    }
+}
+
+// The message of an event: its format with the stored arguments, one
+// conversion at a time through printf
+static bool print_message(const struct Site *site, struct Reader *reader)
+{
+    int argument = 0;
+
+    for (const char *c = site->fmt; *c != '\0'; c++)
+    {
+        if (*c != '%')
+        {
+            putchar(*c);
+            continue;
+        }
+        if (c[1] == '%')
+        {
+            putchar('%');
+            c++;
+            continue;
+        }
+
+        // the conversion again, its * filled in and its length modifier
+        // replaced by the one of the stored value
+        char spec[64] = "%";
+        size_t length = 1;
+        const char *start = ++c;
+
+        while (*c != '\0' && strchr("-+ #0'", *c) != NULL)
+            c++;
+        memcpy(spec + length, start, (size_t)(c - start));
+        length += (size_t)(c - start);
+
+        for (int part = 0; part < 2; part++)
+        {
+            if (part == 1)
+            {
+                if (*c != '.')
+                    break;
+                spec[length++] = *c++;
+            }
+            if (*c == '*')
+            {
+                int32_t value;
+                take(reader, &value, sizeof(value));
+                argument++;
+                length += (size_t)snprintf(spec + length, sizeof(spec) - length, "%d", value);
+                c++;
+            }
+            while (*c >= '0' && *c <= '9' && length < sizeof(spec) - 8)
+                spec[length++] = *c++;
+        }
+        while (*c != '\0' && strchr("hlzjtL", *c) != NULL)
+            c++;
+
+        if (*c == '\0' || argument >= site->arguments)
+            return false;
+
+        char kind = site->kinds[argument++];
+        char conversion = *c;
+
+        if (kind == 's')
+        {
+            char text[LOGGING_LINE];
+            take_string(reader, text, sizeof(text));
+            spec[length++] = 's';
+            spec[length] = '\0';
+            printf(spec, text);
+        }
+        else if (kind == 'i' || kind == 'u')
+        {
+            int32_t value;
+            take(reader, &value, sizeof(value));
+            spec[length++] = conversion;
+            spec[length] = '\0';
+            printf(spec, value);
+        }
+        else
+        {
+            int64_t value;
+            take(reader, &value, sizeof(value));
+
+            if (kind == 'd')
+            {
+                double real;
+                memcpy(&real, &value, sizeof(real));
+                spec[length++] = conversion;
+                spec[length] = '\0';
+                printf(spec, real);
+            }
+            else if (kind == 'p')
+            {
+                spec[length++] = 'p';
+                spec[length] = '\0';
+                printf(spec, (void *)(uintptr_t)value);
+            }
+            else
+            {
+                spec[length++] = 'l';
+                spec[length++] = 'l';
+                spec[length++] = conversion;
+                spec[length] = '\0';
+                if (strchr("di", conversion) != NULL)
+                    printf(spec, (long long)value);
+                else
+                    printf(spec, (unsigned long long)value);
+            }
+        }
+
+        if (reader->failed)
+            return false;
+    }
+
+    return true;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [--plain] [--where] FILE\n"
+            "  --plain  levels without terminal colors\n"
+            "  --where  end each line with the file and line that logged it\n",
+            program);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    bool plain = false;
+    bool where = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--plain") == 0)
+            plain = true;
+        else if (strcmp(argv[i], "--where") == 0)
+            where = true;
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if (path == NULL && argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (path == NULL)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "%s cannot be read\n", path);
+        return EXIT_FAILURE;
+    }
+
+    char magic[sizeof(LOGGING_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, LOGGING_MAGIC, sizeof(magic)) != 0)
+    {
+        fprintf(stderr, "%s is not a binary log\n", path);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    struct Site *sites = calloc(DECODER_MAX_SITES, sizeof(*sites));
+    if (sites == NULL)
+    {
+        fprintf(stderr, "Failure to allocate the sites\n");
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    long records = 0;
+    long broken = 0;
+    char record[LOGGING_LINE];
+    uint16_t size;
+
+    while (fread(&size, sizeof(size), 1, file) == 1)
+    {
+        // a log cut while written ends in the middle of a record
+        if (size < sizeof(size) + 1 || size > sizeof(record) ||
+            fread(record + sizeof(size), 1, size - sizeof(size), file) != size - sizeof(size))
+        {
+            broken++;
+            break;
+        }
+
+        struct Reader reader = {record, size, sizeof(size), false};
+        uint8_t kind;
+        take(&reader, &kind, sizeof(kind));
+        records++;
+
+        if (kind == LOGGING_SITE)
+        {
+            int32_t fields[3];
+            take(&reader, fields, sizeof(fields));
+            if (fields[0] <= 0 || fields[0] >= DECODER_MAX_SITES)
+            {
+                broken++;
+                continue;
+            }
+
+            struct Site *site = &sites[fields[0]];
+            site->level = fields[1];
+            site->line = fields[2];
+            take_string(&reader, site->file, sizeof(site->file));
+            take_string(&reader, site->fmt, sizeof(site->fmt));
+            site->arguments = arguments_logging(site->fmt, site->kinds);
+            if (reader.failed || site->arguments < 0)
+            {
+                site->fmt[0] = '\0';
+                broken++;
+            }
+        }
+        else if (kind == LOGGING_EVENT)
+        {
+            uint32_t number;
+            int64_t time;
+            take(&reader, &number, sizeof(number));
+            take(&reader, &time, sizeof(time));
+            if (number == 0 || number >= DECODER_MAX_SITES || sites[number].fmt[0] == '\0')
+            {
+                broken++;
+                continue;
+            }
+
+            const struct Site *site = &sites[number];
+            print_time(time);
+            putchar(' ');
+            print_level(name_logging(site->level), plain);
+            putchar('\t');
+            if (!print_message(site, &reader))
+            {
+                fputs(" [cut]", stdout);
+                broken++;
+            }
+            if (where)
+                printf(" (%s:%d)", site->file, site->line);
+            putchar('\n');
+        }
+        else if (kind == LOGGING_TEXT)
+        {
+            int64_t time;
+            char level[LOGGING_LINE];
+            char message[LOGGING_LINE];
+            take(&reader, &time, sizeof(time));
+            take_string(&reader, level, sizeof(level));
+            take_string(&reader, message, sizeof(message));
+
+            print_time(time);
+            putchar(' ');
+            print_level(level, plain);
+            printf("\t%s\n", message);
+        }
+        else
+            broken++;
+    }
+
+    free(sites);
+    fclose(file);
+
+    if (broken > 0)
+        fprintf(stderr, "%ld of %ld records could not be decoded\n", broken, records);
+
+    return broken > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
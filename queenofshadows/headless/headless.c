@@ -0,0 +1,384 @@
+// headless.c
+// Runs the game simulation without a window for a number of ticks: world,
+// pathfinding, hero and camera updates driven by a scripted player that
+// clicks random walkable tiles, double clicks to run, turns and zooms the
+// camera, all from a seed so a run repeats exactly; or by a recording of
+// the game or of an earlier run. Reports tick time percentiles and the
+// allocations made per phase, and fails when memory is still allocated once
+// the simulation is destroyed, for soak tests.
+//
+// Allocations are counted by wrapping the allocator at link time:
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+#include "simulation.h"
+#include "recording.h"
+#include "timings.h"
+
+#include <raykit.h>
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define DEFAULT_TICKS 36000
+#define DEFAULT_WORLD 256
+#define DEFAULT_SEED 0x2545f491u
+// percent of tiles blocked in generated worlds
+#define BLOCKED_PERCENT 20
+// ticks between two clicks of the script
+#define CLICK_MIN_TICKS 30
+#define CLICK_MAX_TICKS 270
+
+// Allocator counters, updated from the pathfinder workers too
+static atomic_long allocations;
+static atomic_long reallocations;
+static atomic_long frees;
+static atomic_long allocated_bytes;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+
+void *__wrap_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, (long)size, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, (long)(count * size), memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+    // realloc of NULL is a new block, anything else moves or grows one
+    atomic_fetch_add_explicit(pointer == NULL ? &allocations : &reallocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, (long)size, memory_order_relaxed);
+    return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void *pointer)
+{
+    if (pointer != NULL)
+        atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+    __real_free(pointer);
+}
+
+struct Allocations
+{
+    long allocations;
+    long reallocations;
+    long frees;
+    long bytes;
+};
+
+static struct Allocations count_allocations()
+{
+    return (struct Allocations){
+        .allocations = atomic_load(&allocations),
+        .reallocations = atomic_load(&reallocations),
+        .frees = atomic_load(&frees),
+        .bytes = atomic_load(&allocated_bytes),
+    };
+}
+
+static void print_allocations(const char *phase, struct Allocations from, struct Allocations to)
+{
+    printf("%-10s %8ld allocations %8ld reallocations %8ld frees %12ld bytes\n", phase,
+           to.allocations - from.allocations, to.reallocations - from.reallocations, to.frees - from.frees,
+           to.bytes - from.bytes);
+}
+
+static uint32_t next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Blocks random tiles, leaving the tile the hero starts on walkable
+static void generate_world(struct Simulation *simulation, uint32_t seed)
+{
+    struct World *world = &simulation->world;
+
+    pause_pathfinder(simulation->pathfinder);
+    for (int y = 0; y < world->height; y++)
+        for (int x = 0; x < world->width; x++)
+            if ((x != world->origin_x || y != world->origin_y) && next(&seed) % 100 < BLOCKED_PERCENT)
+                set_walkable(world, x, y, false);
+    resume_pathfinder(simulation->pathfinder);
+}
+
+// The scripted player
+struct Script
+{
+    uint32_t seed;
+    int next_click;
+    // ticks the zoom key stays down
+    int zoom_ticks;
+    bool zoom_in;
+};
+
+static void play_script(struct Script *script, const struct World *world, int tick, struct Input *input)
+{
+    *input = (struct Input){0};
+
+    if (tick >= script->next_click)
+    {
+        int x, y;
+        do
+        {
+            x = next(&script->seed) % world->width;
+            y = next(&script->seed) % world->height;
+        } while (!is_walkable(world, x, y));
+
+        input->click = true;
+        input->target = grid_to_world(world, x, y);
+        input->running = next(&script->seed) % 3 == 0;
+        script->next_click = tick + CLICK_MIN_TICKS + next(&script->seed) % (CLICK_MAX_TICKS - CLICK_MIN_TICKS);
+    }
+
+    // a camera turn every 10 seconds or so
+    uint32_t turn = next(&script->seed) % 1200;
+    input->rotate_clockwise = turn == 0;
+    input->rotate_counter_clockwise = turn == 1;
+
+    if (script->zoom_ticks > 0)
+    {
+        script->zoom_ticks--;
+        input->zoom_in = script->zoom_in;
+        input->zoom_out = !script->zoom_in;
+    }
+    else if (next(&script->seed) % 600 == 0)
+    {
+        script->zoom_ticks = 30 + next(&script->seed) % 60;
+        script->zoom_in = next(&script->seed) % 2;
+    }
+}
+
+// Frames in a recording, at most: the smallest take 5 bytes
+static int frames_recording(const char *path)
+{
+    struct stat status;
+    if (stat(path, &status) != 0)
+        return 0;
+
+    return status.st_size / 5 < INT_MAX ? (int)(status.st_size / 5) : INT_MAX;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [--ticks N] [--world SIZE] [--seed N] [--workers N] [--async]\n"
+            "          [--record FILE] [--replay FILE] [--profile FILE]\n"
+            "  --ticks N      simulation ticks to run (default %d)\n"
+            "  --world SIZE   square world side in tiles, %d%% blocked (default %d)\n"
+            "  --seed N       seed of the world and the script (default %u)\n"
+            "  --workers N    path worker threads (default from the game)\n"
+            "  --async        do not wait for paths in the tick that asked for them:\n"
+            "                 closer to the game, but runs no longer repeat exactly\n"
+            "  --record FILE  write the input of every tick to FILE\n"
+            "  --replay FILE  run the frames recorded in FILE instead of the script, on\n"
+            "                 the world they were recorded on; --ticks stops it early\n"
+            "  --profile FILE write the zones of the last %d ticks to FILE as Chrome\n"
+            "                 trace events\n",
+            program, DEFAULT_TICKS, BLOCKED_PERCENT, DEFAULT_WORLD, DEFAULT_SEED, PROFILE_FRAMES - 1);
+}
+
+int main(int argc, char **argv)
+{
+    struct Game game = create_game();
+    int ticks = 0;
+    int size = DEFAULT_WORLD;
+    uint32_t seed = DEFAULT_SEED;
+    bool async = false;
+    const char *record = NULL;
+    const char *replay = NULL;
+    const char *profile = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool value = i + 1 < argc;
+
+        if (strcmp(argv[i], "--ticks") == 0 && value)
+            ticks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--world") == 0 && value)
+            size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && value)
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--workers") == 0 && value)
+            game.path_workers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--async") == 0)
+            async = true;
+        else if (strcmp(argv[i], "--record") == 0 && value)
+            record = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && value)
+            replay = argv[++i];
+        else if (strcmp(argv[i], "--profile") == 0 && value)
+            profile = argv[++i];
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // xorshift never leaves 0
+    if (ticks < 0 || size <= 0 || game.path_workers <= 0 || seed == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct Replayer *replayer = NULL;
+    if (replay != NULL)
+    {
+        replayer = create_replayer(replay);
+        if (replayer == NULL)
+        {
+            fprintf(stderr, "%s: not a recording\n", replay);
+            return EXIT_FAILURE;
+        }
+
+        // the simulation it was recorded on
+        game.tick_rate = replayer->header.tick_rate;
+        game.world.width = replayer->header.world_width;
+        game.world.height = replayer->header.world_height;
+        game.any_angle_paths = replayer->header.any_angle_paths;
+        seed = replayer->header.seed;
+        if (ticks == 0)
+            ticks = frames_recording(replay);
+    }
+    else
+    {
+        game.world.width = size;
+        game.world.height = size;
+        if (ticks == 0)
+            ticks = DEFAULT_TICKS;
+    }
+
+    struct Recorder *recorder = NULL;
+    if (record != NULL)
+    {
+        const struct RecordingHeader header = {
+            .tick_rate = game.tick_rate,
+            .world_width = game.world.width,
+            .world_height = game.world.height,
+            .seed = seed,
+            .any_angle_paths = game.any_angle_paths,
+        };
+
+        recorder = create_recorder(record, &header);
+        if (recorder == NULL)
+        {
+            fprintf(stderr, "%s: cannot be created\n", record);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // reserved up front, so ticks only count what the simulation allocates
+    struct Timings timings = create_timings(ticks);
+
+    struct Allocations start = count_allocations();
+    double setup = now_timings();
+
+    struct Simulation *simulation = create_simulation(&game);
+    // seed 0: the game world, as recorded from the game
+    if (seed != 0)
+        generate_world(simulation, seed);
+    // a sequence of its own, an odd multiplier keeps it off 0
+    struct Script script = {.seed = seed * 2654435761u};
+
+    setup = now_timings() - setup;
+    struct Allocations ready = count_allocations();
+
+    // scripted: one tick per frame, every frame exactly a step long
+    double run = now_timings();
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        PROFILE_FRAME();
+
+        struct Input input;
+        double seconds = simulation->clock.step;
+
+        if (replayer != NULL)
+        {
+            float recorded;
+            if (!replay_replayer(replayer, &input, &recorded))
+                break;
+            seconds = recorded;
+        }
+        else
+            play_script(&script, &simulation->world, tick, &input);
+
+        double begin = now_timings();
+        frame_simulation(simulation, &input, seconds);
+        // the search counts in the tick that asked for it, and the path
+        // arrives on the next tick whatever the machine
+        if (input.click && !async && replayer == NULL)
+        {
+            PROFILE_ZONE("wait_pathfinder");
+            wait_pathfinder(simulation->pathfinder);
+        }
+        add_timings(&timings, now_timings() - begin);
+
+        if (recorder != NULL)
+            record_recorder(recorder, &input, simulation->collected, (float)seconds);
+    }
+    run = now_timings() - run;
+
+    struct Allocations ran = count_allocations();
+    struct PathfinderStats stats = stats_pathfinder(simulation->pathfinder);
+    Vector3 hero = simulation->hero.position;
+    long steps = simulation->clock.steps;
+
+    destroy_simulation(simulation);
+    struct Allocations end = count_allocations();
+
+    printf("world %dx%d, %d %s at %d Hz, %.1f s simulated, %d path workers%s\n", game.world.width,
+           game.world.height, timings.count, replayer != NULL ? "recorded frames" : "ticks", game.tick_rate,
+           steps / (double)game.tick_rate, game.path_workers, async && replayer == NULL ? ", async" : "");
+    printf("setup %.2f ms, run %.2f ms, %ld steps\n", setup * 1000.0, run * 1000.0, steps);
+    print_timings(&timings, stdout, replayer != NULL ? "frame" : "tick");
+    printf("paths %ld submitted, %ld completed, %ld coalesced, latency max %.2f ms\n", stats.submitted,
+           stats.completed, stats.coalesced, stats.latency_max * 1000.0);
+    // the same seed or recording ends on the same position unless --async
+    printf("hero  %.4f %.4f\n", hero.x, hero.z);
+    print_allocations("setup", start, ready);
+    print_allocations("ticks", ready, ran);
+    print_allocations("teardown", ran, end);
+
+    long live = (end.allocations - end.frees) - (start.allocations - start.frees);
+
+    // after the counts, the export allocates
+    bool exported = profile == NULL || export_profiler(profile);
+    if (!exported)
+        fprintf(stderr, "%s: cannot be written\n", profile);
+    destroy_timings(&timings);
+    destroy_replayer(replayer);
+
+    bool written = destroy_recorder(recorder);
+    if (!written)
+        fprintf(stderr, "%s: write failed\n", record);
+
+    if (live != 0)
+    {
+        printf("LEAK: %ld blocks still allocated\n", live);
+        return EXIT_FAILURE;
+    }
+
+    return written && exported ? EXIT_SUCCESS : EXIT_FAILURE;
+}
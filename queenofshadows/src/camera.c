@@ -10,23 +10,18 @@
 #define INITIAL_RADIUS 30.0f
 #define DIRECTION_CLOCKWISE -1.0f
 #define DIRECTION_COUNTER_CLOCKWISE 1.0f
-// zoom increments every time the player pressed the button
-#define ZOOM 0.5f
+// zoom per second while the button is held (0.5 per frame at 60 FPS)
+#define ZOOM_SPEED 30.0f
 #define MAX_ZOOM 50.0f
 #define MIN_ZOOM 20.0f
-// total time to rotate = 1 s, with a game target of 60 FPS => 60
-// total time to rotate = 750 ms, with a game target of 60 FPS => 45
-// total time to rotate = 500 ms, with a game target of 60 FPS => 30
-// How many frames do I need to complete the rotation in N seconds?
-#define ROTATION_FRAME 45.0f
-
-// Variables to hold current camera rotation
-// numbers of frame to complete the rotation
-float total_rotation_frame = ROTATION_FRAME;
+// seconds to complete a rotation, whatever the simulation rate
+#define ROTATION_TIME 0.75f
+
 // variables to control rotation when is_rotating boolean is true
-// updated each frame
+// updated each simulation step
 float current_rotation_angle = INITIAL_ANGLE;
-float current_rotation_frame = 0.0f;
+// degrees turned so far by the current rotation
+float current_rotation_turned = 0.0f;
 // indicate rotate direction: clockwise or counter clockwise
 float direction = 0.0f;
 
@@ -50,9 +45,8 @@ struct Camera create_camera(const Vector3 at)
     view.projection = CAMERA_PERSPECTIVE;
 
     // initialize file camera variables
-    total_rotation_frame = ROTATION_FRAME;
     current_rotation_angle = INITIAL_ANGLE;
-    current_rotation_frame = 0.0f;
+    current_rotation_turned = 0.0f;
 
     // variables to hold camara status
     return (struct Camera){
@@ -64,20 +58,18 @@ struct Camera create_camera(const Vector3 at)
     };
 }
 
-void zoom_in_camera(struct Camera *camera)
+void zoom_in_camera(struct Camera *camera, float seconds)
 {
-    if (camera->radius == MIN_ZOOM)
-        return;
-
-    camera->radius -= ZOOM;
+    camera->radius -= ZOOM_SPEED * seconds;
+    if (camera->radius < MIN_ZOOM)
+        camera->radius = MIN_ZOOM;
 }
 
-void zoom_out_camera(struct Camera *camera)
+void zoom_out_camera(struct Camera *camera, float seconds)
 {
-    if (camera->radius == MAX_ZOOM)
-        return;
-
-    camera->radius += ZOOM;
+    camera->radius += ZOOM_SPEED * seconds;
+    if (camera->radius > MAX_ZOOM)
+        camera->radius = MAX_ZOOM;
 }
 
 void clockwise_rotate_camera(struct Camera *camera)
@@ -133,22 +125,23 @@ void update_position_camera(struct Camera *camera, const Vector3 target)
     camera->view.position.z = target.z + camera->radius * cos(current_rotation_angle * DEG2RAD);
 }
 
-void update_angle_camera(struct Camera *camera)
+void update_angle_camera(struct Camera *camera, float seconds)
 {
     if (camera->is_rotating)
     {
-        if (current_rotation_frame >= total_rotation_frame)
+        float turn = ROTATION_ANGLE / ROTATION_TIME * seconds;
+
+        if (current_rotation_turned + turn >= ROTATION_ANGLE)
         {
-            // when rotation finishes
-            current_rotation_frame = 0;
+            // when rotation finishes, land on the exact angle
+            turn = ROTATION_ANGLE - current_rotation_turned;
+            current_rotation_turned = 0.0f;
             camera->is_rotating = false;
         }
         else
-        {
-            // update rotation angle an frame
-            current_rotation_angle += direction * 2;
-            ++current_rotation_frame;
-        }
+            current_rotation_turned += turn;
+
+        current_rotation_angle += direction * turn;
     }
 }
 
@@ -158,10 +151,10 @@ void update_target_camera(struct Camera *camera, const Vector3 target)
     camera->view.target = target;
 }
 
-void update_camera(struct Camera *camera, const Vector3 target)
+void update_camera(struct Camera *camera, const Vector3 target, float seconds)
 {
     update_target_camera(camera, target);
-    update_angle_camera(camera);
+    update_angle_camera(camera, seconds);
     update_position_camera(camera, target);
 }
 
@@ -182,6 +175,15 @@ const char *position_camera(const struct Camera *camera)
     }
 }
 
+Camera3D interpolate_camera(const Camera3D *previous, const struct Camera *camera, float alpha)
+{
+    Camera3D view = camera->view;
+
+    view.position = Vector3Lerp(previous->position, camera->view.position, alpha);
+    view.target = Vector3Lerp(previous->target, camera->view.target, alpha);
+    return view;
+}
+
 Vector3 raycast_camera(const struct Camera *camera, const Vector2 position)
 {
     Vector3 target = {0};
@@ -30,11 +30,15 @@ struct Camera create_camera(const Vector3 at);
 
 const char *position_camera(const struct Camera *camera);
 
-void zoom_in_camera(struct Camera *camera);
-void zoom_out_camera(struct Camera *camera);
+// zoom for as long as the button is held, in seconds
+void zoom_in_camera(struct Camera *camera, float seconds);
+void zoom_out_camera(struct Camera *camera, float seconds);
 void clockwise_rotate_camera(struct Camera *camera);
 void counter_clockwise_rotate_camera(struct Camera *camera);
 
 Vector3 raycast_camera(const struct Camera *camera, const Vector2 position);
 
-void update_camera(struct Camera *camera, const Vector3 target);
+// One simulation step of the given length
+void update_camera(struct Camera *camera, const Vector3 target, float seconds);
+// View between the one before the last step and the current one, alpha from alpha_clock
+Camera3D interpolate_camera(const Camera3D *previous, const struct Camera *camera, float alpha);
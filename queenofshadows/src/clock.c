@@ -0,0 +1,41 @@
+#include "clock.h"
+
+#include <math.h>
+
+struct Clock create_clock(int rate)
+{
+    return (struct Clock){
+        .step = 1.0f / (float)rate,
+        .accumulator = 0.0,
+        .steps = 0,
+        .dropped = 0.0,
+    };
+}
+
+int advance_clock(struct Clock *clock, double seconds)
+{
+    int steps = 0;
+
+    clock->accumulator += seconds;
+    while (clock->accumulator >= clock->step && steps < CLOCK_MAX_STEPS)
+    {
+        clock->accumulator -= clock->step;
+        steps++;
+    }
+
+    // still behind after the cap: keep only the part of a step
+    if (clock->accumulator >= clock->step)
+    {
+        double kept = fmod(clock->accumulator, clock->step);
+        clock->dropped += clock->accumulator - kept;
+        clock->accumulator = kept;
+    }
+
+    clock->steps += steps;
+    return steps;
+}
+
+float alpha_clock(const struct Clock *clock)
+{
+    return (float)(clock->accumulator / clock->step);
+}
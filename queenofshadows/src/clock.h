@@ -0,0 +1,28 @@
+#pragma once
+
+// steps run at most per frame, time beyond is dropped so a slow frame
+// cannot snowball into ever longer ones
+#define CLOCK_MAX_STEPS 8
+
+// Fixed step simulation clock. Frame times of any length accumulate and are
+// spent in steps of the same length, the remainder carries over; render
+// state is interpolated by how far into the next step the frame ends.
+struct Clock
+{
+    // seconds per step, 1 / rate
+    float step;
+    // seconds not yet simulated
+    double accumulator;
+    // steps run since creation
+    long steps;
+    // seconds dropped by the CLOCK_MAX_STEPS cap
+    double dropped;
+};
+
+// rate in steps per second
+struct Clock create_clock(int rate);
+
+// Adds a frame of the given length, returns how many steps to run now
+int advance_clock(struct Clock *clock, double seconds);
+// Fraction of a step left over, from the previous state (0) to the current (1)
+float alpha_clock(const struct Clock *clock);
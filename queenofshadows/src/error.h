@@ -1 +1,3 @@
+#pragma once
+
 void die(const char *s);
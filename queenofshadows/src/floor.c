@@ -0,0 +1,218 @@
+#include "floor.h"
+#include "error.h"
+
+#include <stdlib.h>
+
+#include <raymath.h>
+
+// quad side against the tile, gaps show the outline
+#define FLOOR_TILE 0.95f
+// outline width, inside the tile border
+#define FLOOR_LINE 0.02f
+// a tile quad and the 4 outline strips, 2 triangles each
+#define FLOOR_VERTICES_PER_TILE (5 * 6)
+
+static const Color even = {100, 100, 100, 200};
+static const Color odd = {120, 120, 120, 200};
+static const Color outline = {200, 200, 200, 255};
+
+static void edited_floor(void *context, int x, int y)
+{
+    struct Floor *floor = context;
+
+    floor->chunks[(y >> CHUNK_SHIFT) * floor->world->chunks_x + (x >> CHUNK_SHIFT)].dirty = true;
+}
+
+struct Floor *create_floor(struct World *world)
+{
+    struct Floor *floor = calloc(1, sizeof(*floor));
+    if (floor == NULL)
+        die("Failure to allocate floor");
+
+    floor->world = world;
+    floor->chunks = calloc((size_t)world->chunks_x * world->chunks_y, sizeof(*floor->chunks));
+    if (floor->chunks == NULL)
+        die("Failure to allocate floor chunks");
+
+    for (int i = 0; i < world->chunks_x * world->chunks_y; i++)
+        floor->chunks[i].dirty = true;
+
+    if (!listen_world(world, edited_floor, floor))
+        die("Too many world listeners");
+
+    return floor;
+}
+
+// GPU buffers go with UnloadMesh, vertices never uploaded are only ours
+static void unload_chunk(struct FloorChunk *chunk)
+{
+    if (chunk->uploaded)
+        UnloadMesh(chunk->mesh);
+    else
+    {
+        free(chunk->mesh.vertices);
+        free(chunk->mesh.texcoords);
+        free(chunk->mesh.colors);
+    }
+
+    chunk->mesh = (Mesh){0};
+    chunk->uploaded = false;
+}
+
+void destroy_floor(struct Floor *floor)
+{
+    if (floor == NULL)
+        return;
+
+    unlisten_world(floor->world, floor);
+
+    for (int i = 0; i < floor->world->chunks_x * floor->world->chunks_y; i++)
+        unload_chunk(&floor->chunks[i]);
+
+    if (floor->material_loaded)
+        UnloadMaterial(floor->material);
+
+    free(floor->chunks);
+    free(floor);
+}
+
+// Two triangles facing up, from (x0, z0) to (x1, z1)
+static void put_quad(Mesh *mesh, float x0, float z0, float x1, float z1, Color color)
+{
+    const float corners[6][2] = {{x0, z0}, {x0, z1}, {x1, z0}, {x1, z0}, {x0, z1}, {x1, z1}};
+
+    for (int i = 0; i < 6; i++)
+    {
+        int v = mesh->vertexCount++;
+
+        mesh->vertices[v * 3] = corners[i][0];
+        mesh->vertices[v * 3 + 1] = 0.0f;
+        mesh->vertices[v * 3 + 2] = corners[i][1];
+        mesh->colors[v * 4] = color.r;
+        mesh->colors[v * 4 + 1] = color.g;
+        mesh->colors[v * 4 + 2] = color.b;
+        mesh->colors[v * 4 + 3] = color.a;
+    }
+}
+
+static void build_chunk(struct Floor *floor, int cx, int cy)
+{
+    const struct World *world = floor->world;
+    const struct Chunk *walkable = &world->chunks[cy * world->chunks_x + cx];
+    struct FloorChunk *chunk = &floor->chunks[cy * world->chunks_x + cx];
+
+    unload_chunk(chunk);
+    chunk->dirty = false;
+    floor->stats.rebuilt++;
+
+    int tiles = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        tiles += __builtin_popcountll(walkable->walkable[y]);
+    if (tiles == 0)
+        return;
+
+    Mesh *mesh = &chunk->mesh;
+    size_t vertices = (size_t)tiles * FLOOR_VERTICES_PER_TILE;
+    mesh->vertices = malloc(vertices * 3 * sizeof(*mesh->vertices));
+    // unused by the default shader, but uploaded all the same
+    mesh->texcoords = calloc(vertices * 2, sizeof(*mesh->texcoords));
+    mesh->colors = malloc(vertices * 4 * sizeof(*mesh->colors));
+    if (mesh->vertices == NULL || mesh->texcoords == NULL || mesh->colors == NULL)
+        die("Failure to allocate floor mesh");
+
+    const float size = (float)tile_size();
+    const float half = size * 0.5f;
+    const float inner = size * FLOOR_TILE * 0.5f;
+    const float line = size * FLOOR_LINE;
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        for (uint64_t row = walkable->walkable[y]; row != 0; row &= row - 1)
+        {
+            int gx = (cx << CHUNK_SHIFT) + __builtin_ctzll(row);
+            int gy = (cy << CHUNK_SHIFT) + y;
+            Vector3 centre = grid_to_world(world, gx, gy);
+            float x = centre.x;
+            float z = centre.z;
+
+            put_quad(mesh, x - inner, z - inner, x + inner, z + inner, (gx + gy) % 2 == 0 ? even : odd);
+            put_quad(mesh, x - half, z - half, x + half, z - half + line, outline);
+            put_quad(mesh, x - half, z + half - line, x + half, z + half, outline);
+            put_quad(mesh, x - half, z - half + line, x - half + line, z + half - line, outline);
+            put_quad(mesh, x + half - line, z - half + line, x + half, z + half - line, outline);
+        }
+    }
+
+    mesh->triangleCount = mesh->vertexCount / 3;
+}
+
+int build_floor(struct Floor *floor)
+{
+    const struct World *world = floor->world;
+    int built = 0;
+
+    for (int cy = 0; cy < world->chunks_y; cy++)
+    {
+        for (int cx = 0; cx < world->chunks_x; cx++)
+        {
+            if (floor->chunks[cy * world->chunks_x + cx].dirty)
+            {
+                build_chunk(floor, cx, cy);
+                built++;
+            }
+        }
+    }
+
+    return built;
+}
+
+void draw_floor(struct Floor *floor, const struct Frustum *frustum, struct RenderList *list)
+{
+    const struct World *world = floor->world;
+
+    if (!floor->material_loaded)
+    {
+        floor->material = LoadMaterialDefault();
+        floor->material_loaded = true;
+    }
+
+    build_floor(floor);
+
+    floor->stats.draw_calls = 0;
+    floor->stats.vertices = 0;
+    floor->stats.culled = 0;
+    floor->stats.tiles = 0;
+
+    for (int i = 0; i < world->chunks_x * world->chunks_y; i++)
+    {
+        struct FloorChunk *chunk = &floor->chunks[i];
+        if (chunk->mesh.vertexCount == 0)
+            continue;
+
+        floor->stats.tiles += chunk->mesh.vertexCount / FLOOR_VERTICES_PER_TILE;
+        if (!chunk_frustum(frustum, world, i % world->chunks_x, i / world->chunks_x))
+        {
+            floor->stats.culled++;
+            continue;
+        }
+
+        if (!chunk->uploaded)
+        {
+            UploadMesh(&chunk->mesh, false);
+            chunk->uploaded = true;
+
+            // the GPU has them now, rebuilds start over from the world
+            free(chunk->mesh.vertices);
+            free(chunk->mesh.texcoords);
+            free(chunk->mesh.colors);
+            chunk->mesh.vertices = NULL;
+            chunk->mesh.texcoords = NULL;
+            chunk->mesh.colors = NULL;
+        }
+
+        record_mesh(list, &chunk->mesh, &floor->material, MatrixIdentity());
+
+        floor->stats.draw_calls++;
+        floor->stats.vertices += chunk->mesh.vertexCount;
+    }
+}
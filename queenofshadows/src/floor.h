@@ -0,0 +1,54 @@
+#pragma once
+
+#include "frustum.h"
+#include "world.h"
+
+#include <raylib.h>
+#include <raykit.h>
+
+// Floor geometry of one world chunk: a quad per walkable tile and a thin
+// outline around it, as triangles in world space
+struct FloorChunk
+{
+    // vertex arrays until uploaded, GPU buffers after
+    Mesh mesh;
+    bool uploaded;
+    // tiles edited since the mesh was built
+    bool dirty;
+};
+
+struct FloorStats
+{
+    // meshes recorded by the last draw_floor, one draw call each
+    int draw_calls;
+    int vertices;
+    // chunks with tiles left out by the last draw_floor, out of view
+    int culled;
+    // walkable tiles, drawn with a DrawCube and a DrawCubeWires each before
+    int tiles;
+    // chunk meshes built since creation
+    long rebuilt;
+};
+
+// Walkable tiles drawn from a mesh per chunk, built once and rebuilt only
+// for the chunks whose tiles were edited since: a world listener marks them.
+struct Floor
+{
+    struct World *world;
+    // world->chunks_x * world->chunks_y, same order as the world chunks
+    struct FloorChunk *chunks;
+    Material material;
+    bool material_loaded;
+    struct FloorStats stats;
+};
+
+struct Floor *create_floor(struct World *world);
+// Before the world, and while the window is open once anything was drawn
+void destroy_floor(struct Floor *floor);
+
+// Builds the vertices of the chunks edited since the last call, no window
+// needed; returns how many were built
+int build_floor(struct Floor *floor);
+// Builds and uploads the chunks in view and records their meshes, which
+// stay valid until the next draw_floor
+void draw_floor(struct Floor *floor, const struct Frustum *frustum, struct RenderList *list);
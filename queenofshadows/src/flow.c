@@ -0,0 +1,251 @@
+#include "flow.h"
+#include "path.h"
+#include "error.h"
+
+#include <stdlib.h>
+
+// Straight directions first, so ties prefer them: up, down, left, right,
+// then up-left, up-right, down-left, down-right
+static const int dx[] = {0, 0, -1, 1, -1, 1, -1, 1};
+static const int dy[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+
+static void push_bucket(struct FlowCache *cache, int bucket, int tile)
+{
+    if (cache->bucket_size[bucket] == cache->bucket_capacity[bucket])
+    {
+        int capacity = cache->bucket_capacity[bucket] ? cache->bucket_capacity[bucket] * 2 : 1024;
+        int *grown = realloc(cache->buckets[bucket], (size_t)capacity * sizeof(*grown));
+        if (grown == NULL)
+            die("Failure to allocate flow queue");
+        cache->buckets[bucket] = grown;
+        cache->bucket_capacity[bucket] = capacity;
+    }
+
+    cache->buckets[bucket][cache->bucket_size[bucket]++] = tile;
+}
+
+// Dijkstra from the goal in a single sweep. Step costs are 1 to 3 times
+// PATH_COST_STRAIGHT, so a ring of 4 buckets orders the whole frontier.
+static void integrate_flow(struct FlowCache *cache, struct FlowField *flow)
+{
+    const struct World *world = cache->world;
+    int width = world->width;
+    int tiles = width * world->height;
+    int pending = 1;
+
+    for (int i = 0; i < tiles; i++)
+        flow->cost[i] = INT32_MAX;
+
+    int goal = flow->goal_y * width + flow->goal_x;
+    flow->cost[goal] = 0;
+    push_bucket(cache, 0, goal);
+
+    for (int32_t level = 0; pending > 0; level += PATH_COST_STRAIGHT)
+    {
+        int bucket = (level / PATH_COST_STRAIGHT) % 4;
+
+        // every push lands in a later bucket, the current one only shrinks
+        for (int i = 0; i < cache->bucket_size[bucket]; i++)
+        {
+            int tile = cache->buckets[bucket][i];
+            pending--;
+
+            // stale: reached at a lower cost since
+            if (flow->cost[tile] != level)
+                continue;
+
+            int x = tile % width;
+            int y = tile / width;
+            // walking from a neighbour into this tile pays for this tile
+            int32_t cost = level + PATH_COST_STRAIGHT * movement_cost(world, x, y);
+
+            for (int k = 0; k < 4; k++)
+            {
+                int nx = x + dx[k];
+                int ny = y + dy[k];
+                if (!is_walkable(world, nx, ny))
+                    continue;
+
+                int next = ny * width + nx;
+                if (cost >= flow->cost[next])
+                    continue;
+
+                flow->cost[next] = cost;
+                push_bucket(cache, (cost / PATH_COST_STRAIGHT) % 4, next);
+                pending++;
+            }
+        }
+
+        cache->bucket_size[bucket] = 0;
+    }
+}
+
+// Each tile points at its cheapest neighbour, diagonals only past two open
+// sides. Around a reachable tile, walkable and reachable are the same, so
+// the costs alone tell which neighbours are open.
+static void direct_flow(struct FlowField *flow)
+{
+    const struct World *world = flow->world;
+    int width = world->width;
+    int height = world->height;
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int tile = y * width + x;
+            int32_t best = flow->cost[tile];
+            uint8_t direction = FLOW_NONE;
+
+            if (best != INT32_MAX && best != 0)
+            {
+                int32_t around[8];
+                for (int k = 0; k < 8; k++)
+                {
+                    int nx = x + dx[k];
+                    int ny = y + dy[k];
+                    around[k] = (unsigned)nx < (unsigned)width && (unsigned)ny < (unsigned)height
+                                    ? flow->cost[ny * width + nx]
+                                    : INT32_MAX;
+                }
+
+                for (int k = 0; k < 8; k++)
+                {
+                    // diagonal k crosses straight neighbours (k - 4) / 2 and 2 + (k - 4) % 2
+                    if (k >= 4 && (around[(k - 4) / 2] == INT32_MAX || around[2 + (k - 4) % 2] == INT32_MAX))
+                        continue;
+
+                    if (around[k] < best)
+                    {
+                        best = around[k];
+                        direction = (uint8_t)k;
+                    }
+                }
+            }
+
+            flow->direction[tile] = direction;
+        }
+    }
+}
+
+static void build_flow(struct FlowCache *cache, struct FlowField *flow)
+{
+    integrate_flow(cache, flow);
+    direct_flow(flow);
+
+    flow->edits = cache->edits;
+    cache->built++;
+}
+
+// World listener: any edit can change costs far away, every field goes stale
+static void edited_flow(void *context, int x, int y)
+{
+    struct FlowCache *cache = context;
+    (void)x;
+    (void)y;
+
+    cache->edits++;
+}
+
+struct FlowCache *create_flow_cache(struct World *world)
+{
+    struct FlowCache *cache = calloc(1, sizeof(*cache));
+    if (cache == NULL)
+        die("Failure to allocate flow cache");
+
+    cache->world = world;
+
+    if (!listen_world(world, edited_flow, cache))
+        die("Too many world listeners");
+
+    return cache;
+}
+
+void destroy_flow_cache(struct FlowCache *cache)
+{
+    if (cache == NULL)
+        return;
+
+    unlisten_world(cache->world, cache);
+
+    for (int i = 0; i < cache->count; i++)
+    {
+        free(cache->fields[i].cost);
+        free(cache->fields[i].direction);
+    }
+    for (int i = 0; i < 4; i++)
+        free(cache->buckets[i]);
+
+    free(cache);
+}
+
+const struct FlowField *get_flow(struct FlowCache *cache, int goalX, int goalY)
+{
+    if (!is_walkable(cache->world, goalX, goalY))
+        return NULL;
+
+    struct FlowField *flow = NULL;
+    cache->clock++;
+
+    for (int i = 0; i < cache->count && flow == NULL; i++)
+        if (cache->fields[i].goal_x == goalX && cache->fields[i].goal_y == goalY)
+            flow = &cache->fields[i];
+
+    if (flow == NULL)
+    {
+        if (cache->count < FLOW_CACHE_SIZE)
+        {
+            size_t tiles = (size_t)cache->world->width * cache->world->height;
+
+            flow = &cache->fields[cache->count++];
+            flow->world = cache->world;
+            flow->cost = malloc(tiles * sizeof(*flow->cost));
+            flow->direction = malloc(tiles * sizeof(*flow->direction));
+            if (flow->cost == NULL || flow->direction == NULL)
+                die("Failure to allocate flow field");
+        }
+        else
+        {
+            flow = &cache->fields[0];
+            for (int i = 1; i < cache->count; i++)
+                if (cache->fields[i].used < flow->used)
+                    flow = &cache->fields[i];
+        }
+
+        flow->goal_x = goalX;
+        flow->goal_y = goalY;
+        build_flow(cache, flow);
+    }
+    else if (flow->edits != cache->edits)
+        build_flow(cache, flow);
+
+    flow->used = cache->clock;
+
+    return flow;
+}
+
+bool reachable_flow(const struct FlowField *flow, Vector3 position)
+{
+    int x, y;
+
+    world_to_grid(flow->world, position, &x, &y);
+    if (!is_walkable(flow->world, x, y))
+        return false;
+
+    return flow->cost[y * flow->world->width + x] != INT32_MAX;
+}
+
+Vector3 next_flow(const struct FlowField *flow, Vector3 position)
+{
+    int x, y;
+
+    world_to_grid(flow->world, position, &x, &y);
+    if (!reachable_flow(flow, position))
+        return position;
+
+    uint8_t direction = flow->direction[y * flow->world->width + x];
+    if (direction == FLOW_NONE)
+        return grid_to_world(flow->world, flow->goal_x, flow->goal_y);
+
+    return grid_to_world(flow->world, x + dx[direction], y + dy[direction]);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "world.h"
+
+#include <raylib.h>
+#include <stdint.h>
+
+// goals a cache keeps fields for
+#define FLOW_CACHE_SIZE 8
+// direction of tiles without one: the goal, blocked and unreachable tiles
+#define FLOW_NONE 8
+
+// Integration and flow field toward one goal tile: every unit heading to
+// the goal reads its next step from the field instead of searching
+struct FlowField
+{
+    const struct World *world;
+    int goal_x;
+    int goal_y;
+    // cost from each tile to the goal over 4 neighbours, INT32_MAX when unreachable
+    int32_t *cost;
+    // per tile, index of the neighbour with the lowest cost (8 neighbours,
+    // no corner cutting), or FLOW_NONE
+    uint8_t *direction;
+    // built against this edit count of the cache, rebuilt when it differs
+    uint32_t edits;
+    // last request, the least recently used field is replaced first
+    uint64_t used;
+};
+
+// Fields by goal, invalidated by any world edit and rebuilt on request
+struct FlowCache
+{
+    struct World *world;
+    struct FlowField fields[FLOW_CACHE_SIZE];
+    int count;
+    uint32_t edits;
+    uint64_t clock;
+    // bucket queue of the integration sweep, by cost / PATH_COST_STRAIGHT % 4
+    int *buckets[4];
+    int bucket_size[4];
+    int bucket_capacity[4];
+    // fields built since creation
+    int built;
+};
+
+struct FlowCache *create_flow_cache(struct World *world);
+void destroy_flow_cache(struct FlowCache *cache);
+
+// Field toward the goal tile, NULL when the goal is not walkable. The field
+// stays valid until FLOW_CACHE_SIZE other goals are requested.
+const struct FlowField *get_flow(struct FlowCache *cache, int goalX, int goalY);
+
+bool reachable_flow(const struct FlowField *flow, Vector3 position);
+// Centre of the tile to head to from position: the next tile along the
+// field, the goal on the goal tile, position itself when unreachable
+Vector3 next_flow(const struct FlowField *flow, Vector3 position);
@@ -0,0 +1,83 @@
+#include "frustum.h"
+
+#include <math.h>
+
+#include <raymath.h>
+
+static struct Plane through(Vector3 normal, Vector3 point)
+{
+    normal = Vector3Normalize(normal);
+    return (struct Plane){normal, -Vector3DotProduct(normal, point)};
+}
+
+struct Frustum create_frustum(const Camera3D *view, float aspect)
+{
+    struct Frustum frustum;
+    struct Plane *planes = frustum.planes;
+    Vector3 eye = view->position;
+    Vector3 forward = Vector3Normalize(Vector3Subtract(view->target, view->position));
+    Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, view->up));
+    Vector3 up = Vector3CrossProduct(right, forward);
+
+    if (view->projection == CAMERA_PERSPECTIVE)
+    {
+        // the sides go through the eye, opening by half the field of view
+        float vertical = tanf(view->fovy * 0.5f * DEG2RAD);
+        float horizontal = vertical * aspect;
+
+        planes[FRUSTUM_LEFT] = through(Vector3Add(right, Vector3Scale(forward, horizontal)), eye);
+        planes[FRUSTUM_RIGHT] = through(Vector3Subtract(Vector3Scale(forward, horizontal), right), eye);
+        planes[FRUSTUM_BOTTOM] = through(Vector3Add(up, Vector3Scale(forward, vertical)), eye);
+        planes[FRUSTUM_TOP] = through(Vector3Subtract(Vector3Scale(forward, vertical), up), eye);
+    }
+    else
+    {
+        // orthographic: fovy is the height of the view in world units
+        float vertical = view->fovy * 0.5f;
+        float horizontal = vertical * aspect;
+
+        planes[FRUSTUM_LEFT] = through(right, Vector3Subtract(eye, Vector3Scale(right, horizontal)));
+        planes[FRUSTUM_RIGHT] = through(Vector3Negate(right), Vector3Add(eye, Vector3Scale(right, horizontal)));
+        planes[FRUSTUM_BOTTOM] = through(up, Vector3Subtract(eye, Vector3Scale(up, vertical)));
+        planes[FRUSTUM_TOP] = through(Vector3Negate(up), Vector3Add(eye, Vector3Scale(up, vertical)));
+    }
+
+    planes[FRUSTUM_NEAR] = through(forward, Vector3Add(eye, Vector3Scale(forward, FRUSTUM_NEAR_DISTANCE)));
+    planes[FRUSTUM_FAR] = through(Vector3Negate(forward), Vector3Add(eye, Vector3Scale(forward, FRUSTUM_FAR_DISTANCE)));
+
+    return frustum;
+}
+
+bool overlaps_frustum(const struct Frustum *frustum, const Vector3 min, const Vector3 max)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        const struct Plane *plane = &frustum->planes[i];
+
+        // the corner furthest along the normal: if even it is outside, all are
+        Vector3 corner = {
+            plane->normal.x >= 0.0f ? max.x : min.x,
+            plane->normal.y >= 0.0f ? max.y : min.y,
+            plane->normal.z >= 0.0f ? max.z : min.z,
+        };
+
+        if (Vector3DotProduct(plane->normal, corner) + plane->distance < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+bool chunk_frustum(const struct Frustum *frustum, const struct World *world, int cx, int cy)
+{
+    float half = tile_size() * 0.5f;
+    int x0 = cx << CHUNK_SHIFT;
+    int y0 = cy << CHUNK_SHIFT;
+    int x1 = (x0 + CHUNK_SIZE < world->width ? x0 + CHUNK_SIZE : world->width) - 1;
+    int y1 = (y0 + CHUNK_SIZE < world->height ? y0 + CHUNK_SIZE : world->height) - 1;
+    Vector3 min = grid_to_world(world, x0, y0);
+    Vector3 max = grid_to_world(world, x1, y1);
+
+    return overlaps_frustum(frustum, (Vector3){min.x - half, 0.0f, min.z - half},
+                            (Vector3){max.x + half, 0.0f, max.z + half});
+}
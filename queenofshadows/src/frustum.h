@@ -0,0 +1,41 @@
+#pragma once
+
+#include "world.h"
+
+#include <raylib.h>
+
+// raylib's clip distances, BeginMode3D draws nothing closer or further
+#define FRUSTUM_NEAR_DISTANCE 0.01f
+#define FRUSTUM_FAR_DISTANCE 1000.0f
+
+// A point p is inside when dot(normal, p) + distance >= 0
+struct Plane
+{
+    Vector3 normal;
+    float distance;
+};
+
+enum FrustumPlane
+{
+    FRUSTUM_LEFT = 0,
+    FRUSTUM_RIGHT = 1,
+    FRUSTUM_BOTTOM = 2,
+    FRUSTUM_TOP = 3,
+    FRUSTUM_NEAR = 4,
+    FRUSTUM_FAR = 5,
+};
+
+// What a Camera3D sees, as the 6 planes around it
+struct Frustum
+{
+    struct Plane planes[6];
+};
+
+// aspect is the screen width over its height, as BeginMode3D takes it
+struct Frustum create_frustum(const Camera3D *view, float aspect);
+
+// Boxes crossing a plane count as inside: a box may be kept though it is
+// out of view at a corner, never culled while in view
+bool overlaps_frustum(const struct Frustum *frustum, const Vector3 min, const Vector3 max);
+// Tiles of chunk (cx, cy), lying on the ground plane
+bool chunk_frustum(const struct Frustum *frustum, const struct World *world, int cx, int cy);
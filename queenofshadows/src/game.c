@@ -9,15 +9,27 @@
 #define DEV_SCREEN_WIDTH 1920
 #define DEV_SCREEN_HEIGHT 1080
 
+#define WORLD_WIDTH 11
+#define WORLD_HEIGHT 11
+
+#define TICK_RATE 60
+
+#define PATH_WORKERS 2
+#define ANY_ANGLE_PATHS true
+
 struct Game create_game()
 {
     return (struct Game){
         .version = "v0.1.1",
         .name = "Queen of Shadows",
         .window = {MIN_SCREEN_WIDTH, MIN_SCREEN_HEIGHT},
+        .world = {WORLD_WIDTH, WORLD_HEIGHT},
         .debug = true,
         .environment = DEVELOPMENT,
         .target_fps = 60,
+        .tick_rate = TICK_RATE,
+        .path_workers = PATH_WORKERS,
+        .any_angle_paths = ANY_ANGLE_PATHS,
     };
 }
 
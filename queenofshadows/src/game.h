@@ -25,10 +25,22 @@ struct Game
         int width;
         int heigth;
     } window;
+    // world size in tiles
+    struct
+    {
+        int width;
+        int height;
+    } world;
     bool debug;
     enum Environment environment;
     enum OS os;
     int target_fps;
+    // simulation steps per second, independent of target_fps
+    int tick_rate;
+    // worker threads serving path requests
+    int path_workers;
+    // string pulled paths: a waypoint per turn instead of one per tile
+    bool any_angle_paths;
 };
 
 struct Game create_game();
@@ -1,13 +1,23 @@
 #pragma once
 
-#include "world.h"
-
 #include <raylib.h>
 
+// when it is close enough, stop moving
+#define WALKING_DISTANCE_TO_TARGET 0.3f
+#define STOPPING_DISTANCE_TO_TARGET 0.05f
+#define STOP_SPEED 0.0f
+// Walking Speed = 1.5 (m/s), scaled by the simulation step
+#define WALKING_SPEED 1.5f
+// Running Speed = 4.5 (m/s)
+#define RUNNING_SPEED 4.5f
+
 struct Hero
 {
     Vector3 position;
+    // where the hero is walking to
+    Vector3 target;
     bool is_moving;
+    // metres per second
     float speed;
 };
 
@@ -15,10 +25,20 @@ struct Hero create_hero(const Vector3 at);
 
 void move_hero(struct Hero *hero, const Vector3 target, const bool running);
 
-void update_hero(struct Hero *hero);
+// One simulation step of the given length
+void update_hero(struct Hero *hero, float seconds);
 
-bool find_path(struct World *world, const Vector3 start, const Vector3 end);
+// Path in world space, owned by the caller
+struct Path
+{
+    // tile centres from the first step to the goal
+    Vector3 *nodes;
+    int length;
+    int capacity;
+};
 
-int path_length_number();
+struct Path create_path();
+void destroy_path(struct Path *path);
 
-Vector3 node(int i);
+// Heads for path->nodes[*waypoint], moving on to the next one as it gets close
+void follow_path_hero(struct Hero *hero, const struct Path *path, int *waypoint, float seconds);
@@ -0,0 +1,620 @@
+#include "hierarchy.h"
+#include "error.h"
+
+#include <stdlib.h>
+
+// entrances at least this wide get a node at each end, shorter ones one in the middle
+#define WIDE_ENTRANCE 6
+// closer queries are answered by a plain A*
+#define NEAR_DISTANCE (2 * HIERARCHY_CLUSTER_SIZE)
+#define LOCAL_INDEX(x, y) ((y) * HIERARCHY_CLUSTER_SIZE + (x))
+
+enum Side
+{
+    SIDE_NORTH = 0,
+    SIDE_SOUTH = 1,
+    SIDE_WEST = 2,
+    SIDE_EAST = 3,
+};
+
+// Offset from a border tile to the tile across it, by side
+static const int side_dx[] = {0, 0, -1, 1};
+static const int side_dy[] = {-1, 1, 0, 0};
+// side of the same border seen from the other cluster
+static const int opposite[] = {SIDE_SOUTH, SIDE_NORTH, SIDE_EAST, SIDE_WEST};
+
+// Directions: up, down, left, right
+static const int dx[] = {0, 0, -1, 1};
+static const int dy[] = {-1, 1, 0, 0};
+
+struct Bounds
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+static struct Bounds bounds_cluster(const struct Hierarchy *hierarchy, int cluster)
+{
+    int x = (cluster % hierarchy->clusters_x) * HIERARCHY_CLUSTER_SIZE;
+    int y = (cluster / hierarchy->clusters_x) * HIERARCHY_CLUSTER_SIZE;
+    int width = hierarchy->world->width - x;
+    int height = hierarchy->world->height - y;
+
+    return (struct Bounds){
+        .x = x,
+        .y = y,
+        .width = width < HIERARCHY_CLUSTER_SIZE ? width : HIERARCHY_CLUSTER_SIZE,
+        .height = height < HIERARCHY_CLUSTER_SIZE ? height : HIERARCHY_CLUSTER_SIZE,
+    };
+}
+
+static int cluster_at(const struct Hierarchy *hierarchy, int x, int y)
+{
+    return (y / HIERARCHY_CLUSTER_SIZE) * hierarchy->clusters_x + x / HIERARCHY_CLUSTER_SIZE;
+}
+
+// Copies the step costs of a cluster, so local searches skip the world lookups
+static void load_cluster(struct Hierarchy *hierarchy, int index, const struct Bounds *bounds)
+{
+    if (hierarchy->loaded == index)
+        return;
+
+    for (int y = 0; y < bounds->height; y++)
+        for (int x = 0; x < bounds->width; x++)
+            hierarchy->tiles[LOCAL_INDEX(x, y)] = is_walkable(hierarchy->world, bounds->x + x, bounds->y + y)
+                                                      ? (uint8_t)(PATH_COST_STRAIGHT * movement_cost(hierarchy->world, bounds->x + x, bounds->y + y))
+                                                      : 0;
+
+    hierarchy->loaded = index;
+}
+
+// Search inside the loaded cluster from (fromX, fromY): Dijkstra over the
+// whole cluster when target is -1, else A* stopping once the target local
+// index is settled
+static void explore_cluster(struct Hierarchy *hierarchy, const struct Bounds *bounds, int fromX, int fromY, int target)
+{
+    int targetX = target < 0 ? 0 : target % HIERARCHY_CLUSTER_SIZE;
+    int targetY = target < 0 ? 0 : target / HIERARCHY_CLUSTER_SIZE;
+    int size = 0;
+
+    for (int i = 0; i < HIERARCHY_CLUSTER_SIZE * HIERARCHY_CLUSTER_SIZE; i++)
+    {
+        hierarchy->distance[i] = INT32_MAX;
+        hierarchy->closed[i] = false;
+    }
+    for (int i = 0; i < HIERARCHY_BUCKETS; i++)
+        hierarchy->buckets[i] = -1;
+
+    int from = LOCAL_INDEX(fromX - bounds->x, fromY - bounds->y);
+    // f of the current bucket in PATH_COST_STRAIGHT units, queued entries left
+    int f = target < 0 ? 0 : abs(fromX - bounds->x - targetX) + abs(fromY - bounds->y - targetY);
+    int queued = 1;
+
+    hierarchy->distance[from] = 0;
+    hierarchy->parent[from] = -1;
+    hierarchy->queue[size] = (typeof(hierarchy->queue[0])){(int16_t)from, -1};
+    hierarchy->buckets[f % HIERARCHY_BUCKETS] = (int16_t)size++;
+
+    while (queued > 0)
+    {
+        int16_t *bucket = &hierarchy->buckets[f % HIERARCHY_BUCKETS];
+        if (*bucket < 0)
+        {
+            f++;
+            continue;
+        }
+
+        int current = hierarchy->queue[*bucket].tile;
+        *bucket = hierarchy->queue[*bucket].next;
+        queued--;
+
+        // lazy: entries left behind by a cheaper path are skipped
+        if (hierarchy->closed[current])
+            continue;
+        hierarchy->closed[current] = true;
+        if (current == target)
+            return;
+
+        int lx = current % HIERARCHY_CLUSTER_SIZE;
+        int ly = current / HIERARCHY_CLUSTER_SIZE;
+        int32_t d = hierarchy->distance[current];
+
+        for (int k = 0; k < 4; k++)
+        {
+            int nx = lx + dx[k];
+            int ny = ly + dy[k];
+
+            if ((unsigned)nx >= (unsigned)bounds->width || (unsigned)ny >= (unsigned)bounds->height)
+                continue;
+
+            int next = LOCAL_INDEX(nx, ny);
+            if (hierarchy->tiles[next] == 0)
+                continue;
+
+            int32_t nd = d + hierarchy->tiles[next];
+            if (nd >= hierarchy->distance[next])
+                continue;
+
+            hierarchy->distance[next] = nd;
+            hierarchy->parent[next] = (int16_t)current;
+
+            int h = target < 0 ? 0 : abs(nx - targetX) + abs(ny - targetY);
+            int16_t *into = &hierarchy->buckets[(nd / PATH_COST_STRAIGHT + h) % HIERARCHY_BUCKETS];
+            hierarchy->queue[size] = (typeof(hierarchy->queue[0])){(int16_t)next, *into};
+            *into = (int16_t)size++;
+            queued++;
+        }
+    }
+}
+
+static void add_node(struct HierarchyCluster *cluster, int x, int y, int side)
+{
+    if (cluster->count == HIERARCHY_MAX_NODES)
+        die("Too many entrances in a cluster");
+
+    cluster->nodes[cluster->count++] = (struct HierarchyNode){x, y, side};
+}
+
+// Entrances along one border: runs of tiles walkable on both sides. Both
+// clusters sharing the border find the same runs.
+static void scan_border(struct Hierarchy *hierarchy, struct HierarchyCluster *cluster, const struct Bounds *bounds, int side)
+{
+    const struct World *world = hierarchy->world;
+    bool vertical = side == SIDE_WEST || side == SIDE_EAST;
+    int length = vertical ? bounds->height : bounds->width;
+    int run = -1;
+
+    for (int i = 0; i <= length; i++)
+    {
+        int x, y;
+        if (vertical)
+        {
+            x = side == SIDE_WEST ? bounds->x : bounds->x + bounds->width - 1;
+            y = bounds->y + i;
+        }
+        else
+        {
+            x = bounds->x + i;
+            y = side == SIDE_NORTH ? bounds->y : bounds->y + bounds->height - 1;
+        }
+
+        bool open = i < length && is_walkable(world, x, y) && is_walkable(world, x + side_dx[side], y + side_dy[side]);
+        if (open && run < 0)
+            run = i;
+        if (open || run < 0)
+            continue;
+
+        // run [run, i - 1] just ended
+        int first = run;
+        int last = i - 1;
+        run = -1;
+
+        if (last - first + 1 < WIDE_ENTRANCE)
+            first = last = (first + last) / 2;
+
+        for (int k = first; k <= last; k += last - first ? last - first : 1)
+        {
+            if (vertical)
+                add_node(cluster, x, bounds->y + k, side);
+            else
+                add_node(cluster, bounds->x + k, y, side);
+        }
+    }
+}
+
+// Entrances on every border with a neighbour and the costs between them
+static void build_cluster(struct Hierarchy *hierarchy, int index)
+{
+    struct HierarchyCluster *cluster = &hierarchy->clusters[index];
+    struct Bounds bounds = bounds_cluster(hierarchy, index);
+    int cx = index % hierarchy->clusters_x;
+    int cy = index / hierarchy->clusters_x;
+
+    cluster->count = 0;
+    if (cy > 0)
+        scan_border(hierarchy, cluster, &bounds, SIDE_NORTH);
+    if (cy < hierarchy->clusters_y - 1)
+        scan_border(hierarchy, cluster, &bounds, SIDE_SOUTH);
+    if (cx > 0)
+        scan_border(hierarchy, cluster, &bounds, SIDE_WEST);
+    if (cx < hierarchy->clusters_x - 1)
+        scan_border(hierarchy, cluster, &bounds, SIDE_EAST);
+
+    free(cluster->costs);
+    cluster->costs = malloc((size_t)(cluster->count * cluster->count + 1) * sizeof(*cluster->costs));
+    if (cluster->costs == NULL)
+        die("Failure to allocate cluster costs");
+
+    load_cluster(hierarchy, index, &bounds);
+    for (int i = 0; i < cluster->count; i++)
+    {
+        explore_cluster(hierarchy, &bounds, cluster->nodes[i].x, cluster->nodes[i].y, -1);
+        for (int j = 0; j < cluster->count; j++)
+        {
+            const struct HierarchyNode *node = &cluster->nodes[j];
+            cluster->costs[i * cluster->count + j] = hierarchy->distance[LOCAL_INDEX(node->x - bounds.x, node->y - bounds.y)];
+        }
+    }
+
+    cluster->dirty = false;
+    hierarchy->rebuilt++;
+}
+
+static struct HierarchyCluster *ready_cluster(struct Hierarchy *hierarchy, int index)
+{
+    if (hierarchy->clusters[index].dirty)
+        build_cluster(hierarchy, index);
+
+    return &hierarchy->clusters[index];
+}
+
+// World listener: the cluster of the tile goes stale, and so does the
+// neighbour across a border the tile sits on, since entrances may change
+static void edited_hierarchy(void *context, int x, int y)
+{
+    struct Hierarchy *hierarchy = context;
+    int index = cluster_at(hierarchy, x, y);
+    int lx = x % HIERARCHY_CLUSTER_SIZE;
+    int ly = y % HIERARCHY_CLUSTER_SIZE;
+
+    hierarchy->clusters[index].dirty = true;
+    hierarchy->loaded = -1;
+
+    if (lx == 0 && x > 0)
+        hierarchy->clusters[index - 1].dirty = true;
+    if (lx == HIERARCHY_CLUSTER_SIZE - 1 && x + 1 < hierarchy->world->width)
+        hierarchy->clusters[index + 1].dirty = true;
+    if (ly == 0 && y > 0)
+        hierarchy->clusters[index - hierarchy->clusters_x].dirty = true;
+    if (ly == HIERARCHY_CLUSTER_SIZE - 1 && y + 1 < hierarchy->world->height)
+        hierarchy->clusters[index + hierarchy->clusters_x].dirty = true;
+}
+
+struct Hierarchy *create_hierarchy(struct World *world)
+{
+    struct Hierarchy *hierarchy = calloc(1, sizeof(*hierarchy));
+    if (hierarchy == NULL)
+        die("Failure to allocate hierarchy");
+
+    hierarchy->world = world;
+    hierarchy->world_id = world->id;
+    hierarchy->loaded = -1;
+    hierarchy->clusters_x = (world->width + HIERARCHY_CLUSTER_SIZE - 1) / HIERARCHY_CLUSTER_SIZE;
+    hierarchy->clusters_y = (world->height + HIERARCHY_CLUSTER_SIZE - 1) / HIERARCHY_CLUSTER_SIZE;
+
+    size_t clusters = (size_t)hierarchy->clusters_x * hierarchy->clusters_y;
+    hierarchy->clusters = calloc(clusters, sizeof(*hierarchy->clusters));
+    hierarchy->abstract = calloc(clusters * HIERARCHY_MAX_NODES + 2, sizeof(*hierarchy->abstract));
+    if (hierarchy->clusters == NULL || hierarchy->abstract == NULL)
+        die("Failure to allocate hierarchy");
+
+    // nothing built yet
+    for (size_t i = 0; i < clusters; i++)
+        hierarchy->clusters[i].dirty = true;
+
+    if (!listen_world(world, edited_hierarchy, hierarchy))
+        die("Too many world listeners");
+
+    return hierarchy;
+}
+
+void destroy_hierarchy(struct Hierarchy *hierarchy)
+{
+    if (hierarchy == NULL)
+        return;
+
+    // a world made since at the same address never listed it
+    if (hierarchy->world->id == hierarchy->world_id)
+        unlisten_world(hierarchy->world, hierarchy);
+
+    for (int i = 0; i < hierarchy->clusters_x * hierarchy->clusters_y; i++)
+        free(hierarchy->clusters[i].costs);
+
+    free(hierarchy->clusters);
+    free(hierarchy->abstract);
+    free(hierarchy->open);
+    free(hierarchy->route);
+    free(hierarchy);
+}
+
+// Abstract node ids: cluster * HIERARCHY_MAX_NODES + slot, then start and goal
+struct Query
+{
+    int start;
+    int goal;
+    int startX, startY, endX, endY;
+    int start_cluster;
+    int goal_cluster;
+    // cost from the start to each node of its cluster
+    int32_t from_start[HIERARCHY_MAX_NODES];
+    // cost from each node of the goal cluster to the goal
+    int32_t to_goal[HIERARCHY_MAX_NODES];
+    // start and goal share a cluster and connect inside it
+    int32_t direct;
+};
+
+static void position_node(const struct Hierarchy *hierarchy, const struct Query *query, int id, int *x, int *y)
+{
+    if (id == query->start)
+    {
+        *x = query->startX;
+        *y = query->startY;
+    }
+    else if (id == query->goal)
+    {
+        *x = query->endX;
+        *y = query->endY;
+    }
+    else
+    {
+        const struct HierarchyNode *node = &hierarchy->clusters[id / HIERARCHY_MAX_NODES].nodes[id % HIERARCHY_MAX_NODES];
+        *x = node->x;
+        *y = node->y;
+    }
+}
+
+static void push_open(struct Hierarchy *hierarchy, struct PathHeapEntry entry)
+{
+    if (hierarchy->open_size == hierarchy->open_capacity)
+    {
+        int capacity = hierarchy->open_capacity ? hierarchy->open_capacity * 2 : 1024;
+        struct PathHeapEntry *open = realloc(hierarchy->open, (size_t)capacity * sizeof(*open));
+        if (open == NULL)
+            die("Failure to allocate hierarchy heap");
+        hierarchy->open = open;
+        hierarchy->open_capacity = capacity;
+    }
+
+    int j = hierarchy->open_size++;
+    while (j > 0 && hierarchy->open[(j - 1) / 2].key > entry.key)
+    {
+        hierarchy->open[j] = hierarchy->open[(j - 1) / 2];
+        j = (j - 1) / 2;
+    }
+    hierarchy->open[j] = entry;
+}
+
+static int pop_open(struct Hierarchy *hierarchy)
+{
+    int top = hierarchy->open[0].tile;
+    struct PathHeapEntry last = hierarchy->open[--hierarchy->open_size];
+    int size = hierarchy->open_size;
+    int i = 0;
+
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && hierarchy->open[child + 1].key < hierarchy->open[child].key)
+            child++;
+        if (last.key <= hierarchy->open[child].key)
+            break;
+        hierarchy->open[i] = hierarchy->open[child];
+        i = child;
+    }
+    if (size > 0)
+        hierarchy->open[i] = last;
+
+    return top;
+}
+
+static void relax_abstract(struct Hierarchy *hierarchy, const struct Query *query, int id, int parent, int32_t g)
+{
+    struct PathNode *node = &hierarchy->abstract[id];
+
+    if (node->stamp != hierarchy->generation)
+        *node = (struct PathNode){.stamp = hierarchy->generation, .g = INT32_MAX, .parent = -1, .heap = 0};
+    else if (node->heap < 0 || g >= node->g)
+        return;
+
+    int x, y;
+    position_node(hierarchy, query, id, &x, &y);
+    int32_t h = PATH_COST_STRAIGHT * (abs(x - query->endX) + abs(y - query->endY));
+
+    node->g = g;
+    node->parent = parent;
+    // same key as path.c: ties go to the node closest to the goal
+    push_open(hierarchy, (struct PathHeapEntry){((uint64_t)(uint32_t)(g + h) << 32) | (uint32_t)h, id});
+}
+
+static void expand_abstract(struct Hierarchy *hierarchy, const struct Query *query, int id)
+{
+    int32_t g = hierarchy->abstract[id].g;
+
+    if (id == query->start)
+    {
+        const struct HierarchyCluster *cluster = &hierarchy->clusters[query->start_cluster];
+        for (int j = 0; j < cluster->count; j++)
+            if (query->from_start[j] != INT32_MAX)
+                relax_abstract(hierarchy, query, query->start_cluster * HIERARCHY_MAX_NODES + j, id, g + query->from_start[j]);
+        if (query->direct != INT32_MAX)
+            relax_abstract(hierarchy, query, query->goal, id, g + query->direct);
+        return;
+    }
+
+    int index = id / HIERARCHY_MAX_NODES;
+    int slot = id % HIERARCHY_MAX_NODES;
+    const struct HierarchyCluster *cluster = &hierarchy->clusters[index];
+    const struct HierarchyNode *node = &cluster->nodes[slot];
+
+    // inside the cluster
+    for (int j = 0; j < cluster->count; j++)
+    {
+        int32_t cost = cluster->costs[slot * cluster->count + j];
+        if (j != slot && cost != INT32_MAX)
+            relax_abstract(hierarchy, query, index * HIERARCHY_MAX_NODES + j, id, g + cost);
+    }
+
+    if (index == query->goal_cluster && query->to_goal[slot] != INT32_MAX)
+        relax_abstract(hierarchy, query, query->goal, id, g + query->to_goal[slot]);
+
+    // across the border, to the matching entrance of the neighbour
+    int x = node->x + side_dx[node->side];
+    int y = node->y + side_dy[node->side];
+    int neighbour = cluster_at(hierarchy, x, y);
+    const struct HierarchyCluster *other = ready_cluster(hierarchy, neighbour);
+
+    for (int j = 0; j < other->count; j++)
+    {
+        if (other->nodes[j].x == x && other->nodes[j].y == y && other->nodes[j].side == opposite[node->side])
+        {
+            relax_abstract(hierarchy, query, neighbour * HIERARCHY_MAX_NODES + j, id,
+                           g + PATH_COST_STRAIGHT * movement_cost(hierarchy->world, x, y));
+            break;
+        }
+    }
+}
+
+// Tiles from (fromX, fromY) to (toX, toY), both inside one cluster
+static void refine(struct Hierarchy *hierarchy, struct PathScratch *scratch, int fromX, int fromY, int toX, int toY)
+{
+    int index = cluster_at(hierarchy, fromX, fromY);
+    struct Bounds bounds = bounds_cluster(hierarchy, index);
+    int target = LOCAL_INDEX(toX - bounds.x, toY - bounds.y);
+    int from = scratch->length;
+
+    load_cluster(hierarchy, index, &bounds);
+    explore_cluster(hierarchy, &bounds, fromX, fromY, target);
+
+    for (int i = target; hierarchy->parent[i] >= 0; i = hierarchy->parent[i])
+        append_path(scratch, (bounds.y + i / HIERARCHY_CLUSTER_SIZE) * hierarchy->world->width + bounds.x + i % HIERARCHY_CLUSTER_SIZE);
+
+    // appended goal first
+    for (int i = from, j = scratch->length - 1; i < j; i++, j--)
+    {
+        int t = scratch->path[i];
+        scratch->path[i] = scratch->path[j];
+        scratch->path[j] = t;
+    }
+}
+
+bool search_hierarchy(struct Hierarchy *hierarchy, struct PathScratch *scratch,
+                      int startX, int startY, int endX, int endY)
+{
+    const struct World *world = hierarchy->world;
+
+    if (abs(startX - endX) + abs(startY - endY) <= NEAR_DISTANCE)
+    {
+        const struct PathOptions options = {.mode = PATH_ASTAR, .heuristic = HEURISTIC_MANHATTAN};
+        return search_path(scratch, world, &options, startX, startY, endX, endY);
+    }
+
+    if (!is_walkable(world, endX, endY))
+        return false;
+    if ((unsigned)startX >= (unsigned)world->width || (unsigned)startY >= (unsigned)world->height)
+        return false;
+
+    scratch->length = 0;
+    scratch->expanded = 0;
+
+    int clusters = hierarchy->clusters_x * hierarchy->clusters_y;
+    struct Query query = {
+        .start = clusters * HIERARCHY_MAX_NODES,
+        .goal = clusters * HIERARCHY_MAX_NODES + 1,
+        .startX = startX,
+        .startY = startY,
+        .endX = endX,
+        .endY = endY,
+        .start_cluster = cluster_at(hierarchy, startX, startY),
+        .goal_cluster = cluster_at(hierarchy, endX, endY),
+        .direct = INT32_MAX,
+    };
+
+    // connect start and goal to the entrances of their clusters
+    const struct HierarchyCluster *start_cluster = ready_cluster(hierarchy, query.start_cluster);
+    const struct HierarchyCluster *goal_cluster = ready_cluster(hierarchy, query.goal_cluster);
+    struct Bounds bounds = bounds_cluster(hierarchy, query.start_cluster);
+
+    load_cluster(hierarchy, query.start_cluster, &bounds);
+    explore_cluster(hierarchy, &bounds, startX, startY, -1);
+    for (int j = 0; j < start_cluster->count; j++)
+        query.from_start[j] = hierarchy->distance[LOCAL_INDEX(start_cluster->nodes[j].x - bounds.x, start_cluster->nodes[j].y - bounds.y)];
+    if (query.start_cluster == query.goal_cluster)
+        query.direct = hierarchy->distance[LOCAL_INDEX(endX - bounds.x, endY - bounds.y)];
+
+    // costs from the goal, turned around: a path pays for the tiles it
+    // enters, so both ways differ by the cost of the two end tiles
+    bounds = bounds_cluster(hierarchy, query.goal_cluster);
+    load_cluster(hierarchy, query.goal_cluster, &bounds);
+    explore_cluster(hierarchy, &bounds, endX, endY, -1);
+    for (int j = 0; j < goal_cluster->count; j++)
+    {
+        const struct HierarchyNode *node = &goal_cluster->nodes[j];
+        int32_t d = hierarchy->distance[LOCAL_INDEX(node->x - bounds.x, node->y - bounds.y)];
+        query.to_goal[j] = d == INT32_MAX ? INT32_MAX
+                                          : d + PATH_COST_STRAIGHT * (movement_cost(world, endX, endY) - movement_cost(world, node->x, node->y));
+    }
+
+    // abstract A*
+    if (++hierarchy->generation == 0)
+    {
+        for (int i = 0; i < clusters * HIERARCHY_MAX_NODES + 2; i++)
+            hierarchy->abstract[i].stamp = 0;
+        hierarchy->generation = 1;
+    }
+    hierarchy->open_size = 0;
+    hierarchy->expanded = 0;
+
+    relax_abstract(hierarchy, &query, query.start, -1, 0);
+
+    bool found = false;
+    while (hierarchy->open_size > 0)
+    {
+        int id = pop_open(hierarchy);
+        struct PathNode *node = &hierarchy->abstract[id];
+        if (node->heap < 0)
+            continue;
+
+        node->heap = -1;
+        hierarchy->expanded++;
+
+        if (id == query.goal)
+        {
+            found = true;
+            break;
+        }
+
+        expand_abstract(hierarchy, &query, id);
+    }
+
+    scratch->expanded = hierarchy->expanded;
+    if (!found)
+        return false; // No path found
+
+    // abstract route, goal first
+    int count = 0;
+    for (int id = query.goal; id != -1; id = hierarchy->abstract[id].parent)
+    {
+        if (count == hierarchy->route_capacity)
+        {
+            int capacity = hierarchy->route_capacity ? hierarchy->route_capacity * 2 : 256;
+            int *route = realloc(hierarchy->route, (size_t)capacity * sizeof(*route));
+            if (route == NULL)
+                die("Failure to allocate hierarchy route");
+            hierarchy->route = route;
+            hierarchy->route_capacity = capacity;
+        }
+        hierarchy->route[count++] = id;
+    }
+
+    // refine each hop: inside a cluster with a local search, across a
+    // border with a single step
+    for (int i = count - 1; i > 0; i--)
+    {
+        int fromX, fromY, toX, toY;
+        position_node(hierarchy, &query, hierarchy->route[i], &fromX, &fromY);
+        position_node(hierarchy, &query, hierarchy->route[i - 1], &toX, &toY);
+
+        if (fromX == toX && fromY == toY)
+            continue;
+        if (cluster_at(hierarchy, fromX, fromY) == cluster_at(hierarchy, toX, toY))
+            refine(hierarchy, scratch, fromX, fromY, toX, toY);
+        else
+            append_path(scratch, toY * world->width + toX);
+    }
+
+    return true;
+}
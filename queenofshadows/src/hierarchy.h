@@ -0,0 +1,82 @@
+#pragma once
+
+#include "world.h"
+#include "path.h"
+
+#include <stdint.h>
+
+// cluster side in tiles
+#define HIERARCHY_CLUSTER_SIZE 32
+// entrance nodes a cluster can hold: at most 16 per border
+#define HIERARCHY_MAX_NODES 64
+// f grows by at most 4 buckets per step (water cost 3, estimate drop 1)
+#define HIERARCHY_BUCKETS 8
+
+// Entrance tile on one border of a cluster
+struct HierarchyNode
+{
+    int x;
+    int y;
+    // border it sits on: 0 north (y - 1), 1 south (y + 1), 2 west (x - 1), 3 east (x + 1)
+    int side;
+};
+
+struct HierarchyCluster
+{
+    // entrances or costs are out of date, rebuilt before next use
+    bool dirty;
+    int count;
+    struct HierarchyNode nodes[HIERARCHY_MAX_NODES];
+    // count * count path costs inside the cluster, INT32_MAX when unreachable
+    // costs[i * count + j] goes from node i to node j
+    int32_t *costs;
+};
+
+// Abstract graph over fixed size clusters of a world (HPA*). Clusters are
+// built on first use and rebuilt after a tile edit touches them.
+struct Hierarchy
+{
+    struct World *world;
+    // id of the world when the hierarchy was made: see World.id
+    unsigned world_id;
+    int clusters_x;
+    int clusters_y;
+    struct HierarchyCluster *clusters;
+
+    // local search inside one cluster, by local tile index
+    // step cost of each tile of the loaded cluster, 0 when blocked
+    uint8_t tiles[HIERARCHY_CLUSTER_SIZE * HIERARCHY_CLUSTER_SIZE];
+    // cluster held in tiles, -1 after an edit
+    int loaded;
+    int32_t distance[HIERARCHY_CLUSTER_SIZE * HIERARCHY_CLUSTER_SIZE];
+    int16_t parent[HIERARCHY_CLUSTER_SIZE * HIERARCHY_CLUSTER_SIZE];
+    bool closed[HIERARCHY_CLUSTER_SIZE * HIERARCHY_CLUSTER_SIZE];
+    // bucket queue on f / PATH_COST_STRAIGHT, step costs are multiples of it:
+    // lists of queue entries by bucket, -1 when empty
+    int16_t buckets[HIERARCHY_BUCKETS];
+    struct
+    {
+        int16_t tile;
+        int16_t next;
+    } queue[4 * HIERARCHY_CLUSTER_SIZE * HIERARCHY_CLUSTER_SIZE + 1];
+
+    // abstract search, one node per cluster slot plus start and goal
+    uint32_t generation;
+    struct PathNode *abstract;
+    struct PathHeapEntry *open;
+    int open_size;
+    int open_capacity;
+    int *route;
+    int route_capacity;
+
+    // clusters rebuilt since creation
+    int rebuilt;
+    // abstract nodes expanded by the last search
+    int expanded;
+};
+
+struct Hierarchy *create_hierarchy(struct World *world);
+void destroy_hierarchy(struct Hierarchy *hierarchy);
+
+bool search_hierarchy(struct Hierarchy *hierarchy, struct PathScratch *scratch,
+                      int startX, int startY, int endX, int endY);
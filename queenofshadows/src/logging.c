@@ -1,13 +1,34 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "logging.h"
 
 #include "error.h"
 
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <time.h>
 
+// lines per writev
+#define LOGGING_BATCH 64
+// Ring.state
+#define RING_ACTIVE 1u
+#define RING_CALLER 2u
+// flusher sleep when the ring is empty
+#define LOGGING_IDLE_NANOSECONDS 1000000
+// sites per binary log, and the bits of an id holding the site's number
+#define LOGGING_MAX_SITES 1024
+#define LOGGING_SITE_BITS 20
+
 struct Logger create_logger(int level)
 {
     if (level < 0)
@@ -16,7 +37,15 @@ struct Logger create_logger(int level)
         die("level must be between 0 and 5");
 
     return (struct Logger){
-        .level = level};
+        .level = level,
+        .rate = LOGGING_RATE,
+        .burst = LOGGING_BURST};
+}
+
+void limit_logger(struct Logger *l, double rate, int burst)
+{
+    l->rate = rate;
+    l->burst = burst > 1 ? burst : 1;
 }
 
 // struct Logger *create_logger(int level)
@@ -44,40 +73,866 @@ struct Logger create_logger(int level)
 //     free(l);
 // }
 
-int format(const char *level, const char *msg)
+// One line, filled by a caller and written by the flusher. The sequence
+// tells whose turn it is: position for a caller, position + 1 for the
+// flusher (a bounded queue as described by Dmitry Vyukov).
+struct Slot
+{
+    atomic_size_t sequence;
+    int length;
+    char line[LOGGING_LINE];
+};
+
+struct Ring
 {
-    time_t ct;      /* long integer which hold current time */
-    struct tm *lct; /* structure that contains a calendar time broken down into its components */
-    char ts[100];   /* formatted string holding current time */
-    char b[1024];   /* log entry displayed */
+    struct Slot *slots;
+    size_t mask;
+    // next position for a caller
+    _Alignas(64) atomic_size_t head;
+    // next position to write, the flusher's alone
+    _Alignas(64) size_t tail;
+    // RING_ACTIVE while it takes lines, plus RING_CALLER per caller between
+    // enter_ring and leave_ring: the slots outlive them
+    atomic_uint state;
+    atomic_bool running;
+    // binary records instead of lines
+    bool deferred;
+    enum LoggingPolicy policy;
+    int fd;
+    pthread_t flusher;
+    atomic_long queued;
+    atomic_long written;
+    atomic_long dropped;
+    atomic_long waits;
+    atomic_long batches;
+};
 
-    // get current time
-    time(&ct);
+static struct Ring ring;
+
+// LOGGER_* lines the sites kept back, for stats_logging
+static atomic_long limited;
+static atomic_long collapsed;
+// sites with repeats not reported yet, under sites
+static struct LoggingSite *repeating = NULL;
+
+// the formatted time of the current second, per thread so no lock is needed
+static _Thread_local time_t stamped = -1;
+static _Thread_local char stamp[64];
+static _Thread_local size_t stamp_length;
+
+static const char *timestamp(size_t *length)
+{
+    time_t ct = time(NULL);
     // check current time was obtained correctly
     if (ct == ((time_t)-1))
         die("Failure to obtain the current time");
 
-    // transform it to localtime and break down into tm struct
-    lct = localtime(&ct);
-    // check cast to string if ts is no big enough will fail
-    if (!strftime(ts, sizeof(ts), "%F %T %z", lct))
-        /*
-        - 0 will be returned by strftime if an error occurs formatting time
-        - null character is added by strftime
-        */
-        die("Failure to format the current time");
-
-    // build log entry: time level message
-    // copy ts to initialize b string
-    strcpy(b, ts);
-    strcat(b, " ");
-    strcat(b, level);
-    strcat(b, "\t");
-    strcat(b, msg);
-    strcat(b, "\n");
-
-    // write formatted string to the stream
-    return (int)write(STDOUT_FILENO, b, strlen(b));
+    if (ct != stamped)
+    {
+        struct tm lct;
+        if (localtime_r(&ct, &lct) == NULL)
+            die("Failure to break down the current time");
+
+        // 0 will be returned by strftime if an error occurs formatting time
+        stamp_length = strftime(stamp, sizeof(stamp), "%F %T %z", &lct);
+        if (stamp_length == 0)
+            die("Failure to format the current time");
+        stamped = ct;
+    }
+
+    *length = stamp_length;
+    return stamp;
+}
+
+// Copies what fits, returns the new length
+static size_t append(char *line, size_t length, const char *text, size_t size)
+{
+    size_t room = LOGGING_LINE - 1 - length;
+    if (size > room)
+        size = room;
+
+    memcpy(line + length, text, size);
+    return length + size;
+}
+
+// log entry: time level message, always ending with a new line
+static int build(char *line, const char *level, const char *msg)
+{
+    size_t length;
+    const char *ts = timestamp(&length);
+
+    memcpy(line, ts, length);
+    length = append(line, length, " ", 1);
+    length = append(line, length, level, strlen(level));
+    length = append(line, length, "\t", 1);
+    length = append(line, length, msg, strlen(msg));
+    line[length++] = '\n';
+
+    return (int)length;
+}
+
+// A slot for the caller, NULL when the ring is full and lines are dropped
+static struct Slot *claim(size_t *position, enum LoggingPolicy policy)
+{
+    size_t at = atomic_load_explicit(&ring.head, memory_order_relaxed);
+
+    for (;;)
+    {
+        struct Slot *slot = &ring.slots[at & ring.mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t turn = (intptr_t)sequence - (intptr_t)at;
+
+        if (turn == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring.head, &at, at + 1, memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                *position = at;
+                return slot;
+            }
+        }
+        // the flusher has not written the line a lap ago yet
+        else if (turn < 0)
+        {
+            if (policy == LOGGING_DROP)
+            {
+                atomic_fetch_add_explicit(&ring.dropped, 1, memory_order_relaxed);
+                return NULL;
+            }
+
+            atomic_fetch_add_explicit(&ring.waits, 1, memory_order_relaxed);
+            sched_yield();
+            at = atomic_load_explicit(&ring.head, memory_order_relaxed);
+        }
+        // another caller took it
+        else
+            at = atomic_load_explicit(&ring.head, memory_order_relaxed);
+    }
+}
+
+// Whether the ring takes lines; true keeps its slots until leave_ring. The
+// check and the count are one step, so stop_logging either turns the caller
+// away or waits for it.
+static bool enter_ring()
+{
+    unsigned state = atomic_load_explicit(&ring.state, memory_order_relaxed);
+
+    do
+    {
+        if (!(state & RING_ACTIVE))
+            return false;
+    } while (!atomic_compare_exchange_weak_explicit(&ring.state, &state, state + RING_CALLER, memory_order_acquire,
+                                                    memory_order_relaxed));
+
+    return true;
+}
+
+static void leave_ring()
+{
+    atomic_fetch_sub_explicit(&ring.state, RING_CALLER, memory_order_release);
+}
+
+// Hands the slot to the flusher
+static int publish(struct Slot *slot, size_t position, size_t length)
+{
+    // the slot is the flusher's once published, the length is kept here
+    slot->length = (int)length;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring.queued, 1, memory_order_relaxed);
+
+    return (int)length;
+}
+
+// Binary records, see logging.h
+
+static size_t put(char *record, size_t length, const void *value, size_t size)
+{
+    memcpy(record + length, value, size);
+    return length + size;
+}
+
+// At most room bytes of text after its length
+static size_t put_string(char *record, size_t length, const char *text, size_t room)
+{
+    size_t size = strlen(text);
+    if (size > room)
+        size = room;
+
+    uint16_t stored = (uint16_t)size;
+    length = put(record, length, &stored, sizeof(stored));
+    return put(record, length, text, size);
+}
+
+// Starts a record, its size is filled in by finish
+static size_t start_record(char *record, uint8_t kind)
+{
+    return put(record, sizeof(uint16_t), &kind, sizeof(kind));
+}
+
+static size_t finish_record(char *record, size_t length)
+{
+    uint16_t size = (uint16_t)length;
+    memcpy(record, &size, sizeof(size));
+    return length;
+}
+
+static int64_t nanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Queues the line or record of msg, the ring is entered
+static int queue(const char *level, const char *msg)
+{
+    size_t position;
+    struct Slot *slot = claim(&position, ring.policy);
+    if (slot == NULL)
+        return 0;
+
+    if (!ring.deferred)
+        return publish(slot, position, (size_t)build(slot->line, level, msg));
+
+    // the level is short, the message gets what is left
+    int64_t time = nanoseconds();
+    size_t length = start_record(slot->line, LOGGING_TEXT);
+    length = put(slot->line, length, &time, sizeof(time));
+    length = put_string(slot->line, length, level, LOGGING_LINE / 4);
+    length = put_string(slot->line, length, msg, LOGGING_LINE - length - sizeof(uint16_t));
+
+    return publish(slot, position, finish_record(slot->line, length));
+}
+
+int format(const char *level, const char *msg)
+{
+    if (!enter_ring())
+    {
+        char b[LOGGING_LINE]; /* log entry displayed */
+        int length = build(b, level, msg);
+
+        // write formatted string to the stream
+        return (int)write(STDOUT_FILENO, b, (size_t)length);
+    }
+
+    int written = queue(level, msg);
+    leave_ring();
+
+    return written;
+}
+
+// Sites of the current binary log. An id is the log's generation above
+// LOGGING_SITE_BITS and the site's number below, number 0 for the sites
+// written as text: too many, or formats that cannot be stored.
+static pthread_mutex_t sites = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int generation = 0;
+static int site_count = 0;
+static char site_kinds[LOGGING_MAX_SITES][LOGGING_MAX_ARGUMENTS];
+static int site_arguments[LOGGING_MAX_SITES];
+
+static const char *const LEVELS[] = {
+    "\x1b[4mDEBUG\x1b[0m", "\x1b[32mINFO\x1b[0m", "\x1b[33mWARN\x1b[0m",
+    "\x1b[31mERROR\x1b[0m", "\x1b[35mFATAL\x1b[0m",
+};
+
+const char *name_logging(int level)
+{
+    if (level < DEBUG || level > FATAL)
+        return "?";
+
+    return LEVELS[level];
+}
+
+int arguments_logging(const char *fmt, char *kinds)
+{
+    int count = 0;
+
+    for (const char *c = fmt; *c != '\0'; c++)
+    {
+        if (*c != '%')
+            continue;
+        c++;
+        if (*c == '%')
+            continue;
+
+        while (*c != '\0' && strchr("-+ #0'", *c) != NULL)
+            c++;
+
+        // width and precision given as arguments come first
+        for (int part = 0; part < 2; part++)
+        {
+            if (part == 1)
+            {
+                if (*c != '.')
+                    break;
+                c++;
+            }
+            if (*c == '*')
+            {
+                if (count == LOGGING_MAX_ARGUMENTS)
+                    return -1;
+                kinds[count++] = 'i';
+                c++;
+            }
+            while (*c >= '0' && *c <= '9')
+                c++;
+        }
+
+        // the length modifier picks the type
+        char length = ' ';
+        if (c[0] == 'h' && c[1] == 'h')
+            c += 2;
+        else if (c[0] == 'l' && c[1] == 'l')
+        {
+            length = 'q';
+            c += 2;
+        }
+        else if (*c == 'h')
+            c++;
+        else if (*c != '\0' && strchr("lzjtL", *c) != NULL)
+            length = *c++;
+
+        char kind;
+        switch (*c)
+        {
+        case 'd':
+        case 'i':
+            kind = length == ' ' ? 'i' : length == 'z' ? 't' : length;
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            kind = length == ' '   ? 'u'
+                   : length == 'l' ? 'm'
+                   : length == 'q' ? 'Q'
+                   : length == 'j' ? 'J'
+                   : length == 't' ? 'z'
+                                   : length;
+            break;
+        case 'c':
+            kind = 'i';
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            kind = 'd';
+            break;
+        case 's':
+            kind = 's';
+            break;
+        case 'p':
+            kind = 'p';
+            break;
+        default:
+            return -1;
+        }
+
+        // wide strings and characters, long doubles
+        if (length == 'L' || ((kind == 's' || *c == 'c') && length != ' '))
+            return -1;
+        if (count == LOGGING_MAX_ARGUMENTS)
+            return -1;
+        kinds[count++] = kind;
+    }
+
+    return count;
+}
+
+static size_t size_of(char kind)
+{
+    switch (kind)
+    {
+    case 'i':
+    case 'u':
+        return sizeof(int32_t);
+    case 's':
+        return sizeof(uint16_t);
+    default:
+        return sizeof(int64_t);
+    }
+}
+
+// The site's number in the current log, written there the first time
+static int lookup(struct LoggingSite *site)
+{
+    int current = atomic_load_explicit(&generation, memory_order_acquire);
+    int id = atomic_load_explicit(&site->id, memory_order_acquire);
+    if (id >> LOGGING_SITE_BITS == current)
+        return id & ((1 << LOGGING_SITE_BITS) - 1);
+
+    pthread_mutex_lock(&sites);
+
+    current = atomic_load_explicit(&generation, memory_order_relaxed);
+    id = atomic_load_explicit(&site->id, memory_order_relaxed);
+    if (id >> LOGGING_SITE_BITS != current)
+    {
+        int number = 0;
+        char kinds[LOGGING_MAX_ARGUMENTS];
+        int arguments = arguments_logging(site->fmt, kinds);
+        size_t strings = strlen(site->file) + strlen(site->fmt);
+
+        // the format has to fit whole, the decoder needs all of it
+        if (site_count + 1 < LOGGING_MAX_SITES && arguments >= 0 && strings < LOGGING_LINE / 2)
+        {
+            number = ++site_count;
+            memcpy(site_kinds[number], kinds, (size_t)arguments);
+            site_arguments[number] = arguments;
+
+            // never dropped, the events after it would be lost with it
+            size_t position;
+            struct Slot *slot = claim(&position, LOGGING_BLOCK);
+            int32_t fields[3] = {number, site->level, site->line};
+
+            size_t length = start_record(slot->line, LOGGING_SITE);
+            length = put(slot->line, length, fields, sizeof(fields));
+            length = put_string(slot->line, length, site->file, LOGGING_LINE);
+            length = put_string(slot->line, length, site->fmt, LOGGING_LINE);
+            publish(slot, position, finish_record(slot->line, length));
+        }
+
+        id = current << LOGGING_SITE_BITS | number;
+        atomic_store_explicit(&site->id, id, memory_order_release);
+    }
+
+    pthread_mutex_unlock(&sites);
+
+    return id & ((1 << LOGGING_SITE_BITS) - 1);
+}
+
+// The event with its arguments as they are, no formatting; returns its size
+static size_t encode(char *record, int number, va_list args)
+{
+    const char *kinds = site_kinds[number];
+    int arguments = site_arguments[number];
+
+    // what the arguments left need at least, so a long string leaves room
+    size_t left = 0;
+    for (int i = 0; i < arguments; i++)
+        left += size_of(kinds[i]);
+
+    uint32_t stored = (uint32_t)number;
+    int64_t time = nanoseconds();
+    size_t length = start_record(record, LOGGING_EVENT);
+    length = put(record, length, &stored, sizeof(stored));
+    length = put(record, length, &time, sizeof(time));
+
+    for (int i = 0; i < arguments; i++)
+    {
+        int32_t small = 0;
+        int64_t large = 0;
+
+        switch (kinds[i])
+        {
+        case 'i':
+            small = va_arg(args, int);
+            break;
+        case 'u':
+            small = (int32_t)va_arg(args, unsigned);
+            break;
+        case 'l':
+            large = va_arg(args, long);
+            break;
+        case 'm':
+            large = (int64_t)va_arg(args, unsigned long);
+            break;
+        case 'q':
+            large = va_arg(args, long long);
+            break;
+        case 'Q':
+            large = (int64_t)va_arg(args, unsigned long long);
+            break;
+        case 'z':
+            large = (int64_t)va_arg(args, size_t);
+            break;
+        case 't':
+            large = va_arg(args, ptrdiff_t);
+            break;
+        case 'j':
+            large = va_arg(args, intmax_t);
+            break;
+        case 'J':
+            large = (int64_t)va_arg(args, uintmax_t);
+            break;
+        case 'd':
+            {
+                double value = va_arg(args, double);
+                memcpy(&large, &value, sizeof(value));
+            }
+            break;
+        case 'p':
+            large = (int64_t)(uintptr_t)va_arg(args, void *);
+            break;
+        case 's':
+            {
+                const char *text = va_arg(args, const char *);
+                left -= sizeof(uint16_t);
+                length = put_string(record, length, text == NULL ? "(null)" : text,
+                                    LOGGING_LINE - length - left - sizeof(uint16_t));
+            }
+            continue;
+        }
+
+        left -= size_of(kinds[i]);
+        if (size_of(kinds[i]) == sizeof(small))
+            length = put(record, length, &small, sizeof(small));
+        else
+            length = put(record, length, &large, sizeof(large));
+    }
+
+    return finish_record(record, length);
+}
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+// FNV-1a, to tell a message from the last one of its site
+static uint64_t hash(const char *bytes, size_t size)
+{
+    uint64_t value = 0xcbf29ce484222325u;
+    for (size_t i = 0; i < size; i++)
+        value = (value ^ (unsigned char)bytes[i]) * 0x100000001b3u;
+
+    return value;
+}
+
+static void lock_site(struct LoggingSite *site)
+{
+    while (atomic_flag_test_and_set_explicit(&site->lock, memory_order_acquire))
+        ;
+}
+
+static void unlock_site(struct LoggingSite *site)
+{
+    atomic_flag_clear_explicit(&site->lock, memory_order_release);
+}
+
+// Remembered once, so stop_logging reports what is still counted
+static void list_site(struct LoggingSite *site)
+{
+    if (atomic_load_explicit(&site->listed, memory_order_relaxed) ||
+        atomic_exchange_explicit(&site->listed, true, memory_order_relaxed))
+        return;
+
+    pthread_mutex_lock(&sites);
+    site->next = repeating;
+    repeating = site;
+    pthread_mutex_unlock(&sites);
+}
+
+// What a site kept back since its last line
+struct Kept
+{
+    long repeated;
+    long suppressed;
+};
+
+// Taken out under the site's lock, so report can write it once unlocked
+static struct Kept take(struct LoggingSite *site)
+{
+    struct Kept kept = {site->repeated, site->suppressed};
+    site->repeated = 0;
+    site->suppressed = 0;
+
+    return kept;
+}
+
+static void report(const struct LoggingSite *site, struct Kept kept)
+{
+    char msg[LOGGING_LINE];
+
+    if (kept.repeated > 0)
+    {
+        snprintf(msg, sizeof(msg), "last message repeated %ld times (%s:%d)", kept.repeated, site->file, site->line);
+        format(name_logging(site->level), msg);
+    }
+    if (kept.suppressed > 0)
+    {
+        snprintf(msg, sizeof(msg), "%ld messages suppressed (%s:%d)", kept.suppressed, site->file, site->line);
+        format(name_logging(site->level), msg);
+    }
+}
+
+// Takes a token from the site's bucket, false when it is empty; nothing is
+// formatted yet
+static bool spend(const struct Logger *l, struct LoggingSite *site, double now)
+{
+    bool spent = true;
+
+    lock_site(site);
+    if (l->rate > 0.0)
+    {
+        site->tokens = site->refilled > 0.0 ? site->tokens + (now - site->refilled) * l->rate : l->burst;
+        if (site->tokens > l->burst)
+            site->tokens = l->burst;
+        site->refilled = now;
+
+        if (site->tokens < 1.0)
+        {
+            site->suppressed++;
+            spent = false;
+        }
+        else
+            site->tokens -= 1.0;
+    }
+    unlock_site(site);
+
+    if (!spent)
+    {
+        atomic_fetch_add_explicit(&limited, 1, memory_order_relaxed);
+        list_site(site);
+    }
+    return spent;
+}
+
+// Whether the message with this hash is written; what the site kept back is
+// reported before it, after the lock is released
+static bool admit(struct LoggingSite *site, uint64_t value, double now)
+{
+    struct Kept kept = {0, 0};
+    bool admitted = true;
+
+    lock_site(site);
+    if (site->reported > 0.0 && value == site->last)
+    {
+        // a repeat does not use up its token
+        site->tokens += 1.0;
+        site->repeated++;
+        admitted = false;
+
+        // a message stuck on repeat still shows it is alive
+        if (now - site->reported >= LOGGING_REPEAT_SECONDS)
+        {
+            kept = take(site);
+            site->reported = now;
+        }
+    }
+    else
+    {
+        kept = take(site);
+        site->last = value;
+        site->reported = now;
+    }
+    unlock_site(site);
+
+    if (!admitted)
+    {
+        atomic_fetch_add_explicit(&collapsed, 1, memory_order_relaxed);
+        list_site(site);
+    }
+    report(site, kept);
+
+    return admitted;
+}
+
+// writev until everything is out, pipes and terminals may take less
+static void write_all(struct iovec *lines, int count)
+{
+    while (count > 0)
+    {
+        ssize_t written = writev(ring.fd, lines, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            // nowhere to write: the lines are lost, the callers go on
+            return;
+        }
+
+        while (count > 0 && (size_t)written >= lines->iov_len)
+        {
+            written -= (ssize_t)lines->iov_len;
+            lines++;
+            count--;
+        }
+        if (count > 0)
+        {
+            lines->iov_base = (char *)lines->iov_base + written;
+            lines->iov_len -= (size_t)written;
+        }
+    }
+}
+
+static void *flush(void *unused)
+{
+    struct iovec lines[LOGGING_BATCH];
+
+    (void)unused;
+    for (;;)
+    {
+        int count = 0;
+        while (count < LOGGING_BATCH)
+        {
+            struct Slot *slot = &ring.slots[(ring.tail + count) & ring.mask];
+            if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != ring.tail + count + 1)
+                break;
+
+            lines[count++] = (struct iovec){slot->line, (size_t)slot->length};
+        }
+
+        if (count == 0)
+        {
+            // stopped and drained; checked before looking again, so a
+            // line queued before the stop is still written
+            if (!atomic_load_explicit(&ring.running, memory_order_acquire))
+            {
+                if (atomic_load_explicit(&ring.slots[ring.tail & ring.mask].sequence, memory_order_acquire) !=
+                    ring.tail + 1)
+                    return NULL;
+                continue;
+            }
+
+            nanosleep(&(struct timespec){0, LOGGING_IDLE_NANOSECONDS}, NULL);
+            continue;
+        }
+
+        write_all(lines, count);
+
+        // the slots go back to the callers, one lap later
+        for (int i = 0; i < count; i++)
+            atomic_store_explicit(&ring.slots[(ring.tail + i) & ring.mask].sequence, ring.tail + i + ring.mask + 1,
+                                  memory_order_release);
+        ring.tail += (size_t)count;
+
+        atomic_fetch_add_explicit(&ring.written, count, memory_order_relaxed);
+        atomic_fetch_add_explicit(&ring.batches, 1, memory_order_relaxed);
+    }
+}
+
+static bool start(int fd, int slots, enum LoggingPolicy policy, bool deferred)
+{
+    static bool registered = false;
+
+    if ((atomic_load(&ring.state) & RING_ACTIVE) || slots <= 0)
+        return false;
+
+    size_t capacity = 1;
+    while (capacity < (size_t)slots)
+        capacity *= 2;
+
+    struct Slot *allocated = malloc(capacity * sizeof(*allocated));
+    if (allocated == NULL)
+        die("Failure to allocate the logging ring");
+
+    for (size_t i = 0; i < capacity; i++)
+        atomic_init(&allocated[i].sequence, i);
+
+    ring.slots = allocated;
+    ring.mask = capacity - 1;
+    atomic_store(&ring.head, 0);
+    ring.tail = 0;
+    ring.policy = policy;
+    ring.fd = fd;
+    ring.deferred = deferred;
+    atomic_store(&ring.queued, 0);
+    atomic_store(&ring.written, 0);
+    atomic_store(&ring.dropped, 0);
+    atomic_store(&ring.waits, 0);
+    atomic_store(&ring.batches, 0);
+    atomic_store(&ring.running, true);
+
+    if (deferred)
+    {
+        // a new log, every site is written to it again
+        pthread_mutex_lock(&sites);
+        int next = atomic_load_explicit(&generation, memory_order_relaxed) % ((1 << (31 - LOGGING_SITE_BITS)) - 1) + 1;
+        site_count = 0;
+        atomic_store_explicit(&generation, next, memory_order_release);
+        pthread_mutex_unlock(&sites);
+
+        if (write(fd, LOGGING_MAGIC, strlen(LOGGING_MAGIC)) != (ssize_t)strlen(LOGGING_MAGIC))
+        {
+            free(ring.slots);
+            ring.slots = NULL;
+            return false;
+        }
+    }
+
+    if (pthread_create(&ring.flusher, NULL, flush, NULL) != 0)
+    {
+        free(ring.slots);
+        ring.slots = NULL;
+        return false;
+    }
+
+    atomic_fetch_or_explicit(&ring.state, RING_ACTIVE, memory_order_release);
+
+    // a die() or a return from main still gets the queued lines out
+    if (!registered)
+        registered = atexit(stop_logging) == 0;
+
+    return true;
+}
+
+bool start_logging(int fd, int slots, enum LoggingPolicy policy)
+{
+    return start(fd, slots, policy, false);
+}
+
+bool defer_logging(int fd, int slots, enum LoggingPolicy policy)
+{
+    return start(fd, slots, policy, true);
+}
+
+// Repeats and suppressed lines still counted, while the ring is up
+static void report_sites()
+{
+    // the list only grows at its head, the rest can be walked unlocked
+    pthread_mutex_lock(&sites);
+    struct LoggingSite *site = repeating;
+    pthread_mutex_unlock(&sites);
+
+    for (; site != NULL; site = site->next)
+    {
+        lock_site(site);
+        struct Kept kept = take(site);
+        unlock_site(site);
+
+        report(site, kept);
+    }
+}
+
+void stop_logging()
+{
+    report_sites();
+
+    if (!(atomic_fetch_and(&ring.state, ~RING_ACTIVE) & RING_ACTIVE))
+        return;
+
+    // callers still in the ring finish their slots, the flusher keeps
+    // freeing slots for the blocked ones until then
+    while (atomic_load_explicit(&ring.state, memory_order_acquire) != 0)
+        sched_yield();
+
+    atomic_store_explicit(&ring.running, false, memory_order_release);
+    pthread_join(ring.flusher, NULL);
+
+    free(ring.slots);
+    ring.slots = NULL;
+}
+
+struct LoggingStats stats_logging()
+{
+    return (struct LoggingStats){
+        .queued = atomic_load(&ring.queued),
+        .written = atomic_load(&ring.written),
+        .dropped = atomic_load(&ring.dropped),
+        .waits = atomic_load(&ring.waits),
+        .batches = atomic_load(&ring.batches),
+        .limited = atomic_load(&limited),
+        .collapsed = atomic_load(&collapsed),
+    };
 }
 
 bool check(const struct Logger *l, const int level)
@@ -96,7 +951,22 @@ int debug(const struct Logger *l, const char *msg)
     if (!check(l, DEBUG))
         return 0;
 
-    return format("\x1b[4mDEBUG\x1b[0m", msg);
+    return format(LEVELS[DEBUG], msg);
+}
+
+int debugf(const struct Logger *l, const char *fmt, ...)
+{
+    if (!check(l, DEBUG))
+        return 0;
+
+    char msg[512];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    return format(LEVELS[DEBUG], msg);
 }
 
 int info(const struct Logger *l, const char *msg)
@@ -104,7 +974,7 @@ int info(const struct Logger *l, const char *msg)
     if (!check(l, INFO))
         return 0;
 
-    return format("\x1b[32mINFO\x1b[0m", msg);
+    return format(LEVELS[INFO], msg);
 }
 
 int warn(const struct Logger *l, const char *msg)
@@ -112,7 +982,7 @@ int warn(const struct Logger *l, const char *msg)
     if (!check(l, WARN))
         return 0;
 
-    return format("\x1b[33mWARN\x1b[0m", msg);
+    return format(LEVELS[WARN], msg);
 }
 
 int error(const struct Logger *l, const char *msg)
@@ -120,7 +990,7 @@ int error(const struct Logger *l, const char *msg)
     if (!check(l, ERROR))
         return 0;
 
-    return format("\x1b[31mERROR\x1b[0m", msg);
+    return format(LEVELS[ERROR], msg);
 }
 
 int fatal(const struct Logger *l, const char *msg)
@@ -128,5 +998,60 @@ int fatal(const struct Logger *l, const char *msg)
     if (!check(l, FATAL))
         return 0;
 
-    return format("\x1b[35mFATAL\x1b[0m", msg);
+    return format(LEVELS[FATAL], msg);
+}
+
+int write_logger(const struct Logger *l, struct LoggingSite *site, ...)
+{
+    if (!check(l, site->level))
+        return 0;
+
+    // refused before anything is formatted
+    double now = seconds();
+    if (!spend(l, site, now))
+        return 0;
+
+    va_list args;
+    va_start(args, site);
+
+    int written = -1;
+    if (enter_ring())
+    {
+        int number = ring.deferred ? lookup(site) : 0;
+        if (number > 0)
+        {
+            // the arguments tell repeats apart, the time is left out
+            char record[LOGGING_LINE];
+            size_t length = encode(record, number, args);
+            size_t start = sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(int64_t);
+
+            written = 0;
+            if (admit(site, hash(record + start, length - start), now))
+            {
+                size_t position;
+                struct Slot *slot = claim(&position, ring.policy);
+                if (slot != NULL)
+                {
+                    memcpy(slot->line, record, length);
+                    written = publish(slot, position, length);
+                }
+            }
+        }
+        leave_ring();
+    }
+
+    // formatted here, and sent as text to a binary log
+    if (written < 0)
+    {
+        char msg[LOGGING_LINE];
+        vsnprintf(msg, sizeof(msg), site->fmt, args);
+
+        written = 0;
+        if (admit(site, hash(msg, strlen(msg)), now))
+            written = format(name_logging(site->level), msg);
+    }
+
+    va_end(args);
+
+    return written;
 }
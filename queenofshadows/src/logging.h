@@ -1,3 +1,10 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
 struct Logger;
 
 #define DEBUG 0
@@ -10,14 +17,182 @@ struct Logger;
 struct Logger
 {
     int level;
+    // lines per second each LOGGER_* site may write, 0 for no limit
+    double rate;
+    // lines a quiet site may write at once
+    int burst;
 };
 
+// Sites write at most LOGGING_RATE lines per second after a burst of
+// LOGGING_BURST; the same message again is counted, not written
+#define LOGGING_RATE 10.0
+#define LOGGING_BURST 20
+// a site repeating one message says so at least this often
+#define LOGGING_REPEAT_SECONDS 1.0
+
 struct Logger create_logger(int level);
+// rate <= 0 lets every line through, repeats are still collapsed
+void limit_logger(struct Logger *l, double rate, int burst);
 // struct Logger *create_logger(int level);
 // void destroy_logger(struct Logger *l);
 
 int debug(const struct Logger *l, const char *msg);
+int debugf(const struct Logger *l, const char *fmt, ...);
 int info(const struct Logger *l, const char *msg);
 int warn(const struct Logger *l, const char *msg);
 int error(const struct Logger *l, const char *msg);
 int fatal(const struct Logger *l, const char *msg);
+
+// Asynchronous output. Once started, a log call formats its line into a slot
+// of a lock-free ring and returns; a background thread writes the lines in
+// batches with writev. Stopped, every call writes its own line.
+
+// What a log call does when the ring is full
+enum LoggingPolicy
+{
+    // the line is lost and counted, the caller never waits
+    LOGGING_DROP = 0,
+    // the caller yields until the flusher frees a slot
+    LOGGING_BLOCK = 1,
+};
+
+struct LoggingStats
+{
+    long queued;
+    long written;
+    long dropped;
+    // yields of callers waiting for a slot
+    long waits;
+    // writev calls
+    long batches;
+    // LOGGER_* lines refused by their site's rate, and repeats collapsed;
+    // counted since the program started, not since start_logging
+    long limited;
+    long collapsed;
+};
+
+// Lines longer than this are cut, in both modes
+#define LOGGING_LINE 512
+
+// slots is rounded up to a power of two; memory is slots * LOGGING_LINE.
+// Stopped at exit, lines still queued are written then.
+bool start_logging(int fd, int slots, enum LoggingPolicy policy);
+// Writes what is queued and joins the flusher, once the other threads are
+// done logging
+void stop_logging();
+struct LoggingStats stats_logging();
+
+// Deferred output. Like start_logging, but a call stores its format's id and
+// its raw arguments instead of the formatted line, and fd receives a binary
+// log for decoder/decoder to format offline. The first call of each
+// LOGGER_* site in a log also stores the site: level, file, line, format.
+bool defer_logging(int fd, int slots, enum LoggingPolicy policy);
+
+// Binary log layout, native byte order: LOGGING_MAGIC, then records each
+// starting with a uint16_t size (itself included) and a uint8_t kind
+#define LOGGING_MAGIC "QOSLOG1\n"
+// uint32_t number, int32_t level, int32_t line, file and fmt as strings
+#define LOGGING_SITE 1
+// uint32_t number, int64_t nanoseconds since the epoch, the arguments
+#define LOGGING_EVENT 2
+// int64_t nanoseconds since the epoch, level and message as strings
+#define LOGGING_TEXT 3
+
+// Arguments of a format are stored by C type, one letter each: i int, u
+// unsigned, l long, m unsigned long, q long long, Q unsigned long long,
+// z size_t, t ptrdiff_t, j intmax_t, J uintmax_t (8 bytes but i and u), d
+// double, s string (uint16_t length and bytes, cut to fit) and p pointer
+#define LOGGING_MAX_ARGUMENTS 16
+
+// Writes the kinds of fmt's arguments into kinds, returns their number or -1
+// when fmt has a conversion deferred logging cannot store (%n, %ls, %Lf or
+// more than LOGGING_MAX_ARGUMENTS)
+int arguments_logging(const char *fmt, char *kinds);
+// The level as printed, DEBUG to FATAL
+const char *name_logging(int level);
+
+// A LOGGER_* call site, static so its state lives as long as the program
+// and a call never allocates
+struct LoggingSite
+{
+    int level;
+    const char *file;
+    int line;
+    const char *fmt;
+    // generation and number in the current binary log, 0 before
+    atomic_int id;
+
+    // the counts below are held under lock, calls come from the path workers
+    // too; nothing is formatted or written while it is held
+    atomic_flag lock;
+    // token bucket, refilled at the logger's rate; 0 seconds before the first call
+    double tokens;
+    double refilled;
+    // hash of the last message written, copies of it since and when they
+    // were last reported
+    uint64_t last;
+    long repeated;
+    double reported;
+    // lines refused since the last one written
+    long suppressed;
+    // sites with repeats to report when logging stops, next under its mutex
+    struct LoggingSite *next;
+    atomic_bool listed;
+};
+
+// Formats and writes site->fmt when l lets its level through, its site's
+// rate allows it and it is not the site's last message again
+int write_logger(const struct Logger *l, struct LoggingSite *site, ...);
+
+// Calls below this level are compiled out, arguments included, so they cost
+// nothing in the frame loop. Debug builds keep everything by default.
+#ifndef LOGGING_MIN_LEVEL
+#ifdef NDEBUG
+#define LOGGING_MIN_LEVEL INFO
+#else
+#define LOGGING_MIN_LEVEL DEBUG
+#endif
+#endif
+
+#define LOGGER_AT(l, lvl, text, ...)                                                                                   \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        /* never runs, the compiler checks the arguments against text */                                               \
+        if (0)                                                                                                         \
+            printf(text __VA_OPT__(, ) __VA_ARGS__);                                                                   \
+        static struct LoggingSite logging_site = {                                                                     \
+            .level = lvl, .file = __FILE__, .line = __LINE__, .fmt = text, .lock = ATOMIC_FLAG_INIT};                  \
+        write_logger(l, &logging_site __VA_OPT__(, ) __VA_ARGS__);                                                     \
+    } while (0)
+
+#define LOGGER_OFF(l) ((void)(l))
+
+#if LOGGING_MIN_LEVEL <= DEBUG
+#define LOGGER_DEBUG(l, ...) LOGGER_AT(l, DEBUG, __VA_ARGS__)
+#else
+#define LOGGER_DEBUG(l, ...) LOGGER_OFF(l)
+#endif
+
+#if LOGGING_MIN_LEVEL <= INFO
+#define LOGGER_INFO(l, ...) LOGGER_AT(l, INFO, __VA_ARGS__)
+#else
+#define LOGGER_INFO(l, ...) LOGGER_OFF(l)
+#endif
+
+#if LOGGING_MIN_LEVEL <= WARN
+#define LOGGER_WARN(l, ...) LOGGER_AT(l, WARN, __VA_ARGS__)
+#else
+#define LOGGER_WARN(l, ...) LOGGER_OFF(l)
+#endif
+
+#if LOGGING_MIN_LEVEL <= ERROR
+#define LOGGER_ERROR(l, ...) LOGGER_AT(l, ERROR, __VA_ARGS__)
+#else
+#define LOGGER_ERROR(l, ...) LOGGER_OFF(l)
+#endif
+
+#if LOGGING_MIN_LEVEL <= FATAL
+#define LOGGER_FATAL(l, ...) LOGGER_AT(l, FATAL, __VA_ARGS__)
+#else
+#define LOGGER_FATAL(l, ...) LOGGER_OFF(l)
+#endif
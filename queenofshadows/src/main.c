@@ -1,15 +1,27 @@
 #include "logging.h"
 #include "camera.h"
 #include "world.h"
-#include "hero.h"
 #include "game.h"
+#include "simulation.h"
+#include "floor.h"
+#include "frustum.h"
+#include "recording.h"
+#include "timings.h"
+#include "error.h"
 
 #include <raylib.h>
 #include <raymath.h>
+#include <raykit.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #define DOUBLE_CLICK_TIME 0.5f
+#define PROFILE_FILE "profile.json"
+// log lines in flight; a frame never waits on the terminal, past this they are dropped
+#define LOGGING_SLOTS 1024
 
 struct Player
 {
@@ -47,13 +59,44 @@ bool double_click(bool *first_click, float *last_click_time)
 static float last_click_time = 0.0f;
 static bool first_click = false;
 
-int main(void)
+// --record FILE writes the input of every frame, --replay FILE plays one
+// back instead of the mouse and keyboard and prints the frame times, --log
+// FILE writes a binary log for decoder/decoder instead of lines to stdout
+int main(int argc, char **argv)
 {
     /* Initialization */
     struct Player player = {"UUID_PLAYER", true};
     struct Game game = create_game();
     struct Logger logger = create_logger(game.debug ? DEBUG : trace(&player));
 
+    const char *record = NULL;
+    const char *replay = NULL;
+    const char *binary_log = NULL;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--record") == 0)
+            record = argv[i + 1];
+        else if (strcmp(argv[i], "--replay") == 0)
+            replay = argv[i + 1];
+        else if (strcmp(argv[i], "--log") == 0)
+            binary_log = argv[i + 1];
+    }
+
+    if (binary_log != NULL)
+    {
+        // kept open until exit, the flusher writes to it until then
+        int fd = open(binary_log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || !defer_logging(fd, LOGGING_SLOTS, LOGGING_BLOCK))
+        {
+            if (fd >= 0)
+                close(fd);
+            error(&logger, "Binary log cannot be created");
+            return EXIT_FAILURE;
+        }
+    }
+    else if (!start_logging(STDOUT_FILENO, LOGGING_SLOTS, LOGGING_DROP))
+        warn(&logger, "Logging synchronously");
+
     info(&logger, "Initializating...");
 
     // if setup fails return error
@@ -62,102 +105,239 @@ int main(void)
         return 0;
     }
 
+    struct Replayer *replayer = NULL;
+    if (replay != NULL)
+    {
+        replayer = create_replayer(replay);
+        if (replayer == NULL)
+        {
+            error(&logger, "Recording cannot be read");
+            return EXIT_FAILURE;
+        }
+
+        // recorded on the game world, only its settings may differ
+        game.tick_rate = replayer->header.tick_rate;
+        game.world.width = replayer->header.world_width;
+        game.world.height = replayer->header.world_height;
+        game.any_angle_paths = replayer->header.any_angle_paths;
+    }
+
+    struct Recorder *recorder = NULL;
+    if (record != NULL)
+    {
+        const struct RecordingHeader header = {
+            .tick_rate = game.tick_rate,
+            .world_width = game.world.width,
+            .world_height = game.world.height,
+            .seed = 0,
+            .any_angle_paths = game.any_angle_paths,
+        };
+
+        recorder = create_recorder(record, &header);
+        if (recorder == NULL)
+        {
+            error(&logger, "Recording cannot be created");
+            return EXIT_FAILURE;
+        }
+    }
+
     info(&logger, "Running...");
 
     InitWindow(game.window.width, game.window.heigth, game.name);
 
     SetTargetFPS(game.target_fps);
 
-    struct World world = create_world();
-    world_init(&world);
-
-    struct Hero hero = create_hero((Vector3){.0f, .0f, 0.f});
-    // initialize camera by hero position
-    struct Camera camera = create_camera(hero.position);
+    struct Simulation *simulation = create_simulation(&game);
+    const struct Hero *hero = &simulation->hero;
+    const struct Camera *camera = &simulation->camera;
+    struct Floor *floor = create_floor(&simulation->world);
+    struct RenderList list = create_render_list();
+    // path nodes, all in one instanced draw
+    Mesh marker = GenMeshCube(0.3f, 0.2f, 0.3f);
+    struct Instancing markers = create_instancing(YELLOW, true);
+    Matrix *marker_transforms = NULL;
+    int marker_capacity = 0;
+    // what the last frame showed, clicks are cast through it
+    struct Camera shown = *camera;
+
+    // work per frame, without the wait for the next one
+    struct Timings timings = create_timings(0);
 
     while (!WindowShouldClose())
     {
-        // float _ = GetFrameTime();
-        // printf("%f %f\n", hero.position.x, hero.position.z);
+        PROFILE_FRAME();
+
+        double begin = GetTime();
+        struct Input input = {0};
+        float seconds = GetFrameTime();
+
+        PROFILE_BEGIN("input");
+
+        if (replayer != NULL)
+        {
+            if (!replay_replayer(replayer, &input, &seconds))
+                break;
+        }
+        else
+        {
+            // Action Input
+            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+            {
+                // From mouse position, generate a ray
+                input.click = true;
+                input.target = raycast_camera(&shown, GetMousePosition());
+                input.running = double_click(&first_click, &last_click_time);
+                LOGGER_DEBUG(&logger, "click at (%.2f, %.2f)%s", input.target.x, input.target.z,
+                             input.running ? ", running" : "");
+            }
+
+            // Camera Input
+            input.rotate_clockwise = IsKeyPressed(KEY_A);
+            input.rotate_counter_clockwise = IsKeyPressed(KEY_D);
+            input.zoom_in = IsKeyDown(KEY_W);
+            input.zoom_out = IsKeyDown(KEY_S);
+        }
 
-        // Action Input
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+#if CONFIG_ENABLE_PROFILING
+        // the last frames, right after a spike
+        if (IsKeyPressed(KEY_F9))
         {
-            // From mouse position, generate a ray
-            Vector3 ray = raycast_camera(&camera, GetMousePosition());
-            if (find_path(&world, hero.position, ray))
-                move_hero(&hero, ray, double_click(&first_click, &last_click_time));
+            if (export_profiler(PROFILE_FILE))
+                info(&logger, "Profile written to " PROFILE_FILE);
+            else
+                error(&logger, "Profile cannot be written");
         }
+#endif
 
-        // Camera Input
-        if (IsKeyDown(KEY_W))
-            zoom_in_camera(&camera);
+        PROFILE_END();
 
-        if (IsKeyDown(KEY_S))
-            zoom_out_camera(&camera);
+        // Simulation
+        PROFILE_BEGIN("simulation");
+        frame_simulation(simulation, &input, seconds);
+        PROFILE_END();
 
-        if (IsKeyPressed(KEY_A))
-            clockwise_rotate_camera(&camera);
+        if (recorder != NULL)
+            record_recorder(recorder, &input, simulation->collected, seconds);
 
-        if (IsKeyPressed(KEY_D))
-            counter_clockwise_rotate_camera(&camera);
+        Vector3 hero_position = hero_simulation(simulation);
+        shown = *camera;
+        shown.view = view_simulation(simulation);
 
-        update_hero(&hero);
-        update_camera(&camera, hero.position);
+        // Drawing, recorded first and drawn sorted by state
+        PROFILE_BEGIN("draw");
 
-        // Drawing
+        reset_render_list(&list);
 
-        BeginDrawing();
-        ClearBackground((Color){15, 15, 15, 255});
+        struct Frustum frustum = create_frustum(&shown.view, (float)GetScreenWidth() / GetScreenHeight());
 
-        BeginMode3D(camera.view);
+        record_cube(&list, hero_position, (Vector3){0.5f, 2.0f, 0.5f}, RED);
+        record_cube_wires(&list, hero_position, (Vector3){0.5f, 2.0f, 0.5f}, BLUE);
 
-        DrawCube(hero.position, 0.5f, 2.0f, 0.5f, RED);
-        DrawCubeWires(hero.position, 0.5f, 2.0f, 0.5f, BLUE);
+        record_grid(&list, 22, 0.5f);
 
-        DrawGrid(22, 0.5f);
+        // Walkable tiles, a mesh per chunk
+        draw_floor(floor, &frustum, &list);
 
-        // Draw 3D walkable grid
-        for (int x = -1 * grid_size(); x < grid_size() + 1; x++)
+        // Draw path, the nodes in view
+        if (simulation->path.length > marker_capacity)
         {
-            for (int z = -1 * grid_size(); z < grid_size() + 1; z++)
-            {
-                Vector3 position = {x * tile_size(), 0.0f, z * tile_size()};
-                Color tileColor;
-
-                int vx, vy;
-                world_to_grid(position, &vx, &vy);
-
-                if (is_walkable(&world, vx, vy) == 1)
-                {
-                    tileColor = ((x + z) % 2 == 0) ? (Color){100, 100, 100, 200} : (Color){120, 120, 120, 200};
-                    DrawCube(position, tile_size() * 0.95f, 0.0f, tile_size() * 0.95f, tileColor);
-                    DrawCubeWires(position, tile_size(), 0.0f, tile_size(), LIGHTGRAY);
-                }
-            }
+            marker_capacity = simulation->path.length;
+            marker_transforms = realloc(marker_transforms, (size_t)marker_capacity * sizeof(*marker_transforms));
+            if (marker_transforms == NULL)
+                die("Failure to allocate path markers");
         }
 
-        // Draw path
-        for (int i = 0; i < path_length_number(); i++)
+        int nodes_drawn = 0;
+        for (int i = 0; i < simulation->path.length; i++)
         {
-            Vector3 pathPos = node(i);
+            Vector3 pathPos = simulation->path.nodes[i];
             pathPos.y = 0.1f;
+            if (!overlaps_frustum(&frustum, (Vector3){pathPos.x - 0.15f, 0.0f, pathPos.z - 0.15f},
+                                  (Vector3){pathPos.x + 0.15f, 0.2f, pathPos.z + 0.15f}))
+                continue;
             // Color pathColor = (i <= currentPathIndex) ? GREEN : YELLOW;
-            DrawCube(pathPos, 0.3f, 0.2f, 0.3f, YELLOW);
+            marker_transforms[nodes_drawn++] = MatrixTranslate(pathPos.x, pathPos.y, pathPos.z);
         }
-
-        EndMode3D();
+        record_instances(&list, &marker, &markers, marker_transforms, nodes_drawn);
 
         if (game.debug)
         {
-            DrawText(TextFormat("%s %s", game.name, game.version), 10, 10, 10, GREEN);
-            DrawText(TextFormat("%s (%.0f)", position_camera(&camera), camera.angle), 10, 30, 10, GREEN);
-            DrawText(TextFormat("Hero: %.2f %.2f", hero.position.x, hero.position.z), 10, 45, 10, GREEN);
+            record_text(&list, TextFormat("%s %s", game.name, game.version), 10, 10, 10, GREEN);
+            record_text(&list, TextFormat("%s (%.0f)", position_camera(camera), camera->angle), 10, 30, 10, GREEN);
+            record_text(&list, TextFormat("Hero: %.2f %.2f", hero->position.x, hero->position.z), 10, 45, 10, GREEN);
+
+            struct PathfinderStats stats = stats_pathfinder(simulation->pathfinder);
+            record_text(&list,
+                        TextFormat("Paths: queue %d (peak %d), latency %.2f ms (max %.2f ms)", stats.depth,
+                                   stats.peak_depth,
+                                   stats.completed ? stats.latency_total * 1000.0 / stats.completed : 0.0,
+                                   stats.latency_max * 1000.0),
+                        10, 60, 10, GREEN);
+            record_text(&list,
+                        TextFormat("Simulation: %d Hz, %ld steps, %.2f s dropped", game.tick_rate,
+                                   simulation->clock.steps, simulation->clock.dropped),
+                        10, 75, 10, GREEN);
+            record_text(&list,
+                        TextFormat("Floor: %d draw calls, %d vertices for %d tiles (%d immediate calls before), "
+                                   "%ld chunk builds",
+                                   floor->stats.draw_calls, floor->stats.vertices, floor->stats.tiles,
+                                   2 * floor->stats.tiles, floor->stats.rebuilt),
+                        10, 90, 10, GREEN);
+            record_text(&list,
+                        TextFormat("Culling: chunks %d drawn, %d culled; path nodes %d drawn, %d culled",
+                                   floor->stats.draw_calls, floor->stats.culled, nodes_drawn,
+                                   simulation->path.length - nodes_drawn),
+                        10, 105, 10, GREEN);
+            // the list is sorted when drawn, so these are the last frame's
+            record_text(&list,
+                        TextFormat("Render: %d commands, %d draw calls (%d unsorted), %d state changes, "
+                                   "path markers %s",
+                                   list.stats.commands, list.stats.draw_calls, list.stats.unsorted_draw_calls,
+                                   list.stats.state_changes, markers.instanced ? "instanced" : "one per node"),
+                        10, 120, 10, GREEN);
+#if CONFIG_ENABLE_PROFILING
+            record_profiler(&list, 10, 140, 10, GREEN);
+#endif
         }
+
+        PROFILE_END();
+
+        BeginDrawing();
+        ClearBackground((Color){15, 15, 15, 255});
+
+        PROFILE_BEGIN("flush");
+        flush_render_list(&list, &shown.view);
+        PROFILE_END();
+
+        add_timings(&timings, GetTime() - begin);
         EndDrawing();
     }
 
+    // meshes go while the window is still open
+    destroy_render_list(&list);
+    free(marker_transforms);
+    destroy_instancing(&markers);
+    UnloadMesh(marker);
+    destroy_floor(floor);
     CloseWindow();
 
+    if (replayer != NULL)
+    {
+        // compare with the same recording replayed before a change, or headless
+        print_timings(&timings, stdout, "frame");
+        printf("hero  %.4f %.4f\n", hero->position.x, hero->position.z);
+    }
+
+    if (!destroy_recorder(recorder))
+        error(&logger, "Recording cannot be written");
+    destroy_replayer(replayer);
+    destroy_timings(&timings);
+    destroy_simulation(simulation);
+
+    struct LoggingStats logged = stats_logging();
+    if (logged.dropped > 0)
+        fprintf(stderr, "%ld log lines dropped\n", logged.dropped);
+    stop_logging();
+
     return 0;
 }
\ No newline at end of file
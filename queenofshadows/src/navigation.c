@@ -0,0 +1,153 @@
+#include "navigation.h"
+#include "error.h"
+
+#include <stdlib.h>
+
+#include <raylib.h>
+
+// Heads for the next tile of a flow field, call before update_hero each
+// step. The hero stops on the goal tile, or where it stands when the
+// goal cannot be reached.
+void steer_hero(struct Hero *hero, const struct FlowField *flow)
+{
+    if (!hero->is_moving || flow == NULL)
+        return;
+
+    hero->target = next_flow(flow, hero->position);
+    hero->target.y = hero->position.y;
+}
+
+// Heads for the next tile of a replanned path, call before update_hero each
+// step. Edits since the last step are repaired here; the hero stops when
+// they cut it off from the goal.
+bool follow_hero(struct Hero *hero, struct ReplanPath *path)
+{
+    const struct World *world = path->owner->world;
+    int x, y, nextX, nextY;
+
+    if (!hero->is_moving)
+        return true;
+
+    world_to_grid(world, hero->position, &x, &y);
+    if (!step_replanner(path, x, y, &nextX, &nextY))
+    {
+        hero->is_moving = false;
+        hero->speed = STOP_SPEED;
+        return false;
+    }
+
+    hero->target = grid_to_world(world, nextX, nextY);
+    hero->target.y = hero->position.y;
+    return true;
+}
+
+struct PathContext create_path_context(const struct Logger *logger)
+{
+    return (struct PathContext){
+        .scratch = create_path_scratch(),
+        .hierarchy = NULL,
+        .regions = NULL,
+        .logger = logger,
+        .any_angle = false,
+        .hierarchical = false,
+    };
+}
+
+void destroy_path_context(struct PathContext *context)
+{
+    destroy_hierarchy(context->hierarchy);
+    destroy_path_scratch(&context->scratch);
+    *context = (struct PathContext){0};
+}
+
+bool find_path_with(struct PathContext *context, struct World *world, const Vector3 start, const Vector3 end,
+                    const struct PathOptions *options, struct Path *path)
+{
+    struct PathScratch *scratch = &context->scratch;
+    int startX, startY, endX, endY;
+
+    world_to_grid(world, start, &startX, &startY);
+    world_to_grid(world, end, &endX, &endY);
+
+    // different regions: no search can succeed
+    if (context->regions != NULL && label_regions(context->regions, startX, startY) != 0 &&
+        !connected_regions(context->regions, startX, startY, endX, endY))
+    {
+        if (context->logger != NULL)
+            LOGGER_DEBUG(context->logger, "path: (%d, %d) cannot reach (%d, %d)", startX, startY, endX, endY);
+        return false;
+    }
+
+    bool found;
+    if (options->mode == PATH_HIERARCHICAL)
+    {
+        if (context->hierarchy != NULL && (context->hierarchy->world != world || context->hierarchy->world_id != world->id))
+        {
+            destroy_hierarchy(context->hierarchy);
+            context->hierarchy = NULL;
+        }
+        if (context->hierarchy == NULL)
+            context->hierarchy = create_hierarchy(world);
+
+        found = search_hierarchy(context->hierarchy, scratch, startX, startY, endX, endY);
+        if (found && options->any_angle)
+            pull_path(scratch, world, startX, startY);
+    }
+    else
+        found = search_path(scratch, world, options, startX, startY, endX, endY);
+
+    if (!found)
+    {
+        if (context->logger != NULL)
+            LOGGER_DEBUG(context->logger, "path: none from (%d, %d) to (%d, %d)", startX, startY, endX, endY);
+        return false;
+    }
+
+    if (scratch->length > path->capacity)
+    {
+        Vector3 *grown = realloc(path->nodes, (size_t)scratch->length * sizeof(*path->nodes));
+        if (grown == NULL)
+            die("Failure to allocate path nodes");
+        path->nodes = grown;
+        path->capacity = scratch->length;
+    }
+
+    for (int i = 0; i < scratch->length; i++)
+        path->nodes[i] = grid_to_world(world, scratch->path[i] % world->width, scratch->path[i] / world->width);
+
+    path->length = scratch->length;
+
+    if (context->logger != NULL)
+        LOGGER_DEBUG(context->logger, "path: %d nodes from (%d, %d) to (%d, %d), %d expanded", path->length, startX, startY,
+                  endX, endY, scratch->expanded);
+
+    return true;
+}
+
+// Pathfinding over 4 neighbours: A*, or HPA* on large worlds when the
+// context asks for it
+bool find_path(struct PathContext *context, struct World *world, const Vector3 start, const Vector3 end, struct Path *path)
+{
+    bool hierarchical = context->hierarchical && world->width * world->height >= HIERARCHICAL_MIN_TILES;
+    const struct PathOptions options = {
+        .mode = hierarchical ? PATH_HIERARCHICAL : PATH_ASTAR,
+        .heuristic = HEURISTIC_MANHATTAN,
+        .any_angle = context->any_angle,
+    };
+
+    Vector3 goal = end;
+    if (context->regions != NULL)
+    {
+        int startX, startY, endX, endY;
+
+        world_to_grid(world, start, &startX, &startY);
+        world_to_grid(world, end, &endX, &endY);
+
+        // clicks on blocked or cut off tiles go to the closest tile within reach
+        if (!connected_regions(context->regions, startX, startY, endX, endY) &&
+            nearest_regions(context->regions, startX, startY, &endX, &endY))
+            goal = grid_to_world(world, endX, endY);
+    }
+
+    return find_path_with(context, world, start, goal, &options, path);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "hero.h"
+#include "world.h"
+#include "path.h"
+#include "hierarchy.h"
+#include "flow.h"
+#include "regions.h"
+#include "replanner.h"
+#include "logging.h"
+
+#include <raylib.h>
+
+// worlds from this many tiles up are searched over the cluster hierarchy by
+// contexts that ask for it: below, A* is as fast and the clusters cost more
+// to build than they save
+#define HIERARCHICAL_MIN_TILES (512 * 512)
+
+// Search state of one caller, reused between its queries. Contexts are
+// independent: one per thread lets searches run concurrently.
+struct PathContext
+{
+    struct PathScratch scratch;
+    // built on the first hierarchical search, bound to that world
+    struct Hierarchy *hierarchy;
+    // rejects goals in another region without searching, may be NULL
+    const struct Regions *regions;
+    // diagnostics, may be NULL
+    const struct Logger *logger;
+    // find_path returns string pulled waypoints instead of every tile
+    bool any_angle;
+    // find_path searches over the hierarchy on worlds of HIERARCHICAL_MIN_TILES
+    // or more, 3 to 4 times faster from 1024x1024 up. Its paths are not the
+    // shortest: bench_hierarchy measures them 0.4 to 2% longer on open maps,
+    // and nothing bounds them on mazes. The hierarchy listens to the world,
+    // so only set it on contexts used by the thread that edits the world.
+    bool hierarchical;
+};
+
+struct PathContext create_path_context(const struct Logger *logger);
+void destroy_path_context(struct PathContext *context);
+
+// Both leave path untouched when no path is found. With regions, find_path
+// retargets unreachable goals to the nearest reachable tile. find_path
+// returns a shortest path unless the context is hierarchical.
+bool find_path(struct PathContext *context, struct World *world, const Vector3 start, const Vector3 end, struct Path *path);
+bool find_path_with(struct PathContext *context, struct World *world, const Vector3 start, const Vector3 end,
+                    const struct PathOptions *options, struct Path *path);
+
+// Steering a hero along a flow field or a replanned path, call before
+// update_hero each step
+void steer_hero(struct Hero *hero, const struct FlowField *flow);
+bool follow_hero(struct Hero *hero, struct ReplanPath *path);
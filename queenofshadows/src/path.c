@@ -0,0 +1,686 @@
+#include "path.h"
+#include "error.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Directions: up, down, left, right, then the diagonals
+static const int dx[] = {0, 0, -1, 1, -1, 1, -1, 1};
+static const int dy[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+
+struct PathScratch create_path_scratch()
+{
+    return (struct PathScratch){0};
+}
+
+void destroy_path_scratch(struct PathScratch *scratch)
+{
+    free(scratch->nodes);
+    free(scratch->open.entries);
+    free(scratch->path);
+    *scratch = (struct PathScratch){0};
+}
+
+static struct PathNode *grow_nodes(struct PathNode *nodes, size_t tiles)
+{
+    free(nodes);
+    // stamp 0 is never a live generation, zeroed nodes read as unseen
+    nodes = calloc(tiles, sizeof(*nodes));
+    if (nodes == NULL)
+        die("Failure to allocate path nodes");
+
+    return nodes;
+}
+
+// Make room for the world and start a new generation
+static void begin_path_scratch(struct PathScratch *scratch, size_t tiles)
+{
+    if (tiles > scratch->capacity)
+    {
+        scratch->nodes = grow_nodes(scratch->nodes, tiles);
+        scratch->capacity = tiles;
+        scratch->generation = 0;
+    }
+
+    // on wrap around, stale stamps could match again: clear once
+    if (++scratch->generation == 0)
+    {
+        memset(scratch->nodes, 0, scratch->capacity * sizeof(*scratch->nodes));
+        scratch->generation = 1;
+    }
+
+    scratch->open.size = 0;
+    scratch->length = 0;
+    scratch->expanded = 0;
+}
+
+static void swap_heap(struct PathHeap *heap, struct PathNode *nodes, int a, int b)
+{
+    struct PathHeapEntry t = heap->entries[a];
+    heap->entries[a] = heap->entries[b];
+    heap->entries[b] = t;
+    nodes[heap->entries[a].tile].heap = a;
+    nodes[heap->entries[b].tile].heap = b;
+}
+
+static void up_heap(struct PathHeap *heap, struct PathNode *nodes, int i)
+{
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (heap->entries[parent].key <= heap->entries[i].key)
+            break;
+        swap_heap(heap, nodes, i, parent);
+        i = parent;
+    }
+}
+
+static void down_heap(struct PathHeap *heap, struct PathNode *nodes, int i)
+{
+    for (;;)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+
+        if (left < heap->size && heap->entries[left].key < heap->entries[smallest].key)
+            smallest = left;
+        if (right < heap->size && heap->entries[right].key < heap->entries[smallest].key)
+            smallest = right;
+        if (smallest == i)
+            break;
+        swap_heap(heap, nodes, i, smallest);
+        i = smallest;
+    }
+}
+
+// Insert a tile or lower its key if already open
+static void push_heap(struct PathHeap *heap, struct PathNode *nodes, int tile, uint64_t key)
+{
+    struct PathNode *node = &nodes[tile];
+
+    if (node->heap >= 0)
+    {
+        heap->entries[node->heap].key = key;
+        up_heap(heap, nodes, node->heap);
+        return;
+    }
+
+    if (heap->size == heap->capacity)
+    {
+        int capacity = heap->capacity ? heap->capacity * 2 : 1024;
+        struct PathHeapEntry *entries = realloc(heap->entries, (size_t)capacity * sizeof(*entries));
+        if (entries == NULL)
+            die("Failure to allocate path heap");
+        heap->entries = entries;
+        heap->capacity = capacity;
+    }
+
+    heap->entries[heap->size] = (struct PathHeapEntry){key, tile};
+    node->heap = heap->size;
+    heap->size++;
+    up_heap(heap, nodes, node->heap);
+}
+
+static int pop_heap(struct PathHeap *heap, struct PathNode *nodes)
+{
+    int tile = heap->entries[0].tile;
+
+    heap->size--;
+    if (heap->size > 0)
+    {
+        heap->entries[0] = heap->entries[heap->size];
+        nodes[heap->entries[0].tile].heap = 0;
+        down_heap(heap, nodes, 0);
+    }
+
+    nodes[tile].heap = -1;
+    return tile;
+}
+
+static int32_t heuristic(enum PathHeuristic kind, int x, int y, int goalX, int goalY)
+{
+    int ax = abs(x - goalX);
+    int ay = abs(y - goalY);
+    int32_t octile = PATH_COST_STRAIGHT * (ax + ay) + (PATH_COST_DIAGONAL - 2 * PATH_COST_STRAIGHT) * (ax < ay ? ax : ay);
+    int32_t euclidean;
+
+    switch (kind)
+    {
+    case HEURISTIC_MANHATTAN:
+        return PATH_COST_STRAIGHT * (ax + ay);
+    case HEURISTIC_OCTILE:
+        return octile;
+    case HEURISTIC_EUCLIDEAN:
+        // diagonal steps cost a bit less than sqrt(2), never go above octile
+        euclidean = (int32_t)(PATH_COST_STRAIGHT * sqrtf((float)(ax * ax + ay * ay)));
+        return euclidean < octile ? euclidean : octile;
+    default:
+        return 0;
+    }
+}
+
+static uint64_t key_heap(int32_t g, int32_t h)
+{
+    return ((uint64_t)(uint32_t)(g + h) << 32) | (uint32_t)h;
+}
+
+void append_path(struct PathScratch *scratch, int tile)
+{
+    if (scratch->length == scratch->path_capacity)
+    {
+        int capacity = scratch->path_capacity ? scratch->path_capacity * 2 : 256;
+        int *path = realloc(scratch->path, (size_t)capacity * sizeof(*path));
+        if (path == NULL)
+            die("Failure to allocate path");
+        scratch->path = path;
+        scratch->path_capacity = capacity;
+    }
+
+    scratch->path[scratch->length++] = tile;
+}
+
+static void reverse_path(struct PathScratch *scratch, int from)
+{
+    for (int i = from, j = scratch->length - 1; i < j; i++, j--)
+    {
+        int t = scratch->path[i];
+        scratch->path[i] = scratch->path[j];
+        scratch->path[j] = t;
+    }
+}
+
+// Open a neighbour with a new cost if it improves on what it had, the
+// estimate towards (goalX, goalY) is only computed for improved tiles
+static void relax(struct PathScratch *scratch, struct PathNode *nodes, struct PathHeap *heap,
+                  int tile, int parent, int32_t g, enum PathHeuristic kind,
+                  int x, int y, int goalX, int goalY)
+{
+    struct PathNode *node = &nodes[tile];
+
+    if (node->stamp != scratch->generation)
+        *node = (struct PathNode){.stamp = scratch->generation, .g = INT32_MAX, .parent = -1, .heap = -1};
+    else if (node->heap < 0 || g >= node->g)
+        // closed nodes are final with a consistent heuristic
+        return;
+
+    node->g = g;
+    node->parent = parent;
+    push_heap(heap, nodes, tile, key_heap(g, heuristic(kind, x, y, goalX, goalY)));
+}
+
+// Number of neighbour directions to try
+static int directions(const struct PathOptions *options)
+{
+    return options->diagonal ? 8 : 4;
+}
+
+// Diagonal steps may not cut corners: both side tiles must be walkable
+static bool can_step(const struct World *world, int x, int y, int i)
+{
+    if (!is_walkable(world, x + dx[i], y + dy[i]))
+        return false;
+    if (i < 4)
+        return true;
+
+    return is_walkable(world, x + dx[i], y) && is_walkable(world, x, y + dy[i]);
+}
+
+static int32_t step_cost(int i)
+{
+    return i < 4 ? PATH_COST_STRAIGHT : PATH_COST_DIAGONAL;
+}
+
+static bool astar(struct PathScratch *scratch, const struct World *world, const struct PathOptions *options,
+                  int startX, int startY, int endX, int endY)
+{
+    int width = world->width;
+    struct PathNode *nodes = scratch->nodes;
+    struct PathHeap *open = &scratch->open;
+    int start = startY * width + startX;
+    int goal = endY * width + endX;
+
+    relax(scratch, nodes, open, start, -1, 0, options->heuristic, startX, startY, endX, endY);
+
+    while (open->size > 0)
+    {
+        int current = pop_heap(open, nodes);
+        scratch->expanded++;
+
+        // Found target
+        if (current == goal)
+        {
+            // Build path backwards (skip start position)
+            for (int tile = goal; tile != start; tile = nodes[tile].parent)
+                append_path(scratch, tile);
+            reverse_path(scratch, 0);
+            return true;
+        }
+
+        int x = current % width;
+        int y = current / width;
+        int32_t g = nodes[current].g;
+
+        for (int i = 0; i < directions(options); i++)
+        {
+            if (!can_step(world, x, y, i))
+                continue;
+
+            int newX = x + dx[i];
+            int newY = y + dy[i];
+
+            relax(scratch, nodes, open, newY * width + newX, current,
+                  g + step_cost(i) * movement_cost(world, newX, newY),
+                  options->heuristic, newX, newY, endX, endY);
+        }
+    }
+
+    return false; // No path found
+}
+
+// Walkable bits seen as lines of 64 bit words: the world rows, or the
+// transposed columns. Lines run along the major axis, bits along the minor.
+struct Plane
+{
+    const struct Chunk *chunks;
+    // chunks along the minor axis
+    int stride;
+    int majors;
+    int minors;
+};
+
+static uint64_t word_plane(const struct Plane *plane, int major, int chunk)
+{
+    if ((unsigned)major >= (unsigned)plane->majors || (unsigned)chunk >= (unsigned)plane->stride)
+        return 0;
+
+    return plane->chunks[(major >> CHUNK_SHIFT) * plane->stride + chunk].walkable[major & CHUNK_MASK];
+}
+
+// Straight jump along one line of the plane, a word at a time. Stops on
+// the goal, on a blocked tile (no jump point) or on a forced neighbour: a
+// tile of a side line that opens up right after one that was blocked.
+// returns the minor of the jump point or -1
+static int scan_plane(const struct Plane *plane, int major, int minor, int dir, int goal)
+{
+    while ((unsigned)minor < (unsigned)plane->minors)
+    {
+        int chunk = minor >> CHUNK_SHIFT;
+        int bit = minor & CHUNK_MASK;
+        uint64_t own = word_plane(plane, major, chunk);
+        uint64_t before = word_plane(plane, major - 1, chunk);
+        uint64_t after = word_plane(plane, major + 1, chunk);
+        uint64_t behind_before, behind_after, mask;
+
+        // side lines shifted by one tile against the direction of travel
+        if (dir > 0)
+        {
+            behind_before = (before << 1) | (word_plane(plane, major - 1, chunk - 1) >> CHUNK_MASK);
+            behind_after = (after << 1) | (word_plane(plane, major + 1, chunk - 1) >> CHUNK_MASK);
+            mask = ~(uint64_t)0 << bit;
+        }
+        else
+        {
+            behind_before = (before >> 1) | (word_plane(plane, major - 1, chunk + 1) << CHUNK_MASK);
+            behind_after = (after >> 1) | (word_plane(plane, major + 1, chunk + 1) << CHUNK_MASK);
+            mask = ~(uint64_t)0 >> (CHUNK_MASK - bit);
+        }
+
+        uint64_t stop = ((before & ~behind_before) | (after & ~behind_after) | ~own) & mask;
+        if (goal >= 0 && (goal >> CHUNK_SHIFT) == chunk)
+            stop |= ((uint64_t)1 << (goal & CHUNK_MASK)) & mask;
+
+        if (stop)
+        {
+            int i = dir > 0 ? __builtin_ctzll(stop) : CHUNK_MASK - __builtin_clzll(stop);
+            if (!((own >> i) & 1))
+                return -1;
+
+            return (chunk << CHUNK_SHIFT) | i;
+        }
+
+        minor = dir > 0 ? (chunk + 1) << CHUNK_SHIFT : (chunk << CHUNK_SHIFT) - 1;
+    }
+
+    return -1;
+}
+
+struct Jump
+{
+    struct Plane rows;
+    struct Plane columns;
+    int goalX;
+    int goalY;
+};
+
+static int jump_horizontal(const struct Jump *jump, int x, int y, int dir)
+{
+    return scan_plane(&jump->rows, y, x, dir, y == jump->goalY ? jump->goalX : -1);
+}
+
+static int jump_vertical(const struct Jump *jump, int x, int y, int dir)
+{
+    return scan_plane(&jump->columns, x, y, dir, x == jump->goalX ? jump->goalY : -1);
+}
+
+// Jump from (x, y) moving (moveX, moveY), returns the jump point tile or -1
+static int jump_from(const struct World *world, const struct Jump *jump, bool diagonal, int x, int y, int moveX, int moveY)
+{
+    int width = world->width;
+
+    if (moveY == 0)
+    {
+        int jx = jump_horizontal(jump, x, y, moveX);
+        return jx < 0 ? -1 : y * width + jx;
+    }
+
+    if (moveX == 0 && diagonal)
+    {
+        int jy = jump_vertical(jump, x, y, moveY);
+        return jy < 0 ? -1 : jy * width + x;
+    }
+
+    // diagonal moves, and vertical ones on 4 neighbour grids, stop where
+    // a perpendicular jump finds something
+    for (;;)
+    {
+        if (!is_walkable(world, x, y))
+            return -1;
+        if (x == jump->goalX && y == jump->goalY)
+            return y * width + x;
+
+        if (moveX != 0)
+        {
+            if (jump_horizontal(jump, x + moveX, y, moveX) >= 0 || jump_vertical(jump, x, y + moveY, moveY) >= 0)
+                return y * width + x;
+            // no corner cutting
+            if (!is_walkable(world, x + moveX, y) || !is_walkable(world, x, y + moveY))
+                return -1;
+        }
+        else
+        {
+            // forced neighbour: a side tile opens up after a blocked one
+            if ((is_walkable(world, x - 1, y) && !is_walkable(world, x - 1, y - moveY)) ||
+                (is_walkable(world, x + 1, y) && !is_walkable(world, x + 1, y - moveY)))
+                return y * width + x;
+            if (jump_horizontal(jump, x + 1, y, 1) >= 0 || jump_horizontal(jump, x - 1, y, -1) >= 0)
+                return y * width + x;
+        }
+
+        x += moveX;
+        y += moveY;
+    }
+}
+
+static int sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+// Directions worth jumping towards from a node reached moving (px, py):
+// the natural ones plus those opened by obstacles
+static int prune(const struct World *world, bool diagonal, int x, int y, int px, int py, int moves[8][2])
+{
+    int count = 0;
+
+    if (px == 0 && py == 0)
+    {
+        // start node: every neighbour
+        for (int i = 0; i < (diagonal ? 8 : 4); i++)
+        {
+            if (can_step(world, x, y, i))
+            {
+                moves[count][0] = dx[i];
+                moves[count][1] = dy[i];
+                count++;
+            }
+        }
+        return count;
+    }
+
+    if (px != 0 && py != 0)
+    {
+        bool walkX = is_walkable(world, x + px, y);
+        bool walkY = is_walkable(world, x, y + py);
+
+        if (walkY)
+            moves[count][0] = 0, moves[count][1] = py, count++;
+        if (walkX)
+            moves[count][0] = px, moves[count][1] = 0, count++;
+        if (walkX && walkY)
+            moves[count][0] = px, moves[count][1] = py, count++;
+        return count;
+    }
+
+    // straight move: ahead, both sides, and the diagonals ahead
+    int sideX = py != 0;
+    int sideY = px != 0;
+    bool ahead = is_walkable(world, x + px, y + py);
+    bool left = is_walkable(world, x - sideX, y - sideY);
+    bool right = is_walkable(world, x + sideX, y + sideY);
+
+    if (ahead)
+        moves[count][0] = px, moves[count][1] = py, count++;
+    if (left)
+        moves[count][0] = -sideX, moves[count][1] = -sideY, count++;
+    if (right)
+        moves[count][0] = sideX, moves[count][1] = sideY, count++;
+    if (diagonal && ahead && left)
+        moves[count][0] = px - sideX, moves[count][1] = py - sideY, count++;
+    if (diagonal && ahead && right)
+        moves[count][0] = px + sideX, moves[count][1] = py + sideY, count++;
+
+    return count;
+}
+
+// Jump Point Search on uniform cost grids, terrain costs are ignored.
+// Only jump points enter the open heap, the tiles in between are filled
+// in when the path is built.
+static bool jps(struct PathScratch *scratch, const struct World *world, const struct PathOptions *options,
+                int startX, int startY, int endX, int endY)
+{
+    int width = world->width;
+    struct PathNode *nodes = scratch->nodes;
+    struct PathHeap *open = &scratch->open;
+    int start = startY * width + startX;
+    int goal = endY * width + endX;
+    const struct Jump jump = {
+        .rows = {world->chunks, world->chunks_x, world->height, world->width},
+        .columns = {world->columns, world->chunks_y, world->width, world->height},
+        .goalX = endX,
+        .goalY = endY,
+    };
+
+    relax(scratch, nodes, open, start, -1, 0, options->heuristic, startX, startY, endX, endY);
+
+    while (open->size > 0)
+    {
+        int current = pop_heap(open, nodes);
+        scratch->expanded++;
+
+        if (current == goal)
+        {
+            // Build path backwards, every tile between two jump points
+            for (int tile = goal; tile != start; tile = nodes[tile].parent)
+            {
+                int parent = nodes[tile].parent;
+                int stepX = sign(parent % width - tile % width);
+                int stepY = sign(parent / width - tile / width);
+
+                for (int t = tile; t != parent; t += stepY * width + stepX)
+                    append_path(scratch, t);
+            }
+            reverse_path(scratch, 0);
+            return true;
+        }
+
+        int x = current % width;
+        int y = current / width;
+        int parent = nodes[current].parent;
+        int px = parent < 0 ? 0 : sign(x - parent % width);
+        int py = parent < 0 ? 0 : sign(y - parent / width);
+        int moves[8][2];
+        int count = prune(world, options->diagonal, x, y, px, py, moves);
+
+        for (int i = 0; i < count; i++)
+        {
+            int point = jump_from(world, &jump, options->diagonal, x + moves[i][0], y + moves[i][1], moves[i][0], moves[i][1]);
+            if (point < 0)
+                continue;
+
+            int jx = point % width;
+            int jy = point / width;
+            int ax = abs(jx - x);
+            int ay = abs(jy - y);
+            // segments are straight or diagonal lines
+            int32_t cost = ax && ay ? PATH_COST_DIAGONAL * ax : PATH_COST_STRAIGHT * (ax + ay);
+
+            relax(scratch, nodes, open, point, current, nodes[current].g + cost, options->heuristic, jx, jy, endX, endY);
+        }
+    }
+
+    return false; // No path found
+}
+
+bool search_path(struct PathScratch *scratch, const struct World *world, const struct PathOptions *options,
+                 int startX, int startY, int endX, int endY)
+{
+    if (!is_walkable(world, endX, endY))
+        return false;
+    if (startX == endX && startY == endY)
+        return false;
+    if ((unsigned)startX >= (unsigned)world->width || (unsigned)startY >= (unsigned)world->height)
+        return false;
+
+    struct PathOptions checked = *options;
+    // manhattan overestimates diagonal steps
+    if (checked.diagonal && checked.heuristic == HEURISTIC_MANHATTAN)
+        checked.heuristic = HEURISTIC_OCTILE;
+
+    begin_path_scratch(scratch, (size_t)world->width * world->height);
+
+    bool found;
+    switch (checked.mode)
+    {
+    case PATH_JPS:
+        found = jps(scratch, world, &checked, startX, startY, endX, endY);
+        break;
+    default:
+        // PATH_HIERARCHICAL without a Hierarchy runs a plain A*
+        found = astar(scratch, world, &checked, startX, startY, endX, endY);
+        break;
+    }
+
+    if (found && checked.any_angle)
+        pull_path(scratch, world, startX, startY);
+
+    return found;
+}
+
+static bool passable(const struct World *world, int x, int y, int maxCost)
+{
+    return is_walkable(world, x, y) && movement_cost(world, x, y) <= maxCost;
+}
+
+// Walks every tile the segment between the centres of (x0, y0) and (x1, y1)
+// touches, (x0, y0) excluded. Through a corner both side tiles must be
+// passable, as for diagonal steps.
+static bool in_sight(const struct World *world, int x0, int y0, int x1, int y1, int maxCost)
+{
+    int ax = abs(x1 - x0);
+    int ay = abs(y1 - y0);
+    int sx = x1 > x0 ? 1 : -1;
+    int sy = y1 > y0 ? 1 : -1;
+    // which side of the segment the next tile edge is on, scaled by 2
+    int error = ax - ay;
+    int x = x0, y = y0;
+
+    for (int n = ax + ay; n > 0;)
+    {
+        if (error > 0)
+        {
+            x += sx;
+            error -= 2 * ay;
+            n--;
+        }
+        else if (error < 0)
+        {
+            y += sy;
+            error += 2 * ax;
+            n--;
+        }
+        else
+        {
+            if (!passable(world, x + sx, y, maxCost) || !passable(world, x, y + sy, maxCost))
+                return false;
+            x += sx;
+            y += sy;
+            error += 2 * (ax - ay);
+            n -= 2;
+        }
+
+        if (!passable(world, x, y, maxCost))
+            return false;
+    }
+
+    return true;
+}
+
+// Tile at index to of the path is in sight of the one at from, -1 being
+// (startX, startY), through terrain no costlier than the path in between
+static bool pulls_to(const struct PathScratch *scratch, const struct World *world, int startX, int startY, int from, int to)
+{
+    int width = world->width;
+    int x = from < 0 ? startX : scratch->path[from] % width;
+    int y = from < 0 ? startY : scratch->path[from] / width;
+    int stretch = 0;
+
+    for (int i = from + 1; i <= to; i++)
+    {
+        int cost = movement_cost(world, scratch->path[i] % width, scratch->path[i] / width);
+        if (cost > stretch)
+            stretch = cost;
+    }
+
+    return in_sight(world, x, y, scratch->path[to] % width, scratch->path[to] / width, stretch);
+}
+
+void pull_path(struct PathScratch *scratch, const struct World *world, int startX, int startY)
+{
+    int length = 0;
+
+    // from each waypoint, the furthest tile in sight becomes the next one:
+    // doubling the distance until sight is lost, then bisecting. Sight is
+    // not monotonic along a path, a missed shortcut only costs a waypoint.
+    for (int anchor = -1; anchor < scratch->length - 1;)
+    {
+        int seen = anchor + 1;
+        int lost = scratch->length;
+
+        for (int step = 1; seen + step < scratch->length; step *= 2)
+        {
+            if (!pulls_to(scratch, world, startX, startY, anchor, seen + step))
+            {
+                lost = seen + step;
+                break;
+            }
+            seen += step;
+        }
+
+        while (lost - seen > 1)
+        {
+            int middle = seen + (lost - seen) / 2;
+            if (pulls_to(scratch, world, startX, startY, anchor, middle))
+                seen = middle;
+            else
+                lost = middle;
+        }
+
+        // waypoints are written behind the tiles still to be read
+        scratch->path[length++] = scratch->path[seen];
+        anchor = seen;
+    }
+
+    scratch->length = length;
+}
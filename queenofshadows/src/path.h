@@ -0,0 +1,98 @@
+#pragma once
+
+#include "world.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// cost of one straight step into a tile with movement cost 1
+#define PATH_COST_STRAIGHT 10
+// diagonal step, 10 * sqrt(2) rounded down so estimates stay admissible
+#define PATH_COST_DIAGONAL 14
+
+enum PathHeuristic
+{
+    // |dx| + |dy|, exact on open 4 neighbour grids
+    HEURISTIC_MANHATTAN = 0,
+    // diagonal distance, admissible for 4 and 8 neighbour grids
+    HEURISTIC_OCTILE = 1,
+    // straight line distance
+    HEURISTIC_EUCLIDEAN = 2,
+    // no estimate, plain Dijkstra
+    HEURISTIC_NONE = 3,
+};
+
+enum PathMode
+{
+    // single A* from start to goal
+    PATH_ASTAR = 0,
+    // Jump Point Search, for uniform cost grids: terrain costs are ignored
+    PATH_JPS = 1,
+    // HPA* over cluster entrances, needs a Hierarchy: see search_hierarchy
+    PATH_HIERARCHICAL = 2,
+};
+
+struct PathOptions
+{
+    enum PathMode mode;
+    // manhattan is replaced by octile on diagonal searches
+    enum PathHeuristic heuristic;
+    // 8 neighbours instead of 4, diagonal steps never cut corners
+    bool diagonal;
+    // keep only the tiles where the path turns around an obstacle: see pull_path
+    bool any_angle;
+};
+
+// Per tile search state, only valid while stamp matches the search generation
+struct PathNode
+{
+    uint32_t stamp;
+    int32_t g;
+    int32_t parent;
+    // position in the open heap, -1 once closed
+    int32_t heap;
+};
+
+struct PathHeapEntry
+{
+    // f in the high half, h in the low half: ties go to the deepest node
+    uint64_t key;
+    int32_t tile;
+};
+
+// Indexed binary min heap, positions are written back into PathNode.heap
+struct PathHeap
+{
+    struct PathHeapEntry *entries;
+    int size;
+    int capacity;
+};
+
+// Search buffers reused between queries. Every query bumps the generation
+// instead of clearing the per tile state.
+struct PathScratch
+{
+    uint32_t generation;
+    // tiles the node arrays can hold
+    size_t capacity;
+    struct PathNode *nodes;
+    struct PathHeap open;
+    // result: tile indexes (y * width + x) from the first step to the goal
+    int *path;
+    int length;
+    int path_capacity;
+    // nodes expanded by the last search
+    int expanded;
+};
+
+struct PathScratch create_path_scratch();
+void destroy_path_scratch(struct PathScratch *scratch);
+
+void append_path(struct PathScratch *scratch, int tile);
+
+bool search_path(struct PathScratch *scratch, const struct World *world, const struct PathOptions *options,
+                 int startX, int startY, int endX, int endY);
+// String pulling: drops every tile the previous waypoint can see past, in a
+// straight line crossing only walkable tiles no costlier than the stretch it
+// replaces. The path becomes waypoints from the first turn to the goal.
+void pull_path(struct PathScratch *scratch, const struct World *world, int startX, int startY);
@@ -0,0 +1,437 @@
+#include "pathfinder.h"
+#include "navigation.h"
+#include "timings.h"
+#include "error.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <raykit.h>
+
+struct Request
+{
+    int unit;
+    // matches latest[unit] while the request is still wanted
+    uint32_t sequence;
+    Vector3 start;
+    Vector3 end;
+    double submitted;
+};
+
+struct Finished
+{
+    struct PathfinderResult result;
+    uint32_t sequence;
+    struct Path path;
+};
+
+struct Worker
+{
+    struct Pathfinder *pathfinder;
+    pthread_t thread;
+    struct PathContext context;
+    struct Path path;
+};
+
+struct Pathfinder
+{
+    struct World *world;
+    // shared by the workers, updated by world edits while paused
+    struct Regions *regions;
+
+    pthread_mutex_t mutex;
+    // signalled when a request is queued, on resume and on shutdown
+    pthread_cond_t wake;
+    // signalled when a search ends
+    pthread_cond_t idle;
+    bool stopping;
+    bool paused;
+    // copied into a worker context as it takes a request
+    bool any_angle;
+
+    struct Worker *workers;
+    int worker_count;
+
+    // ring buffer of pending requests
+    struct Request *queue;
+    int head;
+    int count;
+    int capacity;
+
+    // finished requests in completion order, entries keep their buffers
+    struct Finished *finished;
+    int finished_count;
+    int finished_capacity;
+
+    // latest sequence submitted per unit, 0 when cancelled
+    uint32_t *latest;
+    int unit_capacity;
+    uint32_t sequence;
+
+    struct PathfinderStats stats;
+};
+
+static struct Request *queued(struct Pathfinder *pathfinder, int i)
+{
+    return &pathfinder->queue[(pathfinder->head + i) % pathfinder->capacity];
+}
+
+static void push_queue(struct Pathfinder *pathfinder, const struct Request *request)
+{
+    if (pathfinder->count == pathfinder->capacity)
+    {
+        int capacity = pathfinder->capacity ? pathfinder->capacity * 2 : 64;
+        struct Request *queue = malloc((size_t)capacity * sizeof(*queue));
+        if (queue == NULL)
+            die("Failure to allocate path requests");
+
+        // unwrap the ring into the new buffer
+        for (int i = 0; i < pathfinder->count; i++)
+            queue[i] = *queued(pathfinder, i);
+
+        free(pathfinder->queue);
+        pathfinder->queue = queue;
+        pathfinder->head = 0;
+        pathfinder->capacity = capacity;
+    }
+
+    *queued(pathfinder, pathfinder->count++) = *request;
+
+    if (pathfinder->count > pathfinder->stats.peak_depth)
+        pathfinder->stats.peak_depth = pathfinder->count;
+}
+
+static void finish(struct Pathfinder *pathfinder, const struct Request *request, bool found, const struct Path *path)
+{
+    if (pathfinder->finished_count == pathfinder->finished_capacity)
+    {
+        int capacity = pathfinder->finished_capacity ? pathfinder->finished_capacity * 2 : 16;
+        struct Finished *finished = realloc(pathfinder->finished, (size_t)capacity * sizeof(*finished));
+        if (finished == NULL)
+            die("Failure to allocate path results");
+
+        for (int i = pathfinder->finished_capacity; i < capacity; i++)
+            finished[i].path = create_path();
+
+        pathfinder->finished = finished;
+        pathfinder->finished_capacity = capacity;
+    }
+
+    struct Finished *entry = &pathfinder->finished[pathfinder->finished_count++];
+    double latency = now_timings() - request->submitted;
+
+    entry->sequence = request->sequence;
+    entry->result = (struct PathfinderResult){
+        .unit = request->unit,
+        .found = found,
+        .end = request->end,
+        .latency = latency,
+    };
+
+    entry->path.length = 0;
+    if (found)
+    {
+        if (path->length > entry->path.capacity)
+        {
+            Vector3 *nodes = realloc(entry->path.nodes, (size_t)path->length * sizeof(*nodes));
+            if (nodes == NULL)
+                die("Failure to allocate path nodes");
+            entry->path.nodes = nodes;
+            entry->path.capacity = path->length;
+        }
+
+        for (int i = 0; i < path->length; i++)
+            entry->path.nodes[i] = path->nodes[i];
+        entry->path.length = path->length;
+    }
+
+    pathfinder->stats.completed++;
+    pathfinder->stats.latency_total += latency;
+    if (latency > pathfinder->stats.latency_max)
+        pathfinder->stats.latency_max = latency;
+}
+
+static void *work(void *argument)
+{
+    struct Worker *worker = argument;
+    struct Pathfinder *pathfinder = worker->pathfinder;
+
+    pthread_mutex_lock(&pathfinder->mutex);
+
+    for (;;)
+    {
+        while (!pathfinder->stopping && (pathfinder->paused || pathfinder->count == 0))
+            pthread_cond_wait(&pathfinder->wake, &pathfinder->mutex);
+        if (pathfinder->stopping)
+            break;
+
+        struct Request request = *queued(pathfinder, 0);
+        pathfinder->head = (pathfinder->head + 1) % pathfinder->capacity;
+        pathfinder->count--;
+        pathfinder->stats.searching++;
+        worker->context.any_angle = pathfinder->any_angle;
+
+        double wait = now_timings() - request.submitted;
+        pathfinder->stats.wait_total += wait;
+        if (wait > pathfinder->stats.wait_max)
+            pathfinder->stats.wait_max = wait;
+
+        pthread_mutex_unlock(&pathfinder->mutex);
+
+        worker->path.length = 0;
+        PROFILE_BEGIN("find_path");
+        bool found = find_path(&worker->context, pathfinder->world, request.start, request.end, &worker->path);
+        PROFILE_END();
+
+        pthread_mutex_lock(&pathfinder->mutex);
+
+        pathfinder->stats.searching--;
+        if (pathfinder->latest[request.unit] == request.sequence)
+            finish(pathfinder, &request, found, &worker->path);
+        else
+            pathfinder->stats.discarded++;
+
+        pthread_cond_broadcast(&pathfinder->idle);
+    }
+
+    pthread_mutex_unlock(&pathfinder->mutex);
+
+    return NULL;
+}
+
+struct Pathfinder *create_pathfinder(struct World *world, int workers)
+{
+    if (workers < 1)
+        die("Pathfinder needs at least one worker");
+
+    struct Pathfinder *pathfinder = calloc(1, sizeof(*pathfinder));
+    if (pathfinder == NULL)
+        die("Failure to allocate pathfinder");
+
+    pathfinder->world = world;
+    pathfinder->worker_count = workers;
+    pathfinder->workers = calloc((size_t)workers, sizeof(*pathfinder->workers));
+    if (pathfinder->workers == NULL)
+        die("Failure to allocate pathfinder workers");
+
+    pthread_mutex_init(&pathfinder->mutex, NULL);
+    pthread_cond_init(&pathfinder->wake, NULL);
+    pthread_cond_init(&pathfinder->idle, NULL);
+
+    pathfinder->regions = create_regions(world);
+
+    for (int i = 0; i < workers; i++)
+    {
+        struct Worker *worker = &pathfinder->workers[i];
+
+        worker->pathfinder = pathfinder;
+        worker->context = create_path_context(NULL);
+        worker->context.regions = pathfinder->regions;
+        worker->path = create_path();
+
+        if (pthread_create(&worker->thread, NULL, work, worker) != 0)
+            die("Failure to start pathfinder worker");
+    }
+
+    return pathfinder;
+}
+
+void destroy_pathfinder(struct Pathfinder *pathfinder)
+{
+    if (pathfinder == NULL)
+        return;
+
+    pthread_mutex_lock(&pathfinder->mutex);
+    pathfinder->stopping = true;
+    pthread_cond_broadcast(&pathfinder->wake);
+    pthread_mutex_unlock(&pathfinder->mutex);
+
+    for (int i = 0; i < pathfinder->worker_count; i++)
+    {
+        pthread_join(pathfinder->workers[i].thread, NULL);
+        destroy_path_context(&pathfinder->workers[i].context);
+        destroy_path(&pathfinder->workers[i].path);
+    }
+
+    for (int i = 0; i < pathfinder->finished_capacity; i++)
+        destroy_path(&pathfinder->finished[i].path);
+
+    destroy_regions(pathfinder->regions);
+
+    pthread_cond_destroy(&pathfinder->idle);
+    pthread_cond_destroy(&pathfinder->wake);
+    pthread_mutex_destroy(&pathfinder->mutex);
+
+    free(pathfinder->workers);
+    free(pathfinder->queue);
+    free(pathfinder->finished);
+    free(pathfinder->latest);
+    free(pathfinder);
+}
+
+void straighten_pathfinder(struct Pathfinder *pathfinder, bool any_angle)
+{
+    pthread_mutex_lock(&pathfinder->mutex);
+    pathfinder->any_angle = any_angle;
+    pthread_mutex_unlock(&pathfinder->mutex);
+}
+
+void submit_pathfinder(struct Pathfinder *pathfinder, int unit, const Vector3 start, const Vector3 end)
+{
+    if (unit < 0)
+        die("Path request unit must not be negative");
+
+    pthread_mutex_lock(&pathfinder->mutex);
+
+    if (unit >= pathfinder->unit_capacity)
+    {
+        int capacity = pathfinder->unit_capacity ? pathfinder->unit_capacity : 16;
+        while (capacity <= unit)
+            capacity *= 2;
+
+        uint32_t *latest = realloc(pathfinder->latest, (size_t)capacity * sizeof(*latest));
+        if (latest == NULL)
+            die("Failure to allocate pathfinder units");
+        for (int i = pathfinder->unit_capacity; i < capacity; i++)
+            latest[i] = 0;
+
+        pathfinder->latest = latest;
+        pathfinder->unit_capacity = capacity;
+    }
+
+    // 0 marks a cancelled unit
+    if (++pathfinder->sequence == 0)
+        pathfinder->sequence = 1;
+
+    struct Request request = {
+        .unit = unit,
+        .sequence = pathfinder->sequence,
+        .start = start,
+        .end = end,
+        .submitted = now_timings(),
+    };
+
+    pathfinder->latest[unit] = request.sequence;
+    pathfinder->stats.submitted++;
+
+    // still queued: take its place instead of queueing a second search
+    bool coalesced = false;
+    for (int i = 0; i < pathfinder->count && !coalesced; i++)
+    {
+        struct Request *pending = queued(pathfinder, i);
+        if (pending->unit == unit)
+        {
+            *pending = request;
+            coalesced = true;
+        }
+    }
+
+    if (coalesced)
+        pathfinder->stats.coalesced++;
+    else
+    {
+        push_queue(pathfinder, &request);
+        pthread_cond_signal(&pathfinder->wake);
+    }
+
+    pthread_mutex_unlock(&pathfinder->mutex);
+}
+
+void cancel_pathfinder(struct Pathfinder *pathfinder, int unit)
+{
+    pthread_mutex_lock(&pathfinder->mutex);
+
+    if (unit >= 0 && unit < pathfinder->unit_capacity && pathfinder->latest[unit] != 0)
+    {
+        pathfinder->latest[unit] = 0;
+        pathfinder->stats.cancelled++;
+
+        // drop it from the queue, keeping the order of the others
+        int kept = 0;
+        for (int i = 0; i < pathfinder->count; i++)
+            if (queued(pathfinder, i)->unit != unit)
+                *queued(pathfinder, kept++) = *queued(pathfinder, i);
+        pathfinder->count = kept;
+    }
+
+    pthread_mutex_unlock(&pathfinder->mutex);
+}
+
+bool collect_pathfinder(struct Pathfinder *pathfinder, struct PathfinderResult *result, struct Path *path)
+{
+    bool collected = false;
+
+    pthread_mutex_lock(&pathfinder->mutex);
+
+    // skip results superseded after they finished
+    int i = 0;
+    while (i < pathfinder->finished_count &&
+           pathfinder->latest[pathfinder->finished[i].result.unit] != pathfinder->finished[i].sequence)
+        i++;
+
+    if (i < pathfinder->finished_count)
+    {
+        struct Finished *entry = &pathfinder->finished[i];
+
+        *result = entry->result;
+        if (result->found)
+        {
+            // the caller gets the nodes, the entry keeps the old buffer
+            struct Path swapped = *path;
+            *path = entry->path;
+            entry->path = swapped;
+        }
+
+        pathfinder->latest[result->unit] = 0;
+        collected = true;
+        i++;
+    }
+
+    // remove the entries consumed, rotating their buffers to the back
+    for (int j = 0; j < i; j++)
+    {
+        struct Finished first = pathfinder->finished[0];
+        for (int k = 1; k < pathfinder->finished_count; k++)
+            pathfinder->finished[k - 1] = pathfinder->finished[k];
+        pathfinder->finished[--pathfinder->finished_count] = first;
+    }
+
+    pthread_mutex_unlock(&pathfinder->mutex);
+
+    return collected;
+}
+
+void wait_pathfinder(struct Pathfinder *pathfinder)
+{
+    pthread_mutex_lock(&pathfinder->mutex);
+    while ((pathfinder->count > 0 && !pathfinder->paused) || pathfinder->stats.searching > 0)
+        pthread_cond_wait(&pathfinder->idle, &pathfinder->mutex);
+    pthread_mutex_unlock(&pathfinder->mutex);
+}
+
+void pause_pathfinder(struct Pathfinder *pathfinder)
+{
+    pthread_mutex_lock(&pathfinder->mutex);
+    pathfinder->paused = true;
+    while (pathfinder->stats.searching > 0)
+        pthread_cond_wait(&pathfinder->idle, &pathfinder->mutex);
+    pthread_mutex_unlock(&pathfinder->mutex);
+}
+
+void resume_pathfinder(struct Pathfinder *pathfinder)
+{
+    pthread_mutex_lock(&pathfinder->mutex);
+    pathfinder->paused = false;
+    pthread_cond_broadcast(&pathfinder->wake);
+    pthread_mutex_unlock(&pathfinder->mutex);
+}
+
+struct PathfinderStats stats_pathfinder(struct Pathfinder *pathfinder)
+{
+    pthread_mutex_lock(&pathfinder->mutex);
+    struct PathfinderStats stats = pathfinder->stats;
+    stats.depth = pathfinder->count;
+    pthread_mutex_unlock(&pathfinder->mutex);
+
+    return stats;
+}
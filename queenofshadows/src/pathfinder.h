@@ -0,0 +1,68 @@
+#pragma once
+
+#include "hero.h"
+#include "world.h"
+
+#include <raylib.h>
+
+// Asynchronous path requests served by a pool of worker threads. The main
+// loop submits requests per unit and collects finished paths each frame.
+// A new request for a unit supersedes its previous one, queued or running.
+//
+// Workers read the world while searching: edit it only between
+// pause_pathfinder and resume_pathfinder.
+struct Pathfinder;
+
+struct PathfinderResult
+{
+    int unit;
+    bool found;
+    // goal as submitted, the path ends on the nearest reachable tile when
+    // the goal cannot be reached
+    Vector3 end;
+    // seconds from submit to the path being ready
+    double latency;
+};
+
+struct PathfinderStats
+{
+    // requests waiting for a worker, and the most seen at once
+    int depth;
+    int peak_depth;
+    // searches running now
+    int searching;
+    long submitted;
+    long completed;
+    // requests merged into a pending one of the same unit
+    long coalesced;
+    long cancelled;
+    // searches finished after being superseded or cancelled
+    long discarded;
+    // seconds waiting in the queue, summed over started searches, and from
+    // submit to ready, summed over completed ones
+    double wait_total;
+    double wait_max;
+    double latency_total;
+    double latency_max;
+};
+
+struct Pathfinder *create_pathfinder(struct World *world, int workers);
+void destroy_pathfinder(struct Pathfinder *pathfinder);
+
+// String pull the paths of requests started from now on: see pull_path
+void straighten_pathfinder(struct Pathfinder *pathfinder, bool any_angle);
+
+// unit is any non negative id chosen by the caller
+void submit_pathfinder(struct Pathfinder *pathfinder, int unit, const Vector3 start, const Vector3 end);
+void cancel_pathfinder(struct Pathfinder *pathfinder, int unit);
+
+// Oldest finished request: swaps its nodes into path, false when none is ready
+bool collect_pathfinder(struct Pathfinder *pathfinder, struct PathfinderResult *result, struct Path *path);
+
+// Blocks until the queue is empty and no search is running
+void wait_pathfinder(struct Pathfinder *pathfinder);
+// Blocks until running searches end and keeps workers idle until resumed
+void pause_pathfinder(struct Pathfinder *pathfinder);
+void resume_pathfinder(struct Pathfinder *pathfinder);
+
+struct PathfinderStats stats_pathfinder(struct Pathfinder *pathfinder);
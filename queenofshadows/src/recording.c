@@ -0,0 +1,191 @@
+#include "recording.h"
+#include "error.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char magic[4] = {'Q', 'O', 'S', 'R'};
+
+// Frame flags
+#define FRAME_CLICK 0x01
+#define FRAME_RUNNING 0x02
+#define FRAME_ROTATE_CLOCKWISE 0x04
+#define FRAME_ROTATE_COUNTER_CLOCKWISE 0x08
+#define FRAME_ZOOM_IN 0x10
+#define FRAME_ZOOM_OUT 0x20
+#define FRAME_PATHS 0x40
+
+static bool put_u8(FILE *file, uint8_t value)
+{
+    return fputc(value, file) != EOF;
+}
+
+static bool put_u32(FILE *file, uint32_t value)
+{
+    uint8_t bytes[4] = {value, value >> 8, value >> 16, value >> 24};
+    return fwrite(bytes, sizeof(bytes), 1, file) == 1;
+}
+
+static bool put_f32(FILE *file, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put_u32(file, bits);
+}
+
+static bool get_u8(FILE *file, uint8_t *value)
+{
+    int c = fgetc(file);
+    *value = (uint8_t)c;
+    return c != EOF;
+}
+
+static bool get_u32(FILE *file, uint32_t *value)
+{
+    uint8_t bytes[4];
+    if (fread(bytes, sizeof(bytes), 1, file) != 1)
+        return false;
+
+    *value = bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    return true;
+}
+
+static bool get_f32(FILE *file, float *value)
+{
+    uint32_t bits;
+    if (!get_u32(file, &bits))
+        return false;
+
+    memcpy(value, &bits, sizeof(*value));
+    return true;
+}
+
+struct Recorder *create_recorder(const char *path, const struct RecordingHeader *header)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return NULL;
+
+    struct Recorder *recorder = calloc(1, sizeof(*recorder));
+    if (recorder == NULL)
+        die("Failure to allocate recorder");
+
+    recorder->file = file;
+    recorder->header = *header;
+
+    fwrite(magic, sizeof(magic), 1, file);
+    put_u8(file, RECORDING_VERSION);
+    put_u32(file, (uint32_t)header->tick_rate);
+    put_u32(file, (uint32_t)header->world_width);
+    put_u32(file, (uint32_t)header->world_height);
+    put_u32(file, header->seed);
+    put_u8(file, header->any_angle_paths);
+
+    return recorder;
+}
+
+bool destroy_recorder(struct Recorder *recorder)
+{
+    if (recorder == NULL)
+        return true;
+
+    // stdio keeps the first error, fclose reports the last flush
+    bool written = !ferror(recorder->file);
+    written = fclose(recorder->file) == 0 && written;
+    free(recorder);
+
+    return written;
+}
+
+bool record_recorder(struct Recorder *recorder, const struct Input *input, int paths, float seconds)
+{
+    FILE *file = recorder->file;
+    uint8_t flags = (input->click ? FRAME_CLICK : 0) | (input->running ? FRAME_RUNNING : 0) |
+                    (input->rotate_clockwise ? FRAME_ROTATE_CLOCKWISE : 0) |
+                    (input->rotate_counter_clockwise ? FRAME_ROTATE_COUNTER_CLOCKWISE : 0) |
+                    (input->zoom_in ? FRAME_ZOOM_IN : 0) | (input->zoom_out ? FRAME_ZOOM_OUT : 0) |
+                    (paths > 0 ? FRAME_PATHS : 0);
+
+    bool written = put_u8(file, flags) && put_f32(file, seconds);
+    if (paths > 0)
+        written = written && put_u8(file, paths > UINT8_MAX ? UINT8_MAX : (uint8_t)paths);
+    if (input->click)
+        written = written && put_f32(file, input->target.x) && put_f32(file, input->target.y) &&
+                  put_f32(file, input->target.z);
+
+    recorder->frames++;
+    return written;
+}
+
+struct Replayer *create_replayer(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+
+    char read[sizeof(magic)];
+    uint8_t version, any_angle;
+    uint32_t tick_rate, width, height, seed;
+
+    if (fread(read, sizeof(read), 1, file) != 1 || memcmp(read, magic, sizeof(magic)) != 0 ||
+        !get_u8(file, &version) || version != RECORDING_VERSION || !get_u32(file, &tick_rate) ||
+        !get_u32(file, &width) || !get_u32(file, &height) || !get_u32(file, &seed) || !get_u8(file, &any_angle))
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    struct Replayer *replayer = calloc(1, sizeof(*replayer));
+    if (replayer == NULL)
+        die("Failure to allocate replayer");
+
+    replayer->file = file;
+    replayer->header = (struct RecordingHeader){
+        .tick_rate = (int)tick_rate,
+        .world_width = (int)width,
+        .world_height = (int)height,
+        .seed = seed,
+        .any_angle_paths = any_angle != 0,
+    };
+
+    return replayer;
+}
+
+void destroy_replayer(struct Replayer *replayer)
+{
+    if (replayer == NULL)
+        return;
+
+    fclose(replayer->file);
+    free(replayer);
+}
+
+bool replay_replayer(struct Replayer *replayer, struct Input *input, float *seconds)
+{
+    FILE *file = replayer->file;
+    uint8_t flags, paths = 0;
+
+    // a frame cut short by a crash ends the replay like the end of the file
+    if (!get_u8(file, &flags) || !get_f32(file, seconds))
+        return false;
+    if ((flags & FRAME_PATHS) && !get_u8(file, &paths))
+        return false;
+
+    *input = (struct Input){
+        .click = flags & FRAME_CLICK,
+        .running = flags & FRAME_RUNNING,
+        .rotate_clockwise = flags & FRAME_ROTATE_CLOCKWISE,
+        .rotate_counter_clockwise = flags & FRAME_ROTATE_COUNTER_CLOCKWISE,
+        .zoom_in = flags & FRAME_ZOOM_IN,
+        .zoom_out = flags & FRAME_ZOOM_OUT,
+        .replayed = true,
+        .paths = paths,
+    };
+
+    if (input->click && (!get_f32(file, &input->target.x) || !get_f32(file, &input->target.y) ||
+                         !get_f32(file, &input->target.z)))
+        return false;
+
+    replayer->frames++;
+    return true;
+}
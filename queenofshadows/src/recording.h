@@ -0,0 +1,54 @@
+#pragma once
+
+#include "simulation.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define RECORDING_VERSION 1
+
+// What a replay needs to run on the same simulation as the recording
+struct RecordingHeader
+{
+    int tick_rate;
+    int world_width;
+    int world_height;
+    // seed of a generated world, 0 for the game world as world_init makes it
+    uint32_t seed;
+    bool any_angle_paths;
+};
+
+// Input of every frame written as it happens, with the frame length and the
+// paths the frame collected: replayed in order, the simulation goes through
+// the same steps and gets its paths on the same frames.
+//
+// File: "QOSR", version, then the header fields, then one record per frame:
+// a flags byte, the frame length as a float, the paths collected when the
+// flag says any, and the clicked ground point when the frame has a click.
+// Numbers are little endian, most frames take 5 bytes.
+struct Recorder
+{
+    FILE *file;
+    struct RecordingHeader header;
+    long frames;
+};
+
+struct Replayer
+{
+    FILE *file;
+    struct RecordingHeader header;
+    long frames;
+};
+
+// NULL when the file cannot be created
+struct Recorder *create_recorder(const char *path, const struct RecordingHeader *header);
+// Flushes and closes the file, false when a write failed
+bool destroy_recorder(struct Recorder *recorder);
+// paths is what the frame collected, see Simulation.collected
+bool record_recorder(struct Recorder *recorder, const struct Input *input, int paths, float seconds);
+
+// NULL when the file cannot be read or is not a recording of this version
+struct Replayer *create_replayer(const char *path);
+void destroy_replayer(struct Replayer *replayer);
+// Next frame as recorded, marked replayed; false at the end of the recording
+bool replay_replayer(struct Replayer *replayer, struct Input *input, float *seconds);
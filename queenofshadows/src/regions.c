@@ -0,0 +1,391 @@
+#include "regions.h"
+#include "error.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Directions: up, down, left, right
+static const int dx[] = {0, 0, -1, 1};
+static const int dy[] = {-1, 1, 0, 0};
+
+static void push_flood(struct Regions *regions, int flood, int size, int32_t tile)
+{
+    if (size == regions->flood_capacity[flood])
+    {
+        int capacity = size ? size * 2 : 1024;
+        int32_t *grown = realloc(regions->floods[flood], (size_t)capacity * sizeof(*grown));
+        if (grown == NULL)
+            die("Failure to allocate region flood");
+        regions->floods[flood] = grown;
+        regions->flood_capacity[flood] = capacity;
+    }
+
+    regions->floods[flood][size] = tile;
+}
+
+static int32_t new_label(struct Regions *regions)
+{
+    if (regions->free_count > 0)
+        return regions->free[--regions->free_count];
+
+    if (regions->next_label == regions->label_capacity)
+    {
+        int capacity = regions->label_capacity * 2;
+        int32_t *sizes = realloc(regions->sizes, (size_t)capacity * sizeof(*sizes));
+        int32_t *free_labels = realloc(regions->free, (size_t)capacity * sizeof(*free_labels));
+        if (sizes == NULL || free_labels == NULL)
+            die("Failure to allocate region labels");
+
+        regions->sizes = sizes;
+        regions->free = free_labels;
+        regions->label_capacity = capacity;
+    }
+
+    regions->sizes[regions->next_label] = 0;
+    return regions->next_label++;
+}
+
+static void release_label(struct Regions *regions, int32_t label)
+{
+    regions->sizes[label] = 0;
+    regions->free[regions->free_count++] = label;
+}
+
+// Relabels the region of tile from (labelled from_label) to label, returns its size
+static int32_t fill(struct Regions *regions, int32_t from, int32_t from_label, int32_t label)
+{
+    const struct World *world = regions->world;
+    int width = world->width;
+    int size = 0;
+
+    regions->labels[from] = label;
+    push_flood(regions, 0, size++, from);
+
+    for (int head = 0; head < size; head++)
+    {
+        int32_t tile = regions->floods[0][head];
+        int x = tile % width;
+        int y = tile / width;
+
+        for (int k = 0; k < 4; k++)
+        {
+            int nx = x + dx[k];
+            int ny = y + dy[k];
+            if ((unsigned)nx >= (unsigned)width || (unsigned)ny >= (unsigned)world->height)
+                continue;
+
+            int32_t next = ny * width + nx;
+            if (regions->labels[next] != from_label || !is_walkable(world, nx, ny))
+                continue;
+
+            regions->labels[next] = label;
+            push_flood(regions, 0, size++, next);
+        }
+    }
+
+    return size;
+}
+
+// Tile (x, y) became walkable: joins the regions around it into the largest
+static void join(struct Regions *regions, int x, int y)
+{
+    int width = regions->world->width;
+    int32_t tile = y * width + x;
+    int32_t around[4];
+    int32_t keeper = 0;
+
+    for (int k = 0; k < 4; k++)
+    {
+        around[k] = label_regions(regions, x + dx[k], y + dy[k]);
+        if (around[k] != 0 && (keeper == 0 || regions->sizes[around[k]] > regions->sizes[keeper]))
+            keeper = around[k];
+    }
+
+    if (keeper == 0)
+        keeper = new_label(regions);
+
+    regions->labels[tile] = keeper;
+    regions->sizes[keeper]++;
+
+    for (int k = 0; k < 4; k++)
+    {
+        int32_t label = around[k];
+        if (label == 0 || label == keeper || regions->sizes[label] == 0)
+            continue;
+
+        int32_t size = fill(regions, (y + dy[k]) * width + x + dx[k], label, keeper);
+        regions->sizes[keeper] += size;
+        regions->relabelled += size;
+        release_label(regions, label);
+    }
+}
+
+static int root(int *group, int flood)
+{
+    while (group[flood] != flood)
+        flood = group[flood];
+
+    return flood;
+}
+
+// Tile (x, y) was blocked: its neighbours may now be apart. One flood per
+// neighbour advances a tile at a time, floods meeting are merged, and a
+// group of floods running out of tiles while others are still open is a
+// region on its own. The work stays proportional to the smaller side.
+static void split(struct Regions *regions, int x, int y)
+{
+    const struct World *world = regions->world;
+    int width = world->width;
+    int32_t tile = y * width + x;
+    int32_t label = regions->labels[tile];
+    int count = 0;
+    int size[REGIONS_FLOODS], head[REGIONS_FLOODS], group[REGIONS_FLOODS];
+    bool retired[REGIONS_FLOODS];
+
+    regions->labels[tile] = 0;
+    regions->sizes[label]--;
+
+    if (++regions->generation >= UINT32_MAX / REGIONS_FLOODS)
+    {
+        memset(regions->stamps, 0, (size_t)width * world->height * sizeof(*regions->stamps));
+        regions->generation = 1;
+    }
+    uint32_t base = regions->generation * REGIONS_FLOODS;
+
+    for (int k = 0; k < 4; k++)
+    {
+        if (label_regions(regions, x + dx[k], y + dy[k]) == 0)
+            continue;
+
+        int32_t start = (y + dy[k]) * width + x + dx[k];
+        push_flood(regions, count, 0, start);
+        regions->stamps[start] = base + (uint32_t)count;
+        size[count] = 1;
+        head[count] = 0;
+        group[count] = count;
+        retired[count] = false;
+        count++;
+    }
+
+    if (count == 0)
+        release_label(regions, label);
+    if (count < 2)
+        return;
+
+    for (;;)
+    {
+        // groups still in the race, and whether each still has tiles to expand
+        int open = 0;
+        for (int i = 0; i < count; i++)
+            if (!retired[i] && root(group, i) == i)
+                open++;
+        if (open < 2)
+            return;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (retired[i] || root(group, i) != i)
+                continue;
+
+            bool exhausted = true;
+            for (int j = 0; j < count; j++)
+                if (root(group, j) == i && head[j] < size[j])
+                    exhausted = false;
+            if (!exhausted)
+                continue;
+
+            // closed off from the others: a region of its own
+            int32_t split_label = new_label(regions);
+            for (int j = 0; j < count; j++)
+            {
+                if (root(group, j) != i)
+                    continue;
+
+                for (int k = 0; k < size[j]; k++)
+                    regions->labels[regions->floods[j][k]] = split_label;
+                regions->sizes[split_label] += size[j];
+                regions->sizes[label] -= size[j];
+                regions->relabelled += size[j];
+                retired[j] = true;
+            }
+            open--;
+        }
+        if (open < 2)
+            return;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (retired[i] || head[i] == size[i])
+                continue;
+
+            int32_t current = regions->floods[i][head[i]++];
+            int cx = current % width;
+            int cy = current / width;
+
+            for (int k = 0; k < 4; k++)
+            {
+                int nx = cx + dx[k];
+                int ny = cy + dy[k];
+                if (label_regions(regions, nx, ny) != label)
+                    continue;
+
+                int32_t next = ny * width + nx;
+                if (regions->stamps[next] >= base && regions->stamps[next] < base + REGIONS_FLOODS)
+                {
+                    // met another flood: same side of the cut
+                    int a = root(group, i);
+                    int b = root(group, (int)(regions->stamps[next] - base));
+                    if (a != b)
+                        group[a > b ? a : b] = a < b ? a : b;
+                    continue;
+                }
+
+                regions->stamps[next] = base + (uint32_t)i;
+                push_flood(regions, i, size[i]++, next);
+            }
+        }
+    }
+}
+
+// World listener: terrain edits leave the regions alone
+static void edited_regions(void *context, int x, int y)
+{
+    struct Regions *regions = context;
+    bool walkable = is_walkable(regions->world, x, y);
+
+    if (walkable == (regions->labels[y * regions->world->width + x] != 0))
+        return;
+
+    if (walkable)
+        join(regions, x, y);
+    else
+        split(regions, x, y);
+}
+
+struct Regions *create_regions(struct World *world)
+{
+    size_t tiles = (size_t)world->width * world->height;
+    struct Regions *regions = calloc(1, sizeof(*regions));
+    if (regions == NULL)
+        die("Failure to allocate regions");
+
+    regions->world = world;
+    regions->label_capacity = 64;
+    regions->next_label = 1;
+    regions->generation = 0;
+    regions->labels = calloc(tiles, sizeof(*regions->labels));
+    regions->stamps = calloc(tiles, sizeof(*regions->stamps));
+    regions->sizes = calloc((size_t)regions->label_capacity, sizeof(*regions->sizes));
+    regions->free = malloc((size_t)regions->label_capacity * sizeof(*regions->free));
+    if (regions->labels == NULL || regions->stamps == NULL || regions->sizes == NULL || regions->free == NULL)
+        die("Failure to allocate regions");
+
+    for (int y = 0; y < world->height; y++)
+    {
+        for (int x = 0; x < world->width; x++)
+        {
+            int32_t tile = y * world->width + x;
+            if (regions->labels[tile] != 0 || !is_walkable(world, x, y))
+                continue;
+
+            int32_t label = new_label(regions);
+            regions->sizes[label] = fill(regions, tile, 0, label);
+        }
+    }
+
+    if (!listen_world(world, edited_regions, regions))
+        die("Too many world listeners");
+
+    return regions;
+}
+
+void destroy_regions(struct Regions *regions)
+{
+    if (regions == NULL)
+        return;
+
+    unlisten_world(regions->world, regions);
+
+    for (int i = 0; i < REGIONS_FLOODS; i++)
+        free(regions->floods[i]);
+
+    free(regions->labels);
+    free(regions->sizes);
+    free(regions->free);
+    free(regions->stamps);
+    free(regions);
+}
+
+int32_t label_regions(const struct Regions *regions, int x, int y)
+{
+    if ((unsigned)x >= (unsigned)regions->world->width || (unsigned)y >= (unsigned)regions->world->height)
+        return 0;
+
+    return regions->labels[y * regions->world->width + x];
+}
+
+bool connected_regions(const struct Regions *regions, int fromX, int fromY, int toX, int toY)
+{
+    int32_t label = label_regions(regions, fromX, fromY);
+
+    return label != 0 && label == label_regions(regions, toX, toY);
+}
+
+bool nearest_regions(const struct Regions *regions, int fromX, int fromY, int *x, int *y)
+{
+    int32_t label = label_regions(regions, fromX, fromY);
+    if (label == 0)
+        return false;
+    if (label_regions(regions, *x, *y) == label)
+        return true;
+
+    const struct World *world = regions->world;
+    int goalX = *x, goalY = *y;
+
+    // the target may lie off the world: rings only visit the tiles inside,
+    // from the first that reaches the world to the farthest corner
+    int farX = goalX > world->width - 1 - goalX ? goalX : world->width - 1 - goalX;
+    int farY = goalY > world->height - 1 - goalY ? goalY : world->height - 1 - goalY;
+    int last = farX + farY;
+    int outX = goalX < 0 ? -goalX : goalX >= world->width ? goalX - world->width + 1 : 0;
+    int outY = goalY < 0 ? -goalY : goalY >= world->height ? goalY - world->height + 1 : 0;
+
+    // rings of growing grid distance around the target, the closest in a
+    // straight line wins inside a ring; (fromX, fromY) bounds the search
+    for (int d = outX + outY > 1 ? outX + outY : 1; d <= last; d++)
+    {
+        int best = -1;
+        int bestX = 0, bestY = 0;
+        int minX = -goalX > -d ? -goalX : -d;
+        int maxX = world->width - 1 - goalX < d ? world->width - 1 - goalX : d;
+
+        for (int ox = minX; ox <= maxX; ox++)
+        {
+            int oy = d - abs(ox);
+
+            for (int side = 0; side < (oy ? 2 : 1); side++)
+            {
+                int tx = goalX + ox;
+                int ty = goalY + (side ? -oy : oy);
+
+                if (ty < 0 || ty >= world->height || label_regions(regions, tx, ty) != label)
+                    continue;
+                if (best < 0 || ox * ox + oy * oy < best)
+                {
+                    best = ox * ox + oy * oy;
+                    bestX = tx;
+                    bestY = ty;
+                }
+            }
+        }
+
+        if (best >= 0)
+        {
+            *x = bestX;
+            *y = bestY;
+            return true;
+        }
+    }
+
+    return false;
+}
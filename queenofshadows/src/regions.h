@@ -0,0 +1,43 @@
+#pragma once
+
+#include "world.h"
+
+#include <stdint.h>
+
+// flood fills racing to tell whether a blocked tile split its region
+#define REGIONS_FLOODS 4
+
+// Connected walkable regions (4 neighbours) of a world, kept up to date
+// through world edits: two tiles with different labels can never reach
+// each other, which rejects unreachable goals without a search
+struct Regions
+{
+    struct World *world;
+    // region label per tile, 0 when blocked
+    int32_t *labels;
+    // tiles per label, indexed by label
+    int32_t *sizes;
+    int label_capacity;
+    // labels of emptied regions, reused before new ones
+    int32_t *free;
+    int free_count;
+    int32_t next_label;
+
+    // flood fill scratch: tiles visited by each flood, and who visited them
+    int32_t *floods[REGIONS_FLOODS];
+    int flood_capacity[REGIONS_FLOODS];
+    uint32_t *stamps;
+    uint32_t generation;
+
+    // tiles relabelled by edits since creation
+    long relabelled;
+};
+
+struct Regions *create_regions(struct World *world);
+void destroy_regions(struct Regions *regions);
+
+int32_t label_regions(const struct Regions *regions, int x, int y);
+bool connected_regions(const struct Regions *regions, int fromX, int fromY, int toX, int toY);
+// Walkable tile reachable from (fromX, fromY) closest to (*x, *y), in tiles
+// along the grid, written back to x and y. False when (fromX, fromY) is blocked.
+bool nearest_regions(const struct Regions *regions, int fromX, int fromY, int *x, int *y);
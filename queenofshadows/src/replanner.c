@@ -0,0 +1,455 @@
+#include "replanner.h"
+#include "error.h"
+
+#include <stdlib.h>
+
+#define INFINITE INT32_MAX
+// node table slots of a new path
+#define REPLANNER_NODES 1024
+
+// Directions: up, down, left, right
+static const int dx[] = {0, 0, -1, 1};
+static const int dy[] = {-1, 1, 0, 0};
+
+// Tiles the search never reached: no cost known, not queued
+static const struct ReplanNode unreached = {-1, INFINITE, INFINITE, -1};
+
+// Slot of tile in the node table, or of the empty slot where it would go
+static int slot(const struct ReplanPath *path, int tile)
+{
+    int mask = path->node_capacity - 1;
+    // runs of 16 tiles along a row stay together for the neighbour lookups,
+    // Fibonacci hashing spreads the runs
+    uint64_t run = ((uint64_t)((uint32_t)tile >> 4) * 0x9E3779B97F4A7C15u) >> (68 - __builtin_ctz((unsigned)path->node_capacity));
+    int i = (int)((run << 4) | ((uint32_t)tile & 15));
+
+    while (path->nodes[i].tile != tile && path->nodes[i].tile != -1)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+static const struct ReplanNode *peek(const struct ReplanPath *path, int tile)
+{
+    const struct ReplanNode *node = &path->nodes[slot(path, tile)];
+
+    return node->tile == tile ? node : &unreached;
+}
+
+static void grow_nodes(struct ReplanPath *path, int capacity)
+{
+    struct ReplanNode *old = path->nodes;
+    int old_capacity = path->node_capacity;
+
+    path->nodes = malloc((size_t)capacity * sizeof(*path->nodes));
+    if (path->nodes == NULL)
+        die("Failure to allocate replanner nodes");
+    path->node_capacity = capacity;
+
+    for (int i = 0; i < capacity; i++)
+        path->nodes[i].tile = -1;
+
+    for (int i = 0; i < old_capacity; i++)
+    {
+        if (old[i].tile == -1)
+            continue;
+
+        int moved = slot(path, old[i].tile);
+        path->nodes[moved] = old[i];
+        if (old[i].heap >= 0)
+            path->heap[old[i].heap].tile = moved;
+    }
+
+    free(old);
+}
+
+// Node of tile, added as never reached the first time. Adding may grow the
+// table, which moves every node: no node pointer outlives the next add.
+static struct ReplanNode *reach(struct ReplanPath *path, int tile)
+{
+    int i = slot(path, tile);
+
+    if (path->nodes[i].tile == tile)
+        return &path->nodes[i];
+
+    if (2 * (path->node_count + 1) > path->node_capacity)
+    {
+        grow_nodes(path, path->node_capacity * 2);
+        i = slot(path, tile);
+    }
+
+    path->nodes[i] = unreached;
+    path->nodes[i].tile = tile;
+    path->node_count++;
+
+    return &path->nodes[i];
+}
+
+static int32_t add(int32_t cost, int32_t g)
+{
+    return cost == INFINITE || g == INFINITE ? INFINITE : cost + g;
+}
+
+// Cost of stepping into (x, y) from a neighbour
+static int32_t cost(const struct World *world, int x, int y)
+{
+    if (!is_walkable(world, x, y))
+        return INFINITE;
+
+    return PATH_COST_STRAIGHT * movement_cost(world, x, y);
+}
+
+static int32_t heuristic(const struct ReplanPath *path, int x, int y)
+{
+    return PATH_COST_STRAIGHT * (abs(x - path->start_x) + abs(y - path->start_y));
+}
+
+// [min(g, rhs) + h + km; min(g, rhs)], compared as one integer
+static uint64_t key(const struct ReplanPath *path, int x, int y)
+{
+    const struct ReplanNode *node = peek(path, y * path->owner->world->width + x);
+    int32_t m = node->g < node->rhs ? node->g : node->rhs;
+
+    if (m == INFINITE)
+        return UINT64_MAX;
+
+    return ((uint64_t)(uint32_t)(m + heuristic(path, x, y) + path->km) << 32) | (uint32_t)m;
+}
+
+static void swap_heap(struct ReplanPath *path, int a, int b)
+{
+    struct PathHeapEntry t = path->heap[a];
+    path->heap[a] = path->heap[b];
+    path->heap[b] = t;
+    path->nodes[path->heap[a].tile].heap = a;
+    path->nodes[path->heap[b].tile].heap = b;
+}
+
+static void up_heap(struct ReplanPath *path, int i)
+{
+    while (i > 0 && path->heap[(i - 1) / 2].key > path->heap[i].key)
+    {
+        swap_heap(path, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void down_heap(struct ReplanPath *path, int i)
+{
+    for (;;)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+
+        if (left < path->heap_size && path->heap[left].key < path->heap[smallest].key)
+            smallest = left;
+        if (right < path->heap_size && path->heap[right].key < path->heap[smallest].key)
+            smallest = right;
+        if (smallest == i)
+            break;
+        swap_heap(path, i, smallest);
+        i = smallest;
+    }
+}
+
+// Queue a tile or move it to its new key
+static void push_heap(struct ReplanPath *path, int tile, uint64_t key)
+{
+    struct ReplanNode *node = reach(path, tile);
+
+    if (node->heap >= 0)
+    {
+        uint64_t old = path->heap[node->heap].key;
+        path->heap[node->heap].key = key;
+        if (key < old)
+            up_heap(path, node->heap);
+        else
+            down_heap(path, node->heap);
+        return;
+    }
+
+    if (path->heap_size == path->heap_capacity)
+    {
+        int capacity = path->heap_capacity ? path->heap_capacity * 2 : 1024;
+        struct PathHeapEntry *heap = realloc(path->heap, (size_t)capacity * sizeof(*heap));
+        if (heap == NULL)
+            die("Failure to allocate replanner heap");
+        path->heap = heap;
+        path->heap_capacity = capacity;
+    }
+
+    path->heap[path->heap_size] = (struct PathHeapEntry){key, (int32_t)(node - path->nodes)};
+    node->heap = path->heap_size++;
+    up_heap(path, node->heap);
+}
+
+static void remove_heap(struct ReplanPath *path, int tile)
+{
+    struct ReplanNode *node = reach(path, tile);
+    int i = node->heap;
+
+    node->heap = -1;
+    if (--path->heap_size == i)
+        return;
+
+    path->heap[i] = path->heap[path->heap_size];
+    path->nodes[path->heap[i].tile].heap = i;
+    up_heap(path, i);
+    down_heap(path, path->nodes[path->heap[i].tile].heap);
+}
+
+// rhs from the neighbours: cheapest step plus the cost onward
+static int32_t lookahead(const struct ReplanPath *path, int x, int y)
+{
+    const struct World *world = path->owner->world;
+    int32_t best = INFINITE;
+
+    for (int k = 0; k < 4; k++)
+    {
+        int nx = x + dx[k];
+        int ny = y + dy[k];
+        if ((unsigned)nx >= (unsigned)world->width || (unsigned)ny >= (unsigned)world->height)
+            continue;
+
+        int32_t through = add(cost(world, nx, ny), peek(path, ny * world->width + nx)->g);
+        if (through < best)
+            best = through;
+    }
+
+    return best;
+}
+
+static void update_vertex(struct ReplanPath *path, int x, int y)
+{
+    int tile = y * path->owner->world->width + x;
+    int32_t rhs = x == path->goal_x && y == path->goal_y ? 0 : lookahead(path, x, y);
+
+    // never reached and still out of reach: leave it out of the table
+    if (rhs == INFINITE && peek(path, tile) == &unreached)
+        return;
+
+    struct ReplanNode *node = reach(path, tile);
+    node->rhs = rhs;
+
+    if (node->g != node->rhs)
+        push_heap(path, tile, key(path, x, y));
+    else if (node->heap >= 0)
+        remove_heap(path, tile);
+}
+
+static void update_around(struct ReplanPath *path, int x, int y)
+{
+    const struct World *world = path->owner->world;
+
+    for (int k = 0; k < 4; k++)
+    {
+        int nx = x + dx[k];
+        int ny = y + dy[k];
+        if ((unsigned)nx < (unsigned)world->width && (unsigned)ny < (unsigned)world->height)
+            update_vertex(path, nx, ny);
+    }
+}
+
+static bool stale(const struct ReplanPath *path)
+{
+    const struct ReplanNode *start = peek(path, path->start_y * path->owner->world->width + path->start_x);
+
+    return (path->heap_size > 0 && path->heap[0].key < key(path, path->start_x, path->start_y)) || start->rhs != start->g;
+}
+
+static void compute(struct ReplanPath *path)
+{
+    int width = path->owner->world->width;
+
+    path->expanded = 0;
+
+    while (stale(path))
+    {
+        struct ReplanNode *node = &path->nodes[path->heap[0].tile];
+        int tile = node->tile;
+        int x = tile % width;
+        int y = tile / width;
+        uint64_t old = path->heap[0].key;
+        uint64_t fresh = key(path, x, y);
+
+        path->expanded++;
+
+        if (old < fresh)
+            push_heap(path, tile, fresh);
+        else if (node->g > node->rhs)
+        {
+            // overconsistent: settle it, neighbours may now go through it
+            node->g = node->rhs;
+            remove_heap(path, tile);
+            update_around(path, x, y);
+        }
+        else
+        {
+            // underconsistent: the cost it had is gone, redo it and its neighbours
+            node->g = INFINITE;
+            update_vertex(path, x, y);
+            update_around(path, x, y);
+        }
+    }
+
+    path->dirty = false;
+}
+
+// World listener: only steps into the tile cost differently now, so its
+// neighbours redo their lookahead
+static void edited_replanner(void *context, int x, int y)
+{
+    struct Replanner *replanner = context;
+
+    for (int i = 0; i < replanner->count; i++)
+    {
+        struct ReplanPath *path = replanner->paths[i];
+
+        update_around(path, x, y);
+
+        if (!path->dirty && stale(path))
+        {
+            path->dirty = true;
+            if (path->affected != NULL)
+                path->affected(path->unit);
+        }
+    }
+}
+
+struct Replanner *create_replanner(struct World *world)
+{
+    struct Replanner *replanner = calloc(1, sizeof(*replanner));
+    if (replanner == NULL)
+        die("Failure to allocate replanner");
+
+    replanner->world = world;
+
+    if (!listen_world(world, edited_replanner, replanner))
+        die("Too many world listeners");
+
+    return replanner;
+}
+
+void destroy_replanner(struct Replanner *replanner)
+{
+    if (replanner == NULL)
+        return;
+
+    unlisten_world(replanner->world, replanner);
+
+    while (replanner->count > 0)
+        close_replanner(replanner, replanner->paths[replanner->count - 1]);
+
+    free(replanner->paths);
+    free(replanner);
+}
+
+struct ReplanPath *open_replanner(struct Replanner *replanner, int startX, int startY, int goalX, int goalY,
+                                  void (*affected)(void *unit), void *unit)
+{
+    const struct World *world = replanner->world;
+
+    if ((unsigned)startX >= (unsigned)world->width || (unsigned)startY >= (unsigned)world->height ||
+        (unsigned)goalX >= (unsigned)world->width || (unsigned)goalY >= (unsigned)world->height)
+        return NULL;
+
+    if (replanner->count == replanner->capacity)
+    {
+        int capacity = replanner->capacity ? replanner->capacity * 2 : 16;
+        struct ReplanPath **paths = realloc(replanner->paths, (size_t)capacity * sizeof(*paths));
+        if (paths == NULL)
+            die("Failure to allocate replanner paths");
+        replanner->paths = paths;
+        replanner->capacity = capacity;
+    }
+
+    struct ReplanPath *path = calloc(1, sizeof(*path));
+    if (path == NULL)
+        die("Failure to allocate replanner path");
+
+    grow_nodes(path, REPLANNER_NODES);
+
+    path->owner = replanner;
+    path->goal_x = goalX;
+    path->goal_y = goalY;
+    path->start_x = startX;
+    path->start_y = startY;
+    path->affected = affected;
+    path->unit = unit;
+    path->dirty = true;
+
+    reach(path, goalY * world->width + goalX)->rhs = 0;
+    push_heap(path, goalY * world->width + goalX, key(path, goalX, goalY));
+
+    replanner->paths[replanner->count++] = path;
+
+    return path;
+}
+
+void close_replanner(struct Replanner *replanner, struct ReplanPath *path)
+{
+    if (path == NULL)
+        return;
+
+    for (int i = 0; i < replanner->count; i++)
+    {
+        if (replanner->paths[i] == path)
+        {
+            replanner->paths[i] = replanner->paths[--replanner->count];
+            break;
+        }
+    }
+
+    free(path->nodes);
+    free(path->heap);
+    free(path);
+}
+
+bool step_replanner(struct ReplanPath *path, int x, int y, int *nextX, int *nextY)
+{
+    const struct World *world = path->owner->world;
+
+    if ((unsigned)x >= (unsigned)world->width || (unsigned)y >= (unsigned)world->height)
+        return false;
+
+    // queued keys were computed from where the unit stood, moving it away
+    // lowers every estimate by at most the distance walked
+    path->km += PATH_COST_STRAIGHT * (abs(path->start_x - x) + abs(path->start_y - y));
+    path->start_x = x;
+    path->start_y = y;
+    compute(path);
+
+    if (peek(path, y * world->width + x)->g == INFINITE)
+        return false;
+
+    *nextX = x;
+    *nextY = y;
+    if (x == path->goal_x && y == path->goal_y)
+        return true;
+
+    // cheapest step onward, as the costs were computed
+    int32_t best = INFINITE;
+    for (int k = 0; k < 4; k++)
+    {
+        int nx = x + dx[k];
+        int ny = y + dy[k];
+        if ((unsigned)nx >= (unsigned)world->width || (unsigned)ny >= (unsigned)world->height)
+            continue;
+
+        int32_t through = add(cost(world, nx, ny), peek(path, ny * world->width + nx)->g);
+        if (through < best)
+        {
+            best = through;
+            *nextX = nx;
+            *nextY = ny;
+        }
+    }
+
+    return best != INFINITE;
+}
+
+int32_t cost_replanner(const struct ReplanPath *path)
+{
+    return peek(path, path->start_y * path->owner->world->width + path->start_x)->g;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "world.h"
+#include "path.h"
+
+#include <stdint.h>
+
+// D* Lite search state of one tile
+struct ReplanNode
+{
+    // key in the path's node table, -1 for an empty slot
+    int32_t tile;
+    // cost to the goal, and its one step lookahead
+    int32_t g;
+    int32_t rhs;
+    // position in the open heap, -1 when not queued
+    int32_t heap;
+};
+
+// Path kept up to date while its unit walks and the world changes (D* Lite,
+// 4 neighbours, same costs as A*). The search runs from the goal, so edits
+// close to the unit are the cheapest to repair.
+struct ReplanPath
+{
+    struct Replanner *owner;
+    int goal_x;
+    int goal_y;
+    // tile the unit stands on
+    int start_x;
+    int start_y;
+    // heuristic offset accumulated as the unit moves
+    int32_t km;
+    // open addressing table of the tiles the search reached, the others
+    // read as never reached: memory follows the search, not the world
+    struct ReplanNode *nodes;
+    int node_count;
+    // slots, a power of two kept at least twice node_count
+    int node_capacity;
+    // open nodes, by slot of the node table rather than by tile
+    struct PathHeapEntry *heap;
+    int heap_size;
+    int heap_capacity;
+    // edits left the path stale, repaired by the next step_replanner
+    bool dirty;
+    // called on the edit that makes the path stale
+    void (*affected)(void *unit);
+    void *unit;
+    // vertices expanded by the last repair
+    int expanded;
+};
+
+// Active paths of a world, forwarding its edits to them
+struct Replanner
+{
+    struct World *world;
+    struct ReplanPath **paths;
+    int count;
+    int capacity;
+};
+
+struct Replanner *create_replanner(struct World *world);
+void destroy_replanner(struct Replanner *replanner);
+
+// Plans from (startX, startY) to (goalX, goalY); affected may be NULL
+struct ReplanPath *open_replanner(struct Replanner *replanner, int startX, int startY, int goalX, int goalY,
+                                  void (*affected)(void *unit), void *unit);
+void close_replanner(struct Replanner *replanner, struct ReplanPath *path);
+
+// Unit now on (x, y): repairs the path if needed and writes the next tile
+// to walk to, the goal itself once there. False when the goal is out of reach.
+bool step_replanner(struct ReplanPath *path, int x, int y, int *nextX, int *nextY);
+// Cost from the unit to the goal as of the last step, INT32_MAX when out of reach
+int32_t cost_replanner(const struct ReplanPath *path);
@@ -0,0 +1,122 @@
+#include "simulation.h"
+#include "error.h"
+
+#include <stdlib.h>
+
+#include <raymath.h>
+#include <raykit.h>
+
+struct Simulation *create_simulation(const struct Game *game)
+{
+    struct Simulation *simulation = calloc(1, sizeof(*simulation));
+    if (simulation == NULL)
+        die("Failure to allocate simulation");
+
+    simulation->world = create_world(game->world.width, game->world.height);
+    world_init(&simulation->world);
+
+    simulation->pathfinder = create_pathfinder(&simulation->world, game->path_workers);
+    straighten_pathfinder(simulation->pathfinder, game->any_angle_paths);
+    simulation->path = create_path();
+
+    simulation->hero = create_hero((Vector3){.0f, .0f, 0.f});
+    // initialize camera by hero position
+    simulation->camera = create_camera(simulation->hero.position);
+
+    simulation->clock = create_clock(game->tick_rate);
+    simulation->previous_hero = simulation->hero.position;
+    simulation->previous_view = simulation->camera.view;
+
+    return simulation;
+}
+
+void destroy_simulation(struct Simulation *simulation)
+{
+    if (simulation == NULL)
+        return;
+
+    // workers search the world until they are gone
+    destroy_pathfinder(simulation->pathfinder);
+    destroy_path(&simulation->path);
+    destroy_world(&simulation->world);
+    free(simulation);
+}
+
+int frame_simulation(struct Simulation *simulation, const struct Input *input, double seconds)
+{
+    struct Hero *hero = &simulation->hero;
+    struct Camera *camera = &simulation->camera;
+    struct Clock *clock = &simulation->clock;
+
+    // a replayed frame gets the paths the recorded one got, however long
+    // the search takes this time
+    if (input->replayed && input->paths > 0)
+        wait_pathfinder(simulation->pathfinder);
+
+    PROFILE_BEGIN("paths");
+
+    // Paths finished since the last frame
+    struct PathfinderResult result;
+    simulation->collected = 0;
+    while ((!input->replayed || simulation->collected < input->paths) &&
+           collect_pathfinder(simulation->pathfinder, &result, &simulation->path))
+    {
+        simulation->collected++;
+
+        // the path may stop short of an unreachable click
+        if (result.found && simulation->path.length > 0)
+        {
+            simulation->waypoint = 0;
+            move_hero(hero, simulation->path.nodes[0], simulation->running);
+        }
+    }
+
+    // a click before the previous path arrives replaces it
+    if (input->click)
+    {
+        simulation->running = input->running;
+        submit_pathfinder(simulation->pathfinder, HERO_UNIT, hero->position, input->target);
+    }
+
+    PROFILE_END();
+
+    if (input->rotate_clockwise)
+        clockwise_rotate_camera(camera);
+
+    if (input->rotate_counter_clockwise)
+        counter_clockwise_rotate_camera(camera);
+
+    int steps = advance_clock(clock, seconds);
+    for (int i = 0; i < steps; i++)
+    {
+        simulation->previous_hero = hero->position;
+        simulation->previous_view = camera->view;
+
+        if (input->zoom_in)
+            zoom_in_camera(camera, clock->step);
+
+        if (input->zoom_out)
+            zoom_out_camera(camera, clock->step);
+
+        PROFILE_BEGIN("update_hero");
+        follow_path_hero(hero, &simulation->path, &simulation->waypoint, clock->step);
+        update_hero(hero, clock->step);
+        PROFILE_END();
+
+        PROFILE_BEGIN("update_camera");
+        update_camera(camera, hero->position, clock->step);
+        PROFILE_END();
+    }
+
+    return steps;
+}
+
+Vector3 hero_simulation(const struct Simulation *simulation)
+{
+    return Vector3Lerp(simulation->previous_hero, simulation->hero.position, alpha_clock(&simulation->clock));
+}
+
+Camera3D view_simulation(const struct Simulation *simulation)
+{
+    return interpolate_camera(&simulation->previous_view, &simulation->camera, alpha_clock(&simulation->clock));
+}
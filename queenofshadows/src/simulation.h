@@ -0,0 +1,64 @@
+#pragma once
+
+#include "camera.h"
+#include "clock.h"
+#include "game.h"
+#include "hero.h"
+#include "pathfinder.h"
+#include "world.h"
+
+#include <raylib.h>
+
+// unit id of the hero in path requests
+#define HERO_UNIT 0
+
+// What the player did during a frame, already in world terms: a run can be
+// driven by the window, a script or a recording alike
+struct Input
+{
+    // ground point clicked this frame
+    bool click;
+    Vector3 target;
+    // double click: run to the target instead of walking
+    bool running;
+    bool rotate_clockwise;
+    bool rotate_counter_clockwise;
+    // held down during the frame
+    bool zoom_in;
+    bool zoom_out;
+    // live frames take every path the workers finished; replayed ones wait
+    // for and take as many as the recorded frame did, see Replayer
+    bool replayed;
+    int paths;
+};
+
+// Everything the game updates, no window needed
+struct Simulation
+{
+    struct World world;
+    struct Pathfinder *pathfinder;
+    struct Path path;
+    // path node the hero is heading to
+    int waypoint;
+    // walk or run once the path of the last click arrives
+    bool running;
+    struct Hero hero;
+    struct Camera camera;
+    struct Clock clock;
+    // paths collected by the last frame, what a Recorder keeps
+    int collected;
+    // state before the last step, frames are drawn in between
+    Vector3 previous_hero;
+    Camera3D previous_view;
+};
+
+struct Simulation *create_simulation(const struct Game *game);
+void destroy_simulation(struct Simulation *simulation);
+
+// A frame of the given length: collects finished paths, applies the input
+// and runs the steps the clock gives, returns how many
+int frame_simulation(struct Simulation *simulation, const struct Input *input, double seconds);
+
+// Hero position and camera view between the last two steps, for drawing
+Vector3 hero_simulation(const struct Simulation *simulation);
+Camera3D view_simulation(const struct Simulation *simulation);
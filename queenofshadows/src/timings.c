@@ -0,0 +1,113 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "timings.h"
+#include "error.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+// histogram buckets: below 1 us, then [2^(i-1), 2^i) us up to about 8 s
+#define TIMINGS_BUCKETS 24
+
+static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+
+static void reserve_timings(struct Timings *timings, int capacity)
+{
+    double *seconds = realloc(timings->seconds, (size_t)capacity * sizeof(*seconds));
+    if (seconds == NULL)
+        die("Failure to allocate timings");
+
+    timings->seconds = seconds;
+    timings->capacity = capacity;
+}
+
+struct Timings create_timings(int capacity)
+{
+    struct Timings timings = {0};
+
+    if (capacity > 0)
+        reserve_timings(&timings, capacity);
+
+    return timings;
+}
+
+void destroy_timings(struct Timings *timings)
+{
+    free(timings->seconds);
+    *timings = (struct Timings){0};
+}
+
+void add_timings(struct Timings *timings, double seconds)
+{
+    if (timings->count == timings->capacity)
+        reserve_timings(timings, timings->capacity ? timings->capacity * 2 : 1024);
+
+    timings->seconds[timings->count++] = seconds;
+    timings->sorted = false;
+}
+
+static int compare_seconds(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+double percentile_timings(struct Timings *timings, double percent)
+{
+    if (timings->count == 0)
+        return 0.0;
+
+    if (!timings->sorted)
+    {
+        qsort(timings->seconds, (size_t)timings->count, sizeof(*timings->seconds), compare_seconds);
+        timings->sorted = true;
+    }
+
+    return timings->seconds[(int)(percent / 100.0 * (timings->count - 1) + 0.5)];
+}
+
+void print_timings(struct Timings *timings, FILE *out, const char *label)
+{
+    if (timings->count == 0)
+    {
+        fprintf(out, "%s: none\n", label);
+        return;
+    }
+
+    double total = 0.0;
+    int buckets[TIMINGS_BUCKETS] = {0};
+
+    for (int i = 0; i < timings->count; i++)
+    {
+        double us = timings->seconds[i] * 1e6;
+        int bucket = us < 1.0 ? 0 : 1 + (int)log2(us);
+
+        total += timings->seconds[i];
+        buckets[bucket < TIMINGS_BUCKETS ? bucket : TIMINGS_BUCKETS - 1]++;
+    }
+
+    fprintf(out, "%s: %d, mean %.2f us", label, timings->count, total / timings->count * 1e6);
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++)
+        fprintf(out, ", p%g %.2f us", percentiles[i], percentile_timings(timings, percentiles[i]) * 1e6);
+    fprintf(out, ", max %.2f us\n", percentile_timings(timings, 100.0) * 1e6);
+
+    for (int i = 0; i < TIMINGS_BUCKETS; i++)
+    {
+        if (buckets[i] == 0)
+            continue;
+
+        if (i == 0)
+            fprintf(out, "  %8s < %-8d us %8d\n", "", 1, buckets[i]);
+        else
+            fprintf(out, "  %8.0f - %-8.0f us %8d\n", ldexp(1.0, i - 1), ldexp(1.0, i), buckets[i]);
+    }
+}
+
+double now_timings()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
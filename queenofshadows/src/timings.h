@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Durations of the frames or ticks of a run, in seconds, summarised as
+// percentiles and a histogram so two runs compare at a glance
+struct Timings
+{
+    double *seconds;
+    int count;
+    int capacity;
+    bool sorted;
+};
+
+// capacity is a hint, reserving it up front keeps adds from allocating
+struct Timings create_timings(int capacity);
+void destroy_timings(struct Timings *timings);
+
+void add_timings(struct Timings *timings, double seconds);
+// Nearest rank, 0 without timings
+double percentile_timings(struct Timings *timings, double percent);
+// Mean, percentiles, and counts per power of two microseconds
+void print_timings(struct Timings *timings, FILE *out, const char *label);
+
+// Seconds on the monotonic clock, from an arbitrary origin: for intervals
+double now_timings();
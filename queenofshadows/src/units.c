@@ -0,0 +1,275 @@
+#include "units.h"
+#include "error.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define UNITS_X86
+#include <immintrin.h>
+#endif
+
+struct Units create_units()
+{
+    return (struct Units){0};
+}
+
+void destroy_units(struct Units *units)
+{
+    free(units->x);
+    free(units->y);
+    free(units->z);
+    free(units->target_x);
+    free(units->target_z);
+    free(units->speed);
+    *units = (struct Units){0};
+}
+
+static float *grow_lanes(float *lanes, int capacity)
+{
+    float *grown = realloc(lanes, (size_t)capacity * sizeof(*grown));
+    if (grown == NULL)
+        die("Failure to allocate units");
+
+    return grown;
+}
+
+int add_units(struct Units *units, const Vector3 at)
+{
+    if (units->count == units->capacity)
+    {
+        int capacity = units->capacity ? units->capacity * 2 : 256;
+
+        units->x = grow_lanes(units->x, capacity);
+        units->y = grow_lanes(units->y, capacity);
+        units->z = grow_lanes(units->z, capacity);
+        units->target_x = grow_lanes(units->target_x, capacity);
+        units->target_z = grow_lanes(units->target_z, capacity);
+        units->speed = grow_lanes(units->speed, capacity);
+        units->capacity = capacity;
+    }
+
+    struct Hero hero = create_hero(at);
+    set_units(units, units->count, &hero);
+
+    return units->count++;
+}
+
+void move_units(struct Units *units, int unit, const Vector3 to, const bool running)
+{
+    units->speed[unit] = running ? RUNNING_SPEED : WALKING_SPEED;
+    units->target_x[unit] = to.x;
+    units->target_z[unit] = to.z;
+}
+
+Vector3 position_units(const struct Units *units, int unit)
+{
+    return (Vector3){units->x[unit], units->y[unit], units->z[unit]};
+}
+
+bool moving_units(const struct Units *units, int unit)
+{
+    return units->speed[unit] != STOP_SPEED;
+}
+
+struct Hero get_units(const struct Units *units, int unit)
+{
+    return (struct Hero){
+        .position = position_units(units, unit),
+        .target = (Vector3){units->target_x[unit], units->y[unit], units->target_z[unit]},
+        .is_moving = moving_units(units, unit),
+        .speed = units->speed[unit],
+    };
+}
+
+void set_units(struct Units *units, int unit, const struct Hero *hero)
+{
+    units->x[unit] = hero->position.x;
+    units->y[unit] = hero->position.y;
+    units->z[unit] = hero->position.z;
+    units->target_x[unit] = hero->target.x;
+    units->target_z[unit] = hero->target.z;
+    units->speed[unit] = hero->is_moving ? hero->speed : STOP_SPEED;
+}
+
+// update_hero step by step: the height never changes, and the direction is
+// normalized by multiplying with the inverse length as Vector3Normalize does
+static void update_scalar(struct Units *units, int from, float seconds)
+{
+    for (int i = from; i < units->count; i++)
+    {
+        float speed = units->speed[i];
+        if (speed == STOP_SPEED)
+            continue;
+
+        float dx = units->target_x[i] - units->x[i];
+        float dz = units->target_z[i] - units->z[i];
+        float length = sqrtf(dx * dx + dz * dz);
+        if (length != 0.0f)
+        {
+            float inverse = 1.0f / length;
+            dx *= inverse;
+            dz *= inverse;
+        }
+
+        float step = speed * seconds;
+        float x = units->x[i] + dx * step;
+        float z = units->z[i] + dz * step;
+        float ax = fabsf(x - units->target_x[i]);
+        float az = fabsf(z - units->target_z[i]);
+
+        if (speed == RUNNING_SPEED && ax < WALKING_DISTANCE_TO_TARGET && az < WALKING_DISTANCE_TO_TARGET)
+            speed = WALKING_SPEED;
+        if (ax < STOPPING_DISTANCE_TO_TARGET && az < STOPPING_DISTANCE_TO_TARGET)
+            speed = STOP_SPEED;
+
+        units->x[i] = x;
+        units->z[i] = z;
+        units->speed[i] = speed;
+    }
+}
+
+#ifdef UNITS_X86
+// The scalar step on 4 lanes: branches become masks, STOP_SPEED being 0
+// lets a mask clear the speed. Returns the first unit left to the scalar loop.
+static int update_sse(struct Units *units, float seconds)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 walking = _mm_set1_ps(WALKING_SPEED);
+    const __m128 running = _mm_set1_ps(RUNNING_SPEED);
+    const __m128 slowing = _mm_set1_ps(WALKING_DISTANCE_TO_TARGET);
+    const __m128 stopping = _mm_set1_ps(STOPPING_DISTANCE_TO_TARGET);
+    const __m128 duration = _mm_set1_ps(seconds);
+    int i = 0;
+
+    for (; i + 4 <= units->count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(units->x + i);
+        __m128 z = _mm_loadu_ps(units->z + i);
+        __m128 targetX = _mm_loadu_ps(units->target_x + i);
+        __m128 targetZ = _mm_loadu_ps(units->target_z + i);
+        __m128 speed = _mm_loadu_ps(units->speed + i);
+        __m128 moving = _mm_cmpneq_ps(speed, zero);
+
+        __m128 dx = _mm_sub_ps(targetX, x);
+        __m128 dz = _mm_sub_ps(targetZ, z);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)));
+        __m128 inverse = _mm_div_ps(one, length);
+        __m128 nonzero = _mm_cmpneq_ps(length, zero);
+        dx = _mm_or_ps(_mm_and_ps(nonzero, _mm_mul_ps(dx, inverse)), _mm_andnot_ps(nonzero, dx));
+        dz = _mm_or_ps(_mm_and_ps(nonzero, _mm_mul_ps(dz, inverse)), _mm_andnot_ps(nonzero, dz));
+
+        __m128 step = _mm_mul_ps(speed, duration);
+        x = _mm_or_ps(_mm_and_ps(moving, _mm_add_ps(x, _mm_mul_ps(dx, step))), _mm_andnot_ps(moving, x));
+        z = _mm_or_ps(_mm_and_ps(moving, _mm_add_ps(z, _mm_mul_ps(dz, step))), _mm_andnot_ps(moving, z));
+        __m128 ax = _mm_andnot_ps(sign, _mm_sub_ps(x, targetX));
+        __m128 az = _mm_andnot_ps(sign, _mm_sub_ps(z, targetZ));
+
+        __m128 slow = _mm_and_ps(_mm_cmpeq_ps(speed, running),
+                                 _mm_and_ps(_mm_cmplt_ps(ax, slowing), _mm_cmplt_ps(az, slowing)));
+        speed = _mm_or_ps(_mm_and_ps(slow, walking), _mm_andnot_ps(slow, speed));
+        __m128 stop = _mm_and_ps(moving, _mm_and_ps(_mm_cmplt_ps(ax, stopping), _mm_cmplt_ps(az, stopping)));
+        speed = _mm_andnot_ps(stop, speed);
+
+        _mm_storeu_ps(units->x + i, x);
+        _mm_storeu_ps(units->z + i, z);
+        _mm_storeu_ps(units->speed + i, speed);
+    }
+
+    return i;
+}
+
+// The same on 8 lanes, compiled for AVX whatever the build targets. Masks
+// select with and/or as on SSE, blendv measured slower.
+__attribute__((target("avx"))) static int update_avx(struct Units *units, float seconds)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 walking = _mm256_set1_ps(WALKING_SPEED);
+    const __m256 running = _mm256_set1_ps(RUNNING_SPEED);
+    const __m256 slowing = _mm256_set1_ps(WALKING_DISTANCE_TO_TARGET);
+    const __m256 stopping = _mm256_set1_ps(STOPPING_DISTANCE_TO_TARGET);
+    const __m256 duration = _mm256_set1_ps(seconds);
+    int i = 0;
+
+    for (; i + 8 <= units->count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(units->x + i);
+        __m256 z = _mm256_loadu_ps(units->z + i);
+        __m256 targetX = _mm256_loadu_ps(units->target_x + i);
+        __m256 targetZ = _mm256_loadu_ps(units->target_z + i);
+        __m256 speed = _mm256_loadu_ps(units->speed + i);
+        __m256 moving = _mm256_cmp_ps(speed, zero, _CMP_NEQ_UQ);
+
+        __m256 dx = _mm256_sub_ps(targetX, x);
+        __m256 dz = _mm256_sub_ps(targetZ, z);
+        __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz)));
+        __m256 inverse = _mm256_div_ps(one, length);
+        __m256 nonzero = _mm256_cmp_ps(length, zero, _CMP_NEQ_UQ);
+        dx = _mm256_or_ps(_mm256_and_ps(nonzero, _mm256_mul_ps(dx, inverse)), _mm256_andnot_ps(nonzero, dx));
+        dz = _mm256_or_ps(_mm256_and_ps(nonzero, _mm256_mul_ps(dz, inverse)), _mm256_andnot_ps(nonzero, dz));
+
+        __m256 step = _mm256_mul_ps(speed, duration);
+        x = _mm256_or_ps(_mm256_and_ps(moving, _mm256_add_ps(x, _mm256_mul_ps(dx, step))), _mm256_andnot_ps(moving, x));
+        z = _mm256_or_ps(_mm256_and_ps(moving, _mm256_add_ps(z, _mm256_mul_ps(dz, step))), _mm256_andnot_ps(moving, z));
+        __m256 ax = _mm256_andnot_ps(sign, _mm256_sub_ps(x, targetX));
+        __m256 az = _mm256_andnot_ps(sign, _mm256_sub_ps(z, targetZ));
+
+        __m256 slow = _mm256_and_ps(_mm256_cmp_ps(speed, running, _CMP_EQ_OQ),
+                                    _mm256_and_ps(_mm256_cmp_ps(ax, slowing, _CMP_LT_OQ),
+                                                  _mm256_cmp_ps(az, slowing, _CMP_LT_OQ)));
+        speed = _mm256_or_ps(_mm256_and_ps(slow, walking), _mm256_andnot_ps(slow, speed));
+        __m256 stop = _mm256_and_ps(moving, _mm256_and_ps(_mm256_cmp_ps(ax, stopping, _CMP_LT_OQ),
+                                                          _mm256_cmp_ps(az, stopping, _CMP_LT_OQ)));
+        speed = _mm256_andnot_ps(stop, speed);
+
+        _mm256_storeu_ps(units->x + i, x);
+        _mm256_storeu_ps(units->z + i, z);
+        _mm256_storeu_ps(units->speed + i, speed);
+    }
+
+    return i;
+}
+#endif
+
+bool supported_units(enum UnitsKernel kernel)
+{
+    switch (kernel)
+    {
+    case UNITS_SCALAR:
+        return true;
+#ifdef UNITS_X86
+    case UNITS_SSE:
+        return true;
+    case UNITS_AVX:
+        return __builtin_cpu_supports("avx");
+#endif
+    default:
+        return false;
+    }
+}
+
+void update_units_with(struct Units *units, enum UnitsKernel kernel, float seconds)
+{
+    int from = 0;
+
+#ifdef UNITS_X86
+    if (kernel == UNITS_AVX && supported_units(UNITS_AVX))
+        from = update_avx(units, seconds);
+    else if (kernel != UNITS_SCALAR)
+        from = update_sse(units, seconds);
+#else
+    (void)kernel;
+#endif
+
+    // the lanes left over, or every unit without SIMD
+    update_scalar(units, from, seconds);
+}
+
+void update_units(struct Units *units, float seconds)
+{
+    update_units_with(units, supported_units(UNITS_AVX) ? UNITS_AVX : UNITS_SSE, seconds);
+}
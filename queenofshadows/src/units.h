@@ -0,0 +1,49 @@
+#pragma once
+
+#include "hero.h"
+
+#include <raylib.h>
+
+// Batch update kernels, all giving the same results as update_hero
+enum UnitsKernel
+{
+    // one unit at a time, any target
+    UNITS_SCALAR = 0,
+    // 4 units per step, x86-64 baseline
+    UNITS_SSE = 1,
+    // 8 units per step, checked at run time
+    UNITS_AVX = 2,
+};
+
+// Moving units as a structure of arrays, one lane per unit, so a batch
+// update streams through each field. A unit moves while its speed is not
+// STOP_SPEED, which is what Hero.is_moving tracks.
+struct Units
+{
+    float *x;
+    float *y;
+    float *z;
+    float *target_x;
+    float *target_z;
+    float *speed;
+    int count;
+    int capacity;
+};
+
+struct Units create_units();
+void destroy_units(struct Units *units);
+
+// Index of the new unit, standing still at at
+int add_units(struct Units *units, const Vector3 at);
+void move_units(struct Units *units, int unit, const Vector3 to, const bool running);
+Vector3 position_units(const struct Units *units, int unit);
+bool moving_units(const struct Units *units, int unit);
+
+// Same state as a Hero, and back
+struct Hero get_units(const struct Units *units, int unit);
+void set_units(struct Units *units, int unit, const struct Hero *hero);
+
+// One simulation step for every unit, with the widest kernel this machine runs
+void update_units(struct Units *units, float seconds);
+void update_units_with(struct Units *units, enum UnitsKernel kernel, float seconds);
+bool supported_units(enum UnitsKernel kernel);
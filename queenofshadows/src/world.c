@@ -1,87 +1,206 @@
 #include "world.h"
+#include "error.h"
 
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <raylib.h>
 
-// Grid settings
-#define GRID_SIZE 5
-#define WORLD_SIZE 11
-#define TILE_SIZE 1.0f
+// Cost multiplier to step into a tile, by terrain
+// the cheapest terrain must stay at 1 so path heuristics never overestimate
+static const int terrain_costs[] = {
+    [TERRAIN_GROUND] = 1,
+    [TERRAIN_GRASS] = 1,
+    [TERRAIN_SAND] = 2,
+    [TERRAIN_WATER] = 3,
+};
+
+// Obstacles placed by world_init, relative to the world origin
+static const int obstacles[][2] = {
+    {-5, -5},
+    {-5, -4},
+    {-4, -5},
+    {-1, -2},
+    {-2, -1},
+    {2, 3},
+    {3, 3},
+    {3, 4},
+    {3, 5},
+    {5, 3},
+};
+
+// Last id given to a world, 0 is never one
+static atomic_uint last_id;
+
+// Index of grid position into the terrain bytes, caller checks bounds
+static inline size_t terrain_world(const struct World *world, int x, int y)
+{
+    return ((size_t)chunk_world(world, x, y) << (2 * CHUNK_SHIFT)) | ((y & CHUNK_MASK) << CHUNK_SHIFT) | (x & CHUNK_MASK);
+}
+
+struct World create_world(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        die("world size must be positive");
+
+    int chunks_x = (width + CHUNK_MASK) >> CHUNK_SHIFT;
+    int chunks_y = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+
+    // zeroed chunks: every tile blocked, ground terrain
+    size_t count = (size_t)chunks_x * chunks_y;
+    struct Chunk *chunks = calloc(count, sizeof(*chunks));
+    struct Chunk *columns = calloc(count, sizeof(*columns));
+    uint8_t *terrain = calloc(count, CHUNK_SIZE * CHUNK_SIZE);
+    if (chunks == NULL || columns == NULL || terrain == NULL)
+        die("Failure to allocate world chunks");
+
+    return (struct World){
+        .id = atomic_fetch_add(&last_id, 1) + 1,
+        .width = width,
+        .height = height,
+        .chunks_x = chunks_x,
+        .chunks_y = chunks_y,
+        .origin_x = width / 2,
+        .origin_y = height / 2,
+        .chunks = chunks,
+        .columns = columns,
+        .terrain = terrain,
+    };
+}
+
+void destroy_world(struct World *world)
+{
+    free(world->chunks);
+    free(world->columns);
+    free(world->terrain);
+    world->chunks = NULL;
+    world->columns = NULL;
+    world->terrain = NULL;
+    world->id = 0;
+}
+
+// Fill a chunk so that the first rows x columns tiles are walkable
+static void fill_chunk(struct Chunk *chunk, int columns, int rows)
+{
+    // tiles past the world edge stay blocked
+    uint64_t row = columns >= CHUNK_SIZE ? ~(uint64_t)0 : ((uint64_t)1 << columns) - 1;
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+        chunk->walkable[y] = y < rows ? row : 0;
+}
+
+static void notify_world(const struct World *world, int x, int y)
+{
+    for (int i = 0; i < world->listener_count; i++)
+        world->listeners[i].edited(world->listeners[i].context, x, y);
+}
 
 // Initialize walkable grid with some obstacles
 void world_init(struct World *world)
 {
-    // Make everything walkable first
-    for (int x = 0; x < WORLD_SIZE; x++)
+    // Make everything walkable first, a row at a time
+    for (int cy = 0; cy < world->chunks_y; cy++)
     {
-        for (int y = 0; y < WORLD_SIZE; y++)
+        for (int cx = 0; cx < world->chunks_x; cx++)
         {
-            world->grid[x][y] = 1;
+            int columns = world->width - (cx << CHUNK_SHIFT);
+            int rows = world->height - (cy << CHUNK_SHIFT);
+            struct Chunk *chunk = &world->chunks[cy * world->chunks_x + cx];
+            struct Chunk before = *chunk;
+
+            fill_chunk(chunk, columns, rows);
+            fill_chunk(&world->columns[cx * world->chunks_y + cy], rows, columns);
+
+            // listeners hear about the tiles that changed, one at a time
+            for (int y = 0; y < CHUNK_SIZE && world->listener_count > 0; y++)
+            {
+                for (uint64_t changed = before.walkable[y] ^ chunk->walkable[y]; changed != 0; changed &= changed - 1)
+                    notify_world(world, (cx << CHUNK_SHIFT) + __builtin_ctzll(changed), (cy << CHUNK_SHIFT) + y);
+            }
         }
     }
 
-    world->grid[0][0] = 0;
-    world->grid[0][1] = 0;
-    world->grid[1][0] = 0;
+    for (size_t i = 0; i < sizeof(obstacles) / sizeof(obstacles[0]); i++)
+        set_walkable(world, world->origin_x + obstacles[i][0], world->origin_y + obstacles[i][1], false);
+}
 
-    world->grid[4][3] = 0;
-    world->grid[3][4] = 0;
+void set_walkable(struct World *world, int x, int y, bool walkable)
+{
+    if (!in_bounds_world(world, x, y))
+        return;
+
+    uint64_t *row = &world->chunks[chunk_world(world, x, y)].walkable[y & CHUNK_MASK];
+    uint64_t *column = &world->columns[(x >> CHUNK_SHIFT) * world->chunks_y + (y >> CHUNK_SHIFT)].walkable[x & CHUNK_MASK];
+    uint64_t row_bit = (uint64_t)1 << (x & CHUNK_MASK);
+    uint64_t column_bit = (uint64_t)1 << (y & CHUNK_MASK);
 
-    world->grid[7][8] = 0;
-    world->grid[8][8] = 0;
-    world->grid[8][9] = 0;
-    world->grid[8][10] = 0;
+    if (((*row & row_bit) != 0) == walkable)
+        return;
 
-    world->grid[10][8] = 0;
+    *row ^= row_bit;
+    *column ^= column_bit;
+    notify_world(world, x, y);
 }
 
-struct World create_world()
+uint8_t get_terrain(const struct World *world, int x, int y)
 {
-    return (struct World){};
+    if (!in_bounds_world(world, x, y))
+        return TERRAIN_GROUND;
+
+    return world->terrain[terrain_world(world, x, y)];
 }
 
-// Check if grid position is valid and walkable
-bool is_walkable(struct World *world, int x, int y)
+void set_terrain(struct World *world, int x, int y, uint8_t terrain)
 {
-    if (x < 0 || x >= WORLD_SIZE || y < 0 || y >= WORLD_SIZE)
-        return false;
+    if (!in_bounds_world(world, x, y))
+        return;
+
+    uint8_t *tile = &world->terrain[terrain_world(world, x, y)];
+    if (*tile == terrain)
+        return;
 
-    return world->grid[x][y] == 1;
+    *tile = terrain;
+    notify_world(world, x, y);
 }
 
-// Convert world position to grid coordinates
-void world_to_grid(Vector3 worldPos, int *gridX, int *gridY)
+// Cost multiplier to step into a grid position
+int movement_cost(const struct World *world, int x, int y)
 {
-    if (worldPos.x >= 0)
-    {
-        *gridX = (int)(worldPos.x / TILE_SIZE + 0.5f) + GRID_SIZE;
-    }
-    if (worldPos.z >= 0)
-    {
-        *gridY = (int)(worldPos.z / TILE_SIZE + 0.5f) + GRID_SIZE;
-    }
+    uint8_t terrain = get_terrain(world, x, y);
+    if (terrain >= sizeof(terrain_costs) / sizeof(terrain_costs[0]))
+        return terrain_costs[TERRAIN_GROUND];
 
-    if (worldPos.x < 0)
-    {
-        *gridX = (int)(worldPos.x / TILE_SIZE - 0.5f) + GRID_SIZE;
-    }
-    if (worldPos.z < 0)
-    {
-        *gridY = (int)(worldPos.z / TILE_SIZE - 0.5f) + GRID_SIZE;
-    }
+    return terrain_costs[terrain];
 }
 
-// Convert grid coordinates to world position
-Vector3 grid_to_world(int gridX, int gridY)
+// Register a listener for tile edits, false when there is no room left
+bool listen_world(struct World *world, void (*edited)(void *context, int x, int y), void *context)
 {
-    return (Vector3){(gridX * TILE_SIZE) - GRID_SIZE, 0, (gridY * TILE_SIZE) - GRID_SIZE};
+    if (world->listener_count == WORLD_MAX_LISTENERS)
+        return false;
+
+    world->listeners[world->listener_count++] = (struct WorldListener){edited, context};
+    return true;
 }
 
-int grid_size()
+// Remove every listener registered with this context
+void unlisten_world(struct World *world, void *context)
 {
-    return GRID_SIZE;
+    int kept = 0;
+
+    for (int i = 0; i < world->listener_count; i++)
+        if (world->listeners[i].context != context)
+            world->listeners[kept++] = world->listeners[i];
+
+    world->listener_count = kept;
+}
+
+// Convert grid coordinates to world position
+Vector3 grid_to_world(const struct World *world, int gridX, int gridY)
+{
+    return (Vector3){(gridX - world->origin_x) * TILE_SIZE, 0, (gridY - world->origin_y) * TILE_SIZE};
 }
 
 int tile_size()
 {
     return (int)TILE_SIZE;
-}
\ No newline at end of file
+}
@@ -1,17 +1,116 @@
 #pragma once
 
 #include <raylib.h>
+#include <stdint.h>
+
+// chunk side in tiles, as a power of two so tile -> chunk is a shift
+#define CHUNK_SHIFT 6
+#define CHUNK_SIZE (1 << CHUNK_SHIFT)
+#define CHUNK_MASK (CHUNK_SIZE - 1)
+
+// world units per tile
+#define TILE_SIZE 1.0f
+
+// listeners a world can notify about tile edits
+#define WORLD_MAX_LISTENERS 16
+
+enum Terrain
+{
+    TERRAIN_GROUND = 0,
+    TERRAIN_GRASS = 1,
+    TERRAIN_SAND = 2,
+    TERRAIN_WATER = 3,
+};
+
+struct Chunk
+{
+    // Walkable bits (1 = walkable, 0 = blocked), one 64 bit word per row
+    // bit x of walkable[y] is tile (x, y) inside the chunk
+    uint64_t walkable[CHUNK_SIZE];
+};
+
+// Called after the walkable flag or the terrain of a tile changes
+struct WorldListener
+{
+    void (*edited)(void *context, int x, int y);
+    void *context;
+};
 
 struct World
 {
-    // Walkable grid (1 = walkable, 0 = blocked)
-    int grid[11][11];
+    // unique per create_world and 0 once destroyed: caches of a world check
+    // it, since a new world may be created at the address of a freed one
+    unsigned id;
+    // size in tiles
+    int width;
+    int height;
+    // size in chunks
+    int chunks_x;
+    int chunks_y;
+    // grid coordinates of the world origin (0, 0, 0)
+    int origin_x;
+    int origin_y;
+    // chunks_x * chunks_y chunks, row major
+    struct Chunk *chunks;
+    // same bits transposed, for scans along a column: bit y of
+    // columns[(x >> CHUNK_SHIFT) * chunks_y + (y >> CHUNK_SHIFT)].walkable[x & CHUNK_MASK]
+    struct Chunk *columns;
+    // terrain type per tile, kept apart from the walkable bits so lookups
+    // stay dense: CHUNK_SIZE * CHUNK_SIZE bytes per chunk, same chunk order
+    uint8_t *terrain;
+    // notified by set_walkable, set_terrain and world_init
+    struct WorldListener listeners[WORLD_MAX_LISTENERS];
+    int listener_count;
 };
 
-struct World create_world();
+// The lookups every search and unit makes per tile are defined here, so
+// they inline into the callers without link time optimization
+
+// Single unsigned compare per axis, negative values wrap to huge ones
+static inline bool in_bounds_world(const struct World *world, int x, int y)
+{
+    return ((unsigned)x < (unsigned)world->width) & ((unsigned)y < (unsigned)world->height);
+}
+
+// Index of the chunk holding grid position, caller checks bounds
+static inline int chunk_world(const struct World *world, int x, int y)
+{
+    return (y >> CHUNK_SHIFT) * world->chunks_x + (x >> CHUNK_SHIFT);
+}
+
+// Check if grid position is valid and walkable
+static inline bool is_walkable(const struct World *world, int x, int y)
+{
+    if (!in_bounds_world(world, x, y))
+        return false;
+
+    return (world->chunks[chunk_world(world, x, y)].walkable[y & CHUNK_MASK] >> (x & CHUNK_MASK)) & 1;
+}
+
+// Rounds down: truncates, then steps back for negative fractions. floorf
+// is a libm call on x86-64 without SSE4.1, slower than the whole lookup.
+static inline int floor_world(float value)
+{
+    int truncated = (int)value;
+    return truncated - (value < (float)truncated);
+}
+
+// Convert world position to grid coordinates
+// rounds to the nearest tile centre, no branch on the sign
+static inline void world_to_grid(const struct World *world, Vector3 worldPos, int *gridX, int *gridY)
+{
+    *gridX = floor_world(worldPos.x / TILE_SIZE + 0.5f) + world->origin_x;
+    *gridY = floor_world(worldPos.z / TILE_SIZE + 0.5f) + world->origin_y;
+}
+
+struct World create_world(int width, int height);
+void destroy_world(struct World *world);
 void world_init(struct World *world);
-void world_to_grid(Vector3 worldPos, int *gridX, int *gridY);
-Vector3 grid_to_world(int gridX, int gridY);
-bool is_walkable(struct World *world, int x, int y);
-int grid_size();
-int tile_size();
\ No newline at end of file
+Vector3 grid_to_world(const struct World *world, int gridX, int gridY);
+void set_walkable(struct World *world, int x, int y, bool walkable);
+uint8_t get_terrain(const struct World *world, int x, int y);
+void set_terrain(struct World *world, int x, int y, uint8_t terrain);
+int movement_cost(const struct World *world, int x, int y);
+bool listen_world(struct World *world, void (*edited)(void *context, int x, int y), void *context);
+void unlisten_world(struct World *world, void *context);
+int tile_size();
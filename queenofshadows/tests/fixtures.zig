@@ -0,0 +1,15 @@
+// Helpers shared by the game tests. Each test file has its own @cImport and
+// so its own World type: helpers take that namespace as c.
+
+// width x height world with every tile walkable
+pub fn openWorld(comptime c: type, width: c_int, height: c_int) c.struct_World {
+    var world = c.create_world(width, height);
+    var y: c_int = 0;
+    while (y < height) : (y += 1) {
+        var x: c_int = 0;
+        while (x < width) : (x += 1) {
+            c.set_walkable(&world, x, y, true);
+        }
+    }
+    return world;
+}
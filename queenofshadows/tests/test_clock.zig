@@ -0,0 +1,42 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("clock.h");
+});
+
+test "frame time is spent in whole steps, the rest carries over" {
+    var clock = c.create_clock(60);
+
+    // a 144 Hz frame is less than a step
+    try std.testing.expectEqual(@as(c_int, 0), c.advance_clock(&clock, 1.0 / 144.0));
+    try std.testing.expect(c.alpha_clock(&clock) > 0.4 and c.alpha_clock(&clock) < 0.42);
+
+    // a 30 Hz frame runs two, and the carry makes a third
+    try std.testing.expectEqual(@as(c_int, 2), c.advance_clock(&clock, 1.0 / 30.0));
+    try std.testing.expectEqual(@as(c_int, 1), c.advance_clock(&clock, 1.0 / 100.0));
+    try std.testing.expectEqual(@as(c_long, 3), clock.steps);
+    try std.testing.expect(c.alpha_clock(&clock) >= 0 and c.alpha_clock(&clock) < 1);
+}
+
+test "the same time runs the same steps at any frame rate" {
+    const rates = [_]f64{ 30, 60, 75, 144, 240 };
+    for (rates) |rate| {
+        var clock = c.create_clock(60);
+        var frame: usize = 0;
+        while (frame < @as(usize, @intFromFloat(rate)) * 10) : (frame += 1)
+            _ = c.advance_clock(&clock, 1.0 / rate);
+        // ten seconds, give or take the step still accumulating
+        try std.testing.expect(clock.steps >= 599 and clock.steps <= 600);
+        try std.testing.expectEqual(@as(f64, 0), clock.dropped);
+    }
+}
+
+test "a long frame runs at most CLOCK_MAX_STEPS and drops the rest" {
+    var clock = c.create_clock(60);
+
+    try std.testing.expectEqual(@as(c_int, c.CLOCK_MAX_STEPS), c.advance_clock(&clock, 2.0));
+    try std.testing.expect(c.alpha_clock(&clock) < 1);
+    try std.testing.expect(clock.dropped > 1.8 and clock.dropped < 2.0);
+
+    // and catches up normally afterwards
+    try std.testing.expectEqual(@as(c_int, 1), c.advance_clock(&clock, clock.step));
+}
@@ -0,0 +1,65 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("floor.h");
+});
+
+fn walkableTiles(world: *const c.struct_World) c_int {
+    var tiles: c_int = 0;
+    var y: c_int = 0;
+    while (y < world.height) : (y += 1) {
+        var x: c_int = 0;
+        while (x < world.width) : (x += 1) {
+            if (c.is_walkable(world, x, y)) tiles += 1;
+        }
+    }
+    return tiles;
+}
+
+test "every walkable tile gets a quad and its outline" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    const floor = c.create_floor(&world);
+    defer c.destroy_floor(floor);
+
+    try std.testing.expectEqual(@as(c_int, 1), c.build_floor(floor));
+    // 5 quads of 2 triangles per tile
+    try std.testing.expectEqual(walkableTiles(&world) * 30, floor.*.chunks[0].mesh.vertexCount);
+    try std.testing.expectEqual(walkableTiles(&world) * 10, floor.*.chunks[0].mesh.triangleCount);
+
+    // nothing changed, nothing to build
+    try std.testing.expectEqual(@as(c_int, 0), c.build_floor(floor));
+}
+
+test "edits rebuild only the chunk they touch" {
+    var world = c.create_world(200, 100);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    const floor = c.create_floor(&world);
+    defer c.destroy_floor(floor);
+
+    const chunks = world.chunks_x * world.chunks_y;
+    try std.testing.expectEqual(chunks, c.build_floor(floor));
+
+    const before = floor.*.chunks[1].mesh.vertexCount;
+    c.set_walkable(&world, c.CHUNK_SIZE + 3, 5, false);
+    c.set_terrain(&world, c.CHUNK_SIZE + 4, 5, c.TERRAIN_SAND);
+    try std.testing.expect(floor.*.chunks[1].dirty);
+    try std.testing.expectEqual(@as(c_int, 1), c.build_floor(floor));
+    try std.testing.expectEqual(before - 30, floor.*.chunks[1].mesh.vertexCount);
+    try std.testing.expectEqual(@as(c_long, chunks + 1), floor.*.stats.rebuilt);
+}
+
+test "a chunk without walkable tiles has no mesh" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+
+    // a new world is all blocked
+    const floor = c.create_floor(&world);
+    defer c.destroy_floor(floor);
+
+    try std.testing.expectEqual(@as(c_int, 1), c.build_floor(floor));
+    try std.testing.expectEqual(@as(c_int, 0), floor.*.chunks[0].mesh.vertexCount);
+}
@@ -0,0 +1,48 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("flow.h");
+});
+
+test "flow field costs and directions lead to the goal" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    const cache = c.create_flow_cache(&world);
+    defer c.destroy_flow_cache(cache);
+
+    const flow = c.get_flow(cache, 10, 10);
+    try std.testing.expect(flow != null);
+    // same cost as the A* path from (5, 5): 10 straight steps
+    try std.testing.expectEqual(@as(i32, 100), flow.*.cost[5 * 11 + 5]);
+    try std.testing.expectEqual(@as(u8, c.FLOW_NONE), flow.*.direction[10 * 11 + 10]);
+    // obstacles have no direction
+    try std.testing.expectEqual(@as(u8, c.FLOW_NONE), flow.*.direction[0]);
+
+    // (9, 9) goes diagonally to (10, 10)
+    const next = c.next_flow(flow, c.grid_to_world(&world, 9, 9));
+    try std.testing.expectEqual(@as(f32, 5), next.x);
+    try std.testing.expectEqual(@as(f32, 5), next.z);
+
+    try std.testing.expect(c.get_flow(cache, 0, 0) == null);
+}
+
+test "edits invalidate cached fields" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    const cache = c.create_flow_cache(&world);
+    defer c.destroy_flow_cache(cache);
+
+    _ = c.get_flow(cache, 10, 10);
+    _ = c.get_flow(cache, 10, 10);
+    try std.testing.expectEqual(@as(c_int, 1), cache.*.built);
+
+    // wall off the goal
+    c.set_walkable(&world, 9, 10, false);
+    c.set_walkable(&world, 10, 9, false);
+    const flow = c.get_flow(cache, 10, 10);
+    try std.testing.expectEqual(@as(c_int, 2), cache.*.built);
+    try std.testing.expect(!c.reachable_flow(flow, c.grid_to_world(&world, 5, 5)));
+}
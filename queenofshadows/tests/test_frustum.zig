@@ -0,0 +1,95 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("frustum.h");
+});
+
+// chunk (8, 8) of a 1024x1024 world spans -0.5 to 63.5 on both axes
+const centre = 31.5;
+
+fn looking_down(height: f32, projection: c_int, fovy: f32) c.Camera3D {
+    return c.Camera3D{
+        .position = c.Vector3{ .x = centre, .y = height, .z = centre },
+        .target = c.Vector3{ .x = centre, .y = 0, .z = centre },
+        .up = c.Vector3{ .x = 0, .y = 0, .z = -1 },
+        .fovy = fovy,
+        .projection = projection,
+    };
+}
+
+fn expectVisible(world: *const c.struct_World, frustum: *const c.struct_Frustum, x0: c_int, y0: c_int, x1: c_int, y1: c_int) !void {
+    var cy: c_int = 0;
+    while (cy < world.chunks_y) : (cy += 1) {
+        var cx: c_int = 0;
+        while (cx < world.chunks_x) : (cx += 1) {
+            const inside = cx >= x0 and cx <= x1 and cy >= y0 and cy <= y1;
+            try std.testing.expectEqual(inside, c.chunk_frustum(frustum, world, cx, cy));
+        }
+    }
+}
+
+test "looking down from close by sees the chunk below" {
+    var world = c.create_world(1024, 1024);
+    defer c.destroy_world(&world);
+
+    // 20 high with a 45 degree field of view: 8.3 tiles around the centre
+    const view = looking_down(20, c.CAMERA_PERSPECTIVE, 45);
+    const frustum = c.create_frustum(&view, 1);
+    try expectVisible(&world, &frustum, 8, 8, 8, 8);
+}
+
+test "looking down from higher sees the chunks around" {
+    var world = c.create_world(1024, 1024);
+    defer c.destroy_world(&world);
+
+    // 100 high: 41.4 tiles around the centre, into the 8 neighbours
+    const view = looking_down(100, c.CAMERA_PERSPECTIVE, 45);
+    const frustum = c.create_frustum(&view, 1);
+    try expectVisible(&world, &frustum, 7, 7, 9, 9);
+
+    // a screen 3 times wider reaches further left and right only: 124.2 tiles
+    const wide = c.create_frustum(&view, 3);
+    try expectVisible(&world, &wide, 6, 7, 10, 9);
+}
+
+test "orthographic views are as wide as fovy" {
+    var world = c.create_world(1024, 1024);
+    defer c.destroy_world(&world);
+
+    const view = looking_down(500, c.CAMERA_ORTHOGRAPHIC, 20);
+    const frustum = c.create_frustum(&view, 1);
+    try expectVisible(&world, &frustum, 8, 8, 8, 8);
+}
+
+test "nothing behind the camera is drawn" {
+    var world = c.create_world(1024, 1024);
+    defer c.destroy_world(&world);
+
+    // on the ground at the west edge of chunk 8, looking east
+    const view = c.Camera3D{
+        .position = c.Vector3{ .x = 0, .y = 1, .z = centre },
+        .target = c.Vector3{ .x = 10, .y = 1, .z = centre },
+        .up = c.Vector3{ .x = 0, .y = 1, .z = 0 },
+        .fovy = 45,
+        .projection = c.CAMERA_PERSPECTIVE,
+    };
+    const frustum = c.create_frustum(&view, 1);
+
+    try std.testing.expect(c.chunk_frustum(&frustum, &world, 8, 8));
+    try std.testing.expect(c.chunk_frustum(&frustum, &world, 15, 8));
+    var cx: c_int = 0;
+    while (cx < 7) : (cx += 1)
+        try std.testing.expect(!c.chunk_frustum(&frustum, &world, cx, 8));
+}
+
+test "boxes across a side are kept" {
+    const view = looking_down(20, c.CAMERA_PERSPECTIVE, 45);
+    const frustum = c.create_frustum(&view, 1);
+
+    // the view ends 8.3 tiles from the centre
+    const min = c.Vector3{ .x = centre + 8, .y = 0, .z = centre };
+    const max = c.Vector3{ .x = centre + 9, .y = 0, .z = centre + 1 };
+    try std.testing.expect(c.overlaps_frustum(&frustum, min, max));
+
+    const beyond = c.Vector3{ .x = centre + 8.5, .y = 0, .z = centre };
+    try std.testing.expect(!c.overlaps_frustum(&frustum, beyond, max));
+}
@@ -0,0 +1,92 @@
+const std = @import("std");
+const fixtures = @import("fixtures.zig");
+const c = @cImport({
+    @cInclude("hierarchy.h");
+});
+
+const astar = c.struct_PathOptions{ .mode = c.PATH_ASTAR, .heuristic = c.HEURISTIC_MANHATTAN, .diagonal = false };
+
+// vertical wall at x with a single gap at gapY, or none when gapY < 0
+fn wall(world: *c.struct_World, x: c_int, gapY: c_int) void {
+    var y: c_int = 0;
+    while (y < world.height) : (y += 1) {
+        c.set_walkable(world, x, y, y == gapY);
+    }
+}
+
+test "hierarchical path crosses clusters and matches A* on an open map" {
+    var world = fixtures.openWorld(c, 160, 100);
+    defer c.destroy_world(&world);
+
+    const hierarchy = c.create_hierarchy(&world);
+    defer c.destroy_hierarchy(hierarchy);
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    try std.testing.expect(c.search_hierarchy(hierarchy, &scratch, 2, 3, 150, 90));
+    // open 4 neighbour map: any path without detours is optimal
+    try std.testing.expectEqual(@as(c_int, 148 + 87), scratch.length);
+    try std.testing.expectEqual(@as(c_int, 90 * 160 + 150), scratch.path[@intCast(scratch.length - 1)]);
+
+    var i: usize = 1;
+    while (i < @as(usize, @intCast(scratch.length))) : (i += 1) {
+        const a = scratch.path[i - 1];
+        const b = scratch.path[i];
+        const dx = @abs(@mod(a, 160) - @mod(b, 160));
+        const dy = @abs(@divTrunc(a, 160) - @divTrunc(b, 160));
+        try std.testing.expectEqual(@as(c_uint, 1), dx + dy);
+    }
+}
+
+test "edits rebuild only the clusters they touch" {
+    var world = fixtures.openWorld(c, 160, 100);
+    defer c.destroy_world(&world);
+
+    const hierarchy = c.create_hierarchy(&world);
+    defer c.destroy_hierarchy(hierarchy);
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    wall(&world, 80, 70);
+    try std.testing.expect(c.search_hierarchy(hierarchy, &scratch, 5, 5, 150, 5));
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 5, 5, 150, 5));
+    const expected = scratch.length;
+    try std.testing.expect(c.search_hierarchy(hierarchy, &scratch, 5, 5, 150, 5));
+    try std.testing.expectEqual(expected, scratch.length);
+
+    // closing the gap cuts the map in two, a repeated query rebuilds nothing
+    c.set_walkable(&world, 80, 70, false);
+    try std.testing.expect(!c.search_hierarchy(hierarchy, &scratch, 5, 5, 150, 5));
+    const rebuilt = hierarchy.*.rebuilt;
+    try std.testing.expect(!c.search_hierarchy(hierarchy, &scratch, 5, 5, 150, 5));
+    try std.testing.expectEqual(rebuilt, hierarchy.*.rebuilt);
+
+    // a gap on a cluster border (x = 95 | 96) rebuilds the clusters on both sides
+    wall(&world, 95, -1);
+    c.set_walkable(&world, 80, 5, true);
+    try std.testing.expect(!c.search_hierarchy(hierarchy, &scratch, 5, 5, 150, 5));
+    const before = hierarchy.*.rebuilt;
+    c.set_walkable(&world, 95, 5, true);
+    try std.testing.expect(c.search_hierarchy(hierarchy, &scratch, 5, 5, 150, 5));
+    // near optimal: entrances sit in the middle of the border openings
+    try std.testing.expect(scratch.length >= 145 and scratch.length < 175);
+    try std.testing.expectEqual(before + 2, hierarchy.*.rebuilt);
+}
+
+test "world_init reaches a hierarchy made before it" {
+    // every tile blocked until world_init
+    var world = c.create_world(96, 64);
+    defer c.destroy_world(&world);
+
+    const hierarchy = c.create_hierarchy(&world);
+    defer c.destroy_hierarchy(hierarchy);
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    try std.testing.expect(!c.search_hierarchy(hierarchy, &scratch, 2, 2, 90, 60));
+    c.world_init(&world);
+    try std.testing.expect(c.search_hierarchy(hierarchy, &scratch, 2, 2, 90, 60));
+}
@@ -0,0 +1,277 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("logging.h");
+    @cInclude("fcntl.h");
+    @cInclude("unistd.h");
+});
+
+// Everything the flusher wrote to the pipe, once stopped
+fn drain(fd: c_int, buffer: []u8) []u8 {
+    var length: usize = 0;
+    while (length < buffer.len) {
+        const read = c.read(fd, buffer.ptr + length, buffer.len - length);
+        if (read <= 0) break;
+        length += @intCast(read);
+    }
+    return buffer[0..length];
+}
+
+test "blocking callers keep every line, in order" {
+    var fds: [2]c_int = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), c.pipe(&fds));
+    defer _ = c.close(fds[0]);
+
+    const logger = c.create_logger(c.INFO);
+    // a tiny ring, the caller waits on the flusher most of the time
+    try std.testing.expect(c.start_logging(fds[1], 5, c.LOGGING_BLOCK));
+
+    var message: [32]u8 = undefined;
+    var i: usize = 0;
+    while (i < 1000) : (i += 1) {
+        const text = try std.fmt.bufPrintZ(&message, "line {d}", .{i});
+        try std.testing.expect(c.info(&logger, text.ptr) > 0);
+    }
+    // filtered out before the ring
+    try std.testing.expectEqual(@as(c_int, 0), c.debug(&logger, "hidden"));
+
+    c.stop_logging();
+    _ = c.close(fds[1]);
+
+    const stats = c.stats_logging();
+    try std.testing.expectEqual(@as(c_long, 1000), stats.queued);
+    try std.testing.expectEqual(@as(c_long, 1000), stats.written);
+    try std.testing.expectEqual(@as(c_long, 0), stats.dropped);
+    try std.testing.expect(stats.batches <= 1000);
+
+    var buffer: [64 * 1024]u8 = undefined;
+    var lines = std.mem.splitScalar(u8, drain(fds[0], &buffer), '\n');
+    i = 0;
+    while (lines.next()) |line| {
+        if (line.len == 0) continue;
+        const tab = std.mem.lastIndexOfScalar(u8, line, '\t').?;
+        var expected: [32]u8 = undefined;
+        try std.testing.expectEqualStrings(try std.fmt.bufPrint(&expected, "line {d}", .{i}), line[tab + 1 ..]);
+        i += 1;
+    }
+    try std.testing.expectEqual(@as(usize, 1000), i);
+}
+
+test "a full ring drops lines and counts them" {
+    const null_fd = c.open("/dev/null", c.O_WRONLY);
+    try std.testing.expect(null_fd >= 0);
+    defer _ = c.close(null_fd);
+
+    const logger = c.create_logger(c.DEBUG);
+    try std.testing.expect(c.start_logging(null_fd, 2, c.LOGGING_DROP));
+    // one ring at a time
+    try std.testing.expect(!c.start_logging(null_fd, 2, c.LOGGING_DROP));
+
+    var i: usize = 0;
+    while (i < 100000) : (i += 1) _ = c.warn(&logger, "flood");
+    c.stop_logging();
+
+    const stats = c.stats_logging();
+    try std.testing.expectEqual(@as(c_long, 100000), stats.queued + stats.dropped);
+    try std.testing.expectEqual(stats.queued, stats.written);
+    try std.testing.expectEqual(@as(c_long, 0), stats.waits);
+}
+
+var spamming = std.atomic.Value(bool).init(true);
+
+fn spam(logger: *const c.struct_Logger) void {
+    while (spamming.load(.acquire)) _ = c.info(logger, "spam");
+}
+
+test "stopping waits for the callers still in the ring" {
+    const null_fd = c.open("/dev/null", c.O_WRONLY);
+    try std.testing.expect(null_fd >= 0);
+    defer _ = c.close(null_fd);
+
+    // lines logged once stopped go to stdout
+    const stdout = c.dup(c.STDOUT_FILENO);
+    defer {
+        _ = c.dup2(stdout, c.STDOUT_FILENO);
+        _ = c.close(stdout);
+    }
+    _ = c.dup2(null_fd, c.STDOUT_FILENO);
+
+    const logger = c.create_logger(c.INFO);
+    var round: usize = 0;
+    while (round < 50) : (round += 1) {
+        try std.testing.expect(c.start_logging(null_fd, 2, c.LOGGING_BLOCK));
+        spamming.store(true, .release);
+
+        var threads: [4]std.Thread = undefined;
+        for (&threads) |*thread| thread.* = try std.Thread.spawn(.{}, spam, .{&logger});
+        std.time.sleep(100 * std.time.ns_per_us);
+
+        c.stop_logging();
+        spamming.store(false, .release);
+        for (threads) |thread| thread.join();
+
+        // no line queued after the flusher left
+        const stats = c.stats_logging();
+        try std.testing.expectEqual(stats.queued, stats.written);
+    }
+}
+
+// The messages the flusher wrote, without their time and level
+fn messages(log: []const u8, found: [][]const u8) []const []const u8 {
+    var count: usize = 0;
+    var lines = std.mem.splitScalar(u8, log, '\n');
+    while (lines.next()) |line| {
+        if (line.len == 0) continue;
+        found[count] = line[std.mem.lastIndexOfScalar(u8, line, '\t').? + 1 ..];
+        count += 1;
+    }
+    return found[0..count];
+}
+
+// What LOGGER_* declares at each call: static, stop_logging keeps the
+// sites that counted something
+var limited_site = std.mem.zeroes(c.struct_LoggingSite);
+var repeated_site = std.mem.zeroes(c.struct_LoggingSite);
+
+test "lines past a site's burst are refused, its next line says how many" {
+    var fds: [2]c_int = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), c.pipe(&fds));
+    defer _ = c.close(fds[0]);
+
+    limited_site.level = c.INFO;
+    limited_site.file = "test_logging.zig";
+    limited_site.line = 1;
+    limited_site.fmt = "line %d";
+
+    var logger = c.create_logger(c.INFO);
+    // a line every 1000 seconds, nothing is refilled during the test
+    c.limit_logger(&logger, 0.001, 3);
+    try std.testing.expect(c.start_logging(fds[1], 8, c.LOGGING_BLOCK));
+    const before = c.stats_logging();
+
+    var i: c_int = 0;
+    while (i < 10) : (i += 1) {
+        try std.testing.expectEqual(i < 3, c.write_logger(&logger, &limited_site, i) > 0);
+    }
+    // without a rate the next line goes through, the count before it
+    c.limit_logger(&logger, 0, 3);
+    try std.testing.expect(c.write_logger(&logger, &limited_site, @as(c_int, 10)) > 0);
+
+    c.stop_logging();
+    _ = c.close(fds[1]);
+
+    const stats = c.stats_logging();
+    try std.testing.expectEqual(@as(c_long, 7), stats.limited - before.limited);
+    try std.testing.expectEqual(@as(c_long, 0), stats.collapsed - before.collapsed);
+
+    var buffer: [4096]u8 = undefined;
+    var found: [16][]const u8 = undefined;
+    const written = messages(drain(fds[0], &buffer), &found);
+    const expected = [_][]const u8{ "line 0", "line 1", "line 2", "7 messages suppressed (test_logging.zig:1)", "line 10" };
+    try std.testing.expectEqual(expected.len, written.len);
+    for (expected, written) |line, message| try std.testing.expectEqualStrings(line, message);
+}
+
+test "a repeated message is written once, then counted" {
+    var fds: [2]c_int = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), c.pipe(&fds));
+    defer _ = c.close(fds[0]);
+
+    repeated_site.level = c.INFO;
+    repeated_site.file = "test_logging.zig";
+    repeated_site.line = 2;
+    repeated_site.fmt = "%s";
+
+    var logger = c.create_logger(c.INFO);
+    // no rate, only repeats are held back
+    c.limit_logger(&logger, 0, 1);
+    try std.testing.expect(c.start_logging(fds[1], 8, c.LOGGING_BLOCK));
+    const before = c.stats_logging();
+
+    const same: [*:0]const u8 = "same";
+    const other: [*:0]const u8 = "other";
+    var i: usize = 0;
+    while (i < 5) : (i += 1) {
+        try std.testing.expectEqual(i == 0, c.write_logger(&logger, &repeated_site, same) > 0);
+    }
+    // reported when the message changes
+    try std.testing.expect(c.write_logger(&logger, &repeated_site, other) > 0);
+    // and when logging stops
+    try std.testing.expectEqual(@as(c_int, 0), c.write_logger(&logger, &repeated_site, other));
+    try std.testing.expectEqual(@as(c_int, 0), c.write_logger(&logger, &repeated_site, other));
+
+    c.stop_logging();
+    _ = c.close(fds[1]);
+
+    const stats = c.stats_logging();
+    try std.testing.expectEqual(@as(c_long, 0), stats.limited - before.limited);
+    try std.testing.expectEqual(@as(c_long, 6), stats.collapsed - before.collapsed);
+
+    var buffer: [4096]u8 = undefined;
+    var found: [16][]const u8 = undefined;
+    const written = messages(drain(fds[0], &buffer), &found);
+    const expected = [_][]const u8{
+        "same",
+        "last message repeated 4 times (test_logging.zig:2)",
+        "other",
+        "last message repeated 2 times (test_logging.zig:2)",
+    };
+    try std.testing.expectEqual(expected.len, written.len);
+    for (expected, written) |line, message| try std.testing.expectEqualStrings(line, message);
+}
+
+test "long messages are cut, the line still ends" {
+    var fds: [2]c_int = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), c.pipe(&fds));
+    defer _ = c.close(fds[0]);
+
+    const logger = c.create_logger(c.INFO);
+    try std.testing.expect(c.start_logging(fds[1], 4, c.LOGGING_BLOCK));
+
+    var message: [2048:0]u8 = undefined;
+    @memset(&message, 'a');
+    try std.testing.expectEqual(@as(c_int, c.LOGGING_LINE), c.@"error"(&logger, &message));
+
+    c.stop_logging();
+    _ = c.close(fds[1]);
+
+    var buffer: [4096]u8 = undefined;
+    const written = drain(fds[0], &buffer);
+    try std.testing.expectEqual(@as(usize, c.LOGGING_LINE), written.len);
+    try std.testing.expectEqual(@as(u8, '\n'), written[written.len - 1]);
+}
+
+test "argument kinds follow printf's types" {
+    var kinds: [c.LOGGING_MAX_ARGUMENTS]u8 = undefined;
+
+    const count = c.arguments_logging("%d %s %*.*f %zu %lld %lx %hhd %c %p %% %.3g", &kinds);
+    try std.testing.expectEqual(@as(c_int, 12), count);
+    try std.testing.expectEqualStrings("isiidzqmiipd", kinds[0..12]);
+
+    // printf can read these, the binary log cannot store them
+    try std.testing.expectEqual(@as(c_int, -1), c.arguments_logging("%n", &kinds));
+    try std.testing.expectEqual(@as(c_int, -1), c.arguments_logging("%Lf", &kinds));
+    try std.testing.expectEqual(@as(c_int, -1), c.arguments_logging("%ls", &kinds));
+    try std.testing.expectEqual(@as(c_int, 0), c.arguments_logging("100%% done", &kinds));
+}
+
+test "a binary log starts with its magic, plain messages as text records" {
+    var fds: [2]c_int = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), c.pipe(&fds));
+    defer _ = c.close(fds[0]);
+
+    const logger = c.create_logger(c.INFO);
+    try std.testing.expect(c.defer_logging(fds[1], 8, c.LOGGING_BLOCK));
+    try std.testing.expect(c.warn(&logger, "stored as is") > 0);
+    c.stop_logging();
+    _ = c.close(fds[1]);
+
+    var buffer: [1024]u8 = undefined;
+    const log = drain(fds[0], &buffer);
+    const magic = c.LOGGING_MAGIC;
+    try std.testing.expectEqualStrings(magic, log[0..magic.len]);
+
+    const record = log[magic.len..];
+    try std.testing.expectEqual(record.len, std.mem.bytesToValue(u16, record[0..2]));
+    try std.testing.expectEqual(@as(u8, c.LOGGING_TEXT), record[2]);
+    try std.testing.expect(std.mem.endsWith(u8, record, "stored as is"));
+}
@@ -0,0 +1,100 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("navigation.h");
+});
+
+test "paths are owned by the caller and contexts are independent" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    var first = c.create_path_context(null);
+    defer c.destroy_path_context(&first);
+    var second = c.create_path_context(null);
+    defer c.destroy_path_context(&second);
+
+    var a = c.create_path();
+    defer c.destroy_path(&a);
+    var b = c.create_path();
+    defer c.destroy_path(&b);
+
+    const origin = c.Vector3{ .x = 0, .y = 0, .z = 0 };
+    try std.testing.expect(c.find_path(&first, &world, origin, c.Vector3{ .x = 5, .y = 0, .z = 5 }, &a));
+    try std.testing.expect(c.find_path(&second, &world, origin, c.Vector3{ .x = -2, .y = 0, .z = 0 }, &b));
+
+    // the second query does not touch the first result
+    try std.testing.expectEqual(@as(c_int, 10), a.length);
+    try std.testing.expectEqual(@as(f32, 5), a.nodes[9].x);
+    try std.testing.expectEqual(@as(f32, 5), a.nodes[9].z);
+    try std.testing.expectEqual(@as(c_int, 2), b.length);
+    try std.testing.expectEqual(@as(f32, -2), b.nodes[1].x);
+
+    // no path: the previous result stays
+    c.set_walkable(&world, 0, 0, false);
+    try std.testing.expect(!c.find_path(&first, &world, origin, c.Vector3{ .x = -5, .y = 0, .z = -5 }, &a));
+    try std.testing.expectEqual(@as(c_int, 10), a.length);
+}
+
+const astar = c.struct_PathOptions{ .mode = c.PATH_ASTAR, .heuristic = c.HEURISTIC_MANHATTAN, .diagonal = false };
+const hierarchical = c.struct_PathOptions{ .mode = c.PATH_HIERARCHICAL, .heuristic = c.HEURISTIC_MANHATTAN, .diagonal = false };
+
+test "a world made where a destroyed one was gets its own hierarchy" {
+    var world = c.create_world(96, 64);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    var context = c.create_path_context(null);
+    defer c.destroy_path_context(&context);
+    var path = c.create_path();
+    defer c.destroy_path(&path);
+
+    const start = c.Vector3{ .x = -45, .y = 0, .z = -30 };
+    const end = c.Vector3{ .x = 45, .y = 0, .z = 30 };
+    try std.testing.expect(c.find_path_with(&context, &world, start, end, &hierarchical, &path));
+
+    // same address, another world: a wall at x = 48 with a gap at the top
+    c.destroy_world(&world);
+    world = c.create_world(96, 64);
+    c.world_init(&world);
+    var y: c_int = 1;
+    while (y < 64) : (y += 1) c.set_walkable(&world, 48, y, false);
+
+    try std.testing.expect(c.find_path_with(&context, &world, start, end, &hierarchical, &path));
+    try std.testing.expectEqual(world.id, context.hierarchy.*.world_id);
+    for (path.nodes[0..@intCast(path.length)]) |node| {
+        try std.testing.expect(c.is_walkable(&world, @as(c_int, @intFromFloat(node.x)) + 48, @as(c_int, @intFromFloat(node.z)) + 32));
+    }
+}
+
+test "find_path is shortest unless the context is hierarchical" {
+    var world = c.create_world(512, 512);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    // three walls with one gap each
+    const walls = [_][2]c_int{ .{ 128, 100 }, .{ 256, 400 }, .{ 384, 200 } };
+    for (walls) |w| {
+        var y: c_int = 0;
+        while (y < 512) : (y += 1) c.set_walkable(&world, w[0], y, y == w[1]);
+    }
+
+    var context = c.create_path_context(null);
+    defer c.destroy_path_context(&context);
+    var path = c.create_path();
+    defer c.destroy_path(&path);
+
+    const start = c.Vector3{ .x = -250, .y = 0, .z = -250 };
+    const end = c.Vector3{ .x = 250, .y = 0, .z = 250 };
+    try std.testing.expect(c.find_path_with(&context, &world, start, end, &astar, &path));
+    const shortest = path.length;
+
+    try std.testing.expect(c.find_path(&context, &world, start, end, &path));
+    try std.testing.expectEqual(shortest, path.length);
+    try std.testing.expect(context.hierarchy == null);
+
+    // HPA* on a world this size: never shorter, a few percent longer at most here
+    context.hierarchical = true;
+    try std.testing.expect(c.find_path(&context, &world, start, end, &path));
+    try std.testing.expect(context.hierarchy != null);
+    try std.testing.expect(path.length >= shortest and path.length * 10 <= shortest * 11);
+}
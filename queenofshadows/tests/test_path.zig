@@ -0,0 +1,134 @@
+const std = @import("std");
+const fixtures = @import("fixtures.zig");
+const c = @cImport({
+    @cInclude("path.h");
+});
+
+const astar = c.struct_PathOptions{ .mode = c.PATH_ASTAR, .heuristic = c.HEURISTIC_MANHATTAN, .diagonal = false };
+
+test "A* finds the shortest path around the initial obstacles" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 5, 5, 10, 10));
+    try std.testing.expectEqual(@as(c_int, 10), scratch.length);
+    // last node is the goal
+    try std.testing.expectEqual(@as(c_int, 10 * 11 + 10), scratch.path[@intCast(scratch.length - 1)]);
+}
+
+test "blocked or unreachable goals are rejected" {
+    var world = fixtures.openWorld(c, 8, 8);
+    defer c.destroy_world(&world);
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    c.set_walkable(&world, 7, 7, false);
+    try std.testing.expect(!c.search_path(&scratch, &world, &astar, 0, 0, 7, 7));
+
+    // wall off (0, 7)
+    c.set_walkable(&world, 0, 6, false);
+    c.set_walkable(&world, 1, 7, false);
+    try std.testing.expect(!c.search_path(&scratch, &world, &astar, 0, 0, 0, 7));
+}
+
+test "terrain cost makes the path go around water" {
+    var world = fixtures.openWorld(c, 5, 3);
+    defer c.destroy_world(&world);
+
+    var x: c_int = 1;
+    while (x <= 3) : (x += 1) {
+        c.set_terrain(&world, x, 1, c.TERRAIN_WATER);
+    }
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 0, 1, 4, 1));
+    try std.testing.expectEqual(@as(c_int, 6), scratch.length);
+    for (scratch.path[0..@intCast(scratch.length)]) |tile| {
+        try std.testing.expect(@divTrunc(tile, 5) != 1 or @mod(tile, 5) == 0 or @mod(tile, 5) == 4);
+    }
+}
+
+test "a reused scratch finds the same path again" {
+    var world = c.create_world(64, 64);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    // a wall with a single gap
+    var y: c_int = 0;
+    while (y < 60) : (y += 1) {
+        c.set_walkable(&world, 32, y, false);
+    }
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 2, 2, 60, 3));
+    const expected = scratch.length;
+    // scratch is reused without clearing between searches
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 60, 3, 2, 50));
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 2, 2, 60, 3));
+    try std.testing.expectEqual(expected, scratch.length);
+}
+
+test "jump point search matches A* on 4 and 8 neighbours" {
+    var world = c.create_world(64, 64);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    var y: c_int = 0;
+    while (y < 60) : (y += 1) {
+        c.set_walkable(&world, 32, y, false);
+    }
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    const jps4 = c.struct_PathOptions{ .mode = c.PATH_JPS, .heuristic = c.HEURISTIC_MANHATTAN, .diagonal = false };
+    try std.testing.expect(c.search_path(&scratch, &world, &astar, 2, 2, 60, 3));
+    const expected = scratch.length;
+    try std.testing.expect(c.search_path(&scratch, &world, &jps4, 2, 2, 60, 3));
+    try std.testing.expectEqual(expected, scratch.length);
+
+    // open diagonal: one tile per step, the longer axis
+    const jps8 = c.struct_PathOptions{ .mode = c.PATH_JPS, .heuristic = c.HEURISTIC_OCTILE, .diagonal = true };
+    try std.testing.expect(c.search_path(&scratch, &world, &jps8, 40, 10, 60, 50));
+    try std.testing.expectEqual(@as(c_int, 40), scratch.length);
+}
+
+test "any angle paths keep the turns around obstacles" {
+    var world = c.create_world(64, 64);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    var y: c_int = 0;
+    while (y < 60) : (y += 1) {
+        c.set_walkable(&world, 32, y, false);
+    }
+
+    var scratch = c.create_path_scratch();
+    defer c.destroy_path_scratch(&scratch);
+
+    const anyAngle = c.struct_PathOptions{ .mode = c.PATH_ASTAR, .heuristic = c.HEURISTIC_MANHATTAN, .any_angle = true };
+    // around the end of the wall: one waypoint on each side of it
+    try std.testing.expect(c.search_path(&scratch, &world, &anyAngle, 2, 2, 60, 3));
+    try std.testing.expectEqual(@as(c_int, 3), scratch.length);
+    try std.testing.expectEqual(@as(c_int, 60 * 64 + 31), scratch.path[0]);
+    try std.testing.expectEqual(@as(c_int, 60 * 64 + 33), scratch.path[1]);
+    try std.testing.expectEqual(@as(c_int, 3 * 64 + 60), scratch.path[2]);
+
+    // in sight: straight to the goal
+    try std.testing.expect(c.search_path(&scratch, &world, &anyAngle, 2, 2, 20, 9));
+    try std.testing.expectEqual(@as(c_int, 1), scratch.length);
+
+    // the straight line would cross water the grid path avoids
+    c.set_terrain(&world, 10, 5, c.TERRAIN_WATER);
+    try std.testing.expect(c.search_path(&scratch, &world, &anyAngle, 2, 2, 20, 9));
+    try std.testing.expectEqual(@as(c_int, 2), scratch.length);
+}
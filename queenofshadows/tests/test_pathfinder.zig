@@ -0,0 +1,80 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("pathfinder.h");
+});
+
+const origin = c.Vector3{ .x = 0, .y = 0, .z = 0 };
+
+test "finished paths are collected by the caller" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    const pathfinder = c.create_pathfinder(&world, 2);
+    defer c.destroy_pathfinder(pathfinder);
+
+    var path = c.create_path();
+    defer c.destroy_path(&path);
+    var result: c.struct_PathfinderResult = undefined;
+
+    c.submit_pathfinder(pathfinder, 0, origin, c.Vector3{ .x = 5, .y = 0, .z = 5 });
+    c.submit_pathfinder(pathfinder, 1, origin, c.Vector3{ .x = -5, .y = 0, .z = -5 });
+    c.wait_pathfinder(pathfinder);
+
+    var found: c_int = 0;
+    while (c.collect_pathfinder(pathfinder, &result, &path)) {
+        try std.testing.expect(result.found);
+        const last = path.nodes[@intCast(path.length - 1)];
+        if (result.unit == 0) {
+            try std.testing.expectEqual(@as(c_int, 10), path.length);
+        } else {
+            // (-5, -5) is an obstacle: the path ends on the closest reachable tile
+            try std.testing.expectEqual(@as(f32, -4), last.x);
+            try std.testing.expectEqual(@as(f32, -4), last.z);
+        }
+        found += 1;
+    }
+    try std.testing.expectEqual(@as(c_int, 2), found);
+
+    const stats = c.stats_pathfinder(pathfinder);
+    try std.testing.expectEqual(@as(c_long, 2), stats.completed);
+    try std.testing.expectEqual(@as(c_int, 0), stats.depth);
+}
+
+test "a new request supersedes the pending one and cancel drops it" {
+    var world = c.create_world(11, 11);
+    defer c.destroy_world(&world);
+    c.world_init(&world);
+
+    const pathfinder = c.create_pathfinder(&world, 1);
+    defer c.destroy_pathfinder(pathfinder);
+
+    var path = c.create_path();
+    defer c.destroy_path(&path);
+    var result: c.struct_PathfinderResult = undefined;
+
+    // paused: requests stay queued
+    c.pause_pathfinder(pathfinder);
+    c.submit_pathfinder(pathfinder, 0, origin, c.Vector3{ .x = 5, .y = 0, .z = 5 });
+    c.submit_pathfinder(pathfinder, 0, origin, c.Vector3{ .x = 2, .y = 0, .z = 0 });
+    c.submit_pathfinder(pathfinder, 1, origin, c.Vector3{ .x = 0, .y = 0, .z = 3 });
+    c.cancel_pathfinder(pathfinder, 1);
+
+    var stats = c.stats_pathfinder(pathfinder);
+    try std.testing.expectEqual(@as(c_int, 1), stats.depth);
+    try std.testing.expectEqual(@as(c_long, 1), stats.coalesced);
+    try std.testing.expectEqual(@as(c_long, 1), stats.cancelled);
+
+    c.resume_pathfinder(pathfinder);
+    c.wait_pathfinder(pathfinder);
+
+    try std.testing.expect(c.collect_pathfinder(pathfinder, &result, &path));
+    try std.testing.expectEqual(@as(c_int, 0), result.unit);
+    try std.testing.expectEqual(@as(f32, 2), result.end.x);
+    try std.testing.expectEqual(@as(c_int, 2), path.length);
+    try std.testing.expect(!c.collect_pathfinder(pathfinder, &result, &path));
+
+    stats = c.stats_pathfinder(pathfinder);
+    try std.testing.expectEqual(@as(c_long, 3), stats.submitted);
+    try std.testing.expectEqual(@as(c_long, 1), stats.completed);
+}
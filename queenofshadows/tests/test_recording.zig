@@ -0,0 +1,106 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("recording.h");
+});
+
+const file = "test_recording.bin";
+
+fn header() c.struct_RecordingHeader {
+    return c.struct_RecordingHeader{
+        .tick_rate = 60,
+        .world_width = 11,
+        .world_height = 11,
+        .seed = 0,
+        .any_angle_paths = true,
+    };
+}
+
+test "recorded frames replay as they were" {
+    defer std.fs.cwd().deleteFile(file) catch {};
+
+    var frames = [_]c.struct_Input{std.mem.zeroes(c.struct_Input)} ** 3;
+    frames[0].click = true;
+    frames[0].running = true;
+    frames[0].target = c.Vector3{ .x = 3.25, .y = 0, .z = -2 };
+    frames[1].zoom_in = true;
+    frames[2].rotate_counter_clockwise = true;
+    const seconds = [_]f32{ 1.0 / 60.0, 0.25, 1.0 / 144.0 };
+    const paths = [_]c_int{ 0, 1, 0 };
+
+    const h = header();
+    const recorder = c.create_recorder(file, &h);
+    try std.testing.expect(recorder != null);
+    for (frames, 0..) |frame, i|
+        try std.testing.expect(c.record_recorder(recorder, &frame, paths[i], seconds[i]));
+    try std.testing.expect(c.destroy_recorder(recorder));
+
+    const replayer = c.create_replayer(file);
+    try std.testing.expect(replayer != null);
+    defer c.destroy_replayer(replayer);
+    try std.testing.expectEqual(@as(c_int, 11), replayer.*.header.world_width);
+    try std.testing.expect(replayer.*.header.any_angle_paths);
+
+    var input: c.struct_Input = undefined;
+    var length: f32 = undefined;
+    for (frames, 0..) |frame, i| {
+        try std.testing.expect(c.replay_replayer(replayer, &input, &length));
+        try std.testing.expectEqual(seconds[i], length);
+        try std.testing.expect(input.replayed);
+        try std.testing.expectEqual(paths[i], input.paths);
+        try std.testing.expectEqual(frame.click, input.click);
+        try std.testing.expectEqual(frame.running, input.running);
+        try std.testing.expectEqual(frame.zoom_in, input.zoom_in);
+        try std.testing.expectEqual(frame.rotate_counter_clockwise, input.rotate_counter_clockwise);
+        try std.testing.expectEqual(frame.target.x, input.target.x);
+        try std.testing.expectEqual(frame.target.z, input.target.z);
+    }
+    try std.testing.expect(!c.replay_replayer(replayer, &input, &length));
+}
+
+test "files that are not recordings are refused" {
+    defer std.fs.cwd().deleteFile(file) catch {};
+
+    try std.fs.cwd().writeFile(.{ .sub_path = file, .data = "QOSX not a recording" });
+    try std.testing.expect(c.create_replayer(file) == null);
+    try std.testing.expect(c.create_replayer("missing.bin") == null);
+}
+
+test "a replay runs the simulation through the same steps" {
+    defer std.fs.cwd().deleteFile(file) catch {};
+
+    const game = c.create_game();
+    const h = header();
+    var simulation = c.create_simulation(&game);
+    const recorder = c.create_recorder(file, &h);
+
+    // uneven frames, paths arriving whenever the workers are done
+    var frame: usize = 0;
+    while (frame < 900) : (frame += 1) {
+        var input = std.mem.zeroes(c.struct_Input);
+        if (frame % 150 == 0) {
+            input.click = true;
+            input.running = frame % 300 == 0;
+            input.target = c.Vector3{ .x = @floatFromInt(@as(i32, @intCast(frame % 9)) - 4), .y = 0, .z = 3 };
+        }
+        const seconds: f32 = if (frame % 7 == 0) 0.05 else 1.0 / 120.0;
+        _ = c.frame_simulation(simulation, &input, seconds);
+        try std.testing.expect(c.record_recorder(recorder, &input, simulation.*.collected, seconds));
+    }
+    try std.testing.expect(c.destroy_recorder(recorder));
+    const recorded = simulation.*.hero.position;
+    c.destroy_simulation(simulation);
+
+    simulation = c.create_simulation(&game);
+    defer c.destroy_simulation(simulation);
+    const replayer = c.create_replayer(file);
+    defer c.destroy_replayer(replayer);
+
+    var input: c.struct_Input = undefined;
+    var seconds: f32 = undefined;
+    while (c.replay_replayer(replayer, &input, &seconds))
+        _ = c.frame_simulation(simulation, &input, seconds);
+
+    try std.testing.expectEqual(@as(c_long, 900), replayer.*.frames);
+    try std.testing.expectEqual(recorded.x, simulation.*.hero.position.x);
+    try std.testing.expectEqual(recorded.z, simulation.*.hero.position.z);
+}
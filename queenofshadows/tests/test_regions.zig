@@ -0,0 +1,69 @@
+const std = @import("std");
+const fixtures = @import("fixtures.zig");
+const c = @cImport({
+    @cInclude("regions.h");
+});
+
+test "walls split regions and openings join them" {
+    var world = fixtures.openWorld(c, 16, 8);
+    defer c.destroy_world(&world);
+
+    const regions = c.create_regions(&world);
+    defer c.destroy_regions(regions);
+
+    try std.testing.expect(c.connected_regions(regions, 0, 0, 15, 7));
+
+    // wall at x = 8 cuts the map in two
+    var y: c_int = 0;
+    while (y < 8) : (y += 1) {
+        c.set_walkable(&world, 8, y, false);
+    }
+    try std.testing.expect(!c.connected_regions(regions, 0, 0, 15, 7));
+    try std.testing.expect(c.connected_regions(regions, 0, 0, 7, 7));
+    try std.testing.expectEqual(@as(i32, 64), regions.*.sizes[@intCast(c.label_regions(regions, 0, 0))]);
+    try std.testing.expectEqual(@as(i32, 56), regions.*.sizes[@intCast(c.label_regions(regions, 15, 7))]);
+
+    // blocked tiles belong to no region
+    try std.testing.expectEqual(@as(i32, 0), c.label_regions(regions, 8, 3));
+    try std.testing.expect(!c.connected_regions(regions, 8, 3, 8, 3));
+
+    c.set_walkable(&world, 8, 3, true);
+    try std.testing.expect(c.connected_regions(regions, 0, 0, 15, 7));
+    try std.testing.expectEqual(@as(i32, 121), regions.*.sizes[@intCast(c.label_regions(regions, 0, 0))]);
+}
+
+test "nearest reachable tile to a blocked or cut off goal" {
+    var world = fixtures.openWorld(c, 16, 8);
+    defer c.destroy_world(&world);
+
+    const regions = c.create_regions(&world);
+    defer c.destroy_regions(regions);
+
+    var y: c_int = 0;
+    while (y < 8) : (y += 1) {
+        c.set_walkable(&world, 8, y, false);
+    }
+
+    var x: c_int = 12;
+    y = 4;
+    try std.testing.expect(c.nearest_regions(regions, 0, 0, &x, &y));
+    try std.testing.expectEqual(@as(c_int, 7), x);
+    try std.testing.expectEqual(@as(c_int, 4), y);
+
+    // outside the world
+    x = -3;
+    y = 2;
+    try std.testing.expect(c.nearest_regions(regions, 0, 0, &x, &y));
+    try std.testing.expectEqual(@as(c_int, 0), x);
+    try std.testing.expectEqual(@as(c_int, 2), y);
+
+    // far off the world: the rings start at its edge
+    x = 1000000;
+    y = -1000000;
+    try std.testing.expect(c.nearest_regions(regions, 0, 0, &x, &y));
+    try std.testing.expectEqual(@as(c_int, 7), x);
+    try std.testing.expectEqual(@as(c_int, 0), y);
+
+    // a blocked start has no region
+    try std.testing.expect(!c.nearest_regions(regions, 8, 0, &x, &y));
+}
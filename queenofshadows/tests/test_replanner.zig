@@ -0,0 +1,86 @@
+const std = @import("std");
+const fixtures = @import("fixtures.zig");
+const c = @cImport({
+    @cInclude("replanner.h");
+});
+
+var notified: c_int = 0;
+
+fn affected(unit: ?*anyopaque) callconv(.C) void {
+    _ = unit;
+    notified += 1;
+}
+
+test "replanned path walks to the goal" {
+    var world = fixtures.openWorld(c, 11, 11);
+    defer c.destroy_world(&world);
+
+    const replanner = c.create_replanner(&world);
+    defer c.destroy_replanner(replanner);
+
+    const path = c.open_replanner(replanner, 0, 5, 10, 5, null, null);
+    var x: c_int = 0;
+    var y: c_int = 5;
+    var steps: c_int = 0;
+    while (x != 10 or y != 5) : (steps += 1) {
+        var nx: c_int = undefined;
+        var ny: c_int = undefined;
+        try std.testing.expect(c.step_replanner(path, x, y, &nx, &ny));
+        try std.testing.expectEqual(@as(i32, 10 * (10 - steps)), c.cost_replanner(path));
+        x = nx;
+        y = ny;
+    }
+    try std.testing.expectEqual(@as(c_int, 10), steps);
+}
+
+test "edits on the path notify the unit and are repaired" {
+    var world = fixtures.openWorld(c, 11, 11);
+    defer c.destroy_world(&world);
+
+    const replanner = c.create_replanner(&world);
+    defer c.destroy_replanner(replanner);
+
+    notified = 0;
+    const path = c.open_replanner(replanner, 0, 5, 10, 5, affected, null);
+    var nx: c_int = undefined;
+    var ny: c_int = undefined;
+    try std.testing.expect(c.step_replanner(path, 0, 5, &nx, &ny));
+    try std.testing.expectEqual(@as(i32, 100), c.cost_replanner(path));
+
+    // off the path: nothing to repair
+    c.set_walkable(&world, 5, 0, false);
+    try std.testing.expectEqual(@as(c_int, 0), notified);
+
+    // wall at x = 5 with a gap at y = 10
+    var y: c_int = 1;
+    while (y < 10) : (y += 1) {
+        c.set_walkable(&world, 5, y, false);
+    }
+    try std.testing.expectEqual(@as(c_int, 1), notified);
+    try std.testing.expect(path.*.dirty);
+
+    try std.testing.expect(c.step_replanner(path, 0, 5, &nx, &ny));
+    try std.testing.expectEqual(@as(i32, 200), c.cost_replanner(path));
+    try std.testing.expectEqual(@as(c_int, 0), nx);
+    try std.testing.expectEqual(@as(c_int, 6), ny);
+
+    // closing the gap cuts the goal off
+    c.set_walkable(&world, 5, 10, false);
+    try std.testing.expect(!c.step_replanner(path, 0, 5, &nx, &ny));
+    try std.testing.expectEqual(std.math.maxInt(i32), c.cost_replanner(path));
+}
+
+test "a short path on a large world only keeps the tiles it reached" {
+    var world = fixtures.openWorld(c, 2048, 2048);
+    defer c.destroy_world(&world);
+
+    const replanner = c.create_replanner(&world);
+    defer c.destroy_replanner(replanner);
+
+    const path = c.open_replanner(replanner, 1000, 1000, 1010, 1000, null, null);
+    var nx: c_int = undefined;
+    var ny: c_int = undefined;
+    try std.testing.expect(c.step_replanner(path, 1000, 1000, &nx, &ny));
+    try std.testing.expectEqual(@as(i32, 100), c.cost_replanner(path));
+    try std.testing.expect(path.*.node_count < 1000);
+}
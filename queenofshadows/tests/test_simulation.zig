@@ -0,0 +1,54 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("simulation.h");
+});
+
+test "a click walks the hero to the tile" {
+    const game = c.create_game();
+    const simulation = c.create_simulation(&game);
+    defer c.destroy_simulation(simulation);
+
+    const step: f64 = simulation.*.clock.step;
+    var input = std.mem.zeroes(c.struct_Input);
+    input.click = true;
+    input.target = c.Vector3{ .x = 3, .y = 0, .z = 2 };
+    _ = c.frame_simulation(simulation, &input, step);
+    c.wait_pathfinder(simulation.*.pathfinder);
+
+    // ten seconds is plenty
+    input = std.mem.zeroes(c.struct_Input);
+    var frame: c_int = 0;
+    while (frame < 600) : (frame += 1) {
+        try std.testing.expectEqual(@as(c_int, 1), c.frame_simulation(simulation, &input, step));
+        if (frame > 0 and !simulation.*.hero.is_moving) break;
+    }
+
+    try std.testing.expect(!simulation.*.hero.is_moving);
+    try std.testing.expect(@abs(simulation.*.hero.position.x - 3) < 0.05);
+    try std.testing.expect(@abs(simulation.*.hero.position.z - 2) < 0.05);
+}
+
+test "frames are drawn between the last two steps" {
+    const game = c.create_game();
+    const simulation = c.create_simulation(&game);
+    defer c.destroy_simulation(simulation);
+
+    const step: f64 = simulation.*.clock.step;
+    var input = std.mem.zeroes(c.struct_Input);
+    input.click = true;
+    input.running = true;
+    input.target = c.Vector3{ .x = 4, .y = 0, .z = 0 };
+    _ = c.frame_simulation(simulation, &input, step);
+    c.wait_pathfinder(simulation.*.pathfinder);
+
+    input = std.mem.zeroes(c.struct_Input);
+    _ = c.frame_simulation(simulation, &input, step);
+    _ = c.frame_simulation(simulation, &input, step);
+    // half a step: nothing runs, the hero is shown half way
+    try std.testing.expectEqual(@as(c_int, 0), c.frame_simulation(simulation, &input, step / 2));
+
+    const before = simulation.*.previous_hero.x;
+    const after = simulation.*.hero.position.x;
+    try std.testing.expect(after > before);
+    try std.testing.expectApproxEqAbs((before + after) / 2, c.hero_simulation(simulation).x, 1e-4);
+}
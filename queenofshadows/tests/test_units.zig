@@ -0,0 +1,65 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("units.h");
+});
+
+fn expectSameAsHero(units: *c.struct_Units, unit: c_int, hero: c.struct_Hero) !void {
+    const got = c.get_units(units, unit);
+    try std.testing.expectEqual(hero.position.x, got.position.x);
+    try std.testing.expectEqual(hero.position.z, got.position.z);
+    try std.testing.expectEqual(hero.speed, got.speed);
+    try std.testing.expectEqual(hero.is_moving, got.is_moving);
+}
+
+test "every kernel moves a unit as update_hero does" {
+    const kernels = [_]c_uint{ c.UNITS_SCALAR, c.UNITS_SSE, c.UNITS_AVX };
+    for (kernels) |kernel| {
+        if (!c.supported_units(kernel)) continue;
+
+        var units = c.create_units();
+        defer c.destroy_units(&units);
+
+        // 13 units: full SIMD lanes and a scalar tail
+        var heroes: [13]c.struct_Hero = undefined;
+        for (&heroes, 0..) |*hero, i| {
+            const at = c.Vector3{ .x = @floatFromInt(i), .y = 0, .z = 0 };
+            hero.* = c.create_hero(at);
+            _ = c.add_units(&units, at);
+            // every third one stands still
+            if (i % 3 != 0) {
+                const to = c.Vector3{ .x = @floatFromInt(i * 2), .y = 0, .z = 3.5 };
+                c.move_hero(hero, to, i % 2 == 0);
+                c.move_units(&units, @intCast(i), to, i % 2 == 0);
+            }
+        }
+
+        var frame: c_int = 0;
+        while (frame < 1000) : (frame += 1) {
+            for (&heroes) |*hero| c.update_hero(hero, 1.0 / 60.0);
+            c.update_units_with(&units, kernel, 1.0 / 60.0);
+        }
+
+        for (heroes, 0..) |hero, i| {
+            try expectSameAsHero(&units, @intCast(i), hero);
+            // all of them made it by now
+            try std.testing.expect(!hero.is_moving);
+        }
+    }
+}
+
+test "running units slow down to walk before stopping" {
+    var units = c.create_units();
+    defer c.destroy_units(&units);
+
+    const unit = c.add_units(&units, c.Vector3{ .x = 0, .y = 0, .z = 0 });
+    c.move_units(&units, unit, c.Vector3{ .x = 1, .y = 0, .z = 0 }, true);
+    try std.testing.expect(c.moving_units(&units, unit));
+
+    var slowed = false;
+    while (c.moving_units(&units, unit)) {
+        c.update_units(&units, 1.0 / 30.0);
+        if (units.speed[@intCast(unit)] == c.WALKING_SPEED) slowed = true;
+    }
+    try std.testing.expect(slowed);
+    try std.testing.expect(@abs(c.position_units(&units, unit).x - 1) < 0.05);
+}
@@ -0,0 +1,31 @@
+#include "../raykit.h"
+#include "raylib.h"
+
+#include <stddef.h>
+
+// Top zones for the debug overlays, averaged so a single spike does not flicker
+int record_profiler(struct RenderList *list, int x, int y, int size, Color color)
+{
+    struct ProfileTotal totals[PROFILE_TOP_ZONES];
+    int count = top_profiler(totals, PROFILE_TOP_ZONES);
+
+    const struct ProfileFrame *frame = last_profiler();
+    if (frame != NULL)
+    {
+        record_text(list, TextFormat("Frame %ld: %.2f ms, %d zones (%d dropped)", frame->number,
+                                     frame->seconds * 1000.0, frame->count, frame->dropped),
+                    x, y, size, color);
+        y += size + size / 2;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        record_text(list,
+                    TextFormat("%s: %.3f ms, %.1f calls per frame", totals[i].name, totals[i].seconds * 1000.0,
+                               totals[i].calls),
+                    x, y, size, color);
+        y += size + size / 2;
+    }
+
+    return y;
+}
@@ -0,0 +1,264 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../raykit.h"
+#include "raylib.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// where a zone of this thread's stack was recorded, frame -1 when dropped
+struct OpenZone
+{
+    long frame;
+    int zone;
+};
+
+static struct ProfileFrame frames[PROFILE_FRAMES];
+// number of the open frame, in frames[current % PROFILE_FRAMES]
+static long current = 0;
+static double origin = -1.0;
+// zones come from the path workers too; held for a few stores at a time
+static atomic_flag lock = ATOMIC_FLAG_INIT;
+static atomic_int threads = 0;
+
+static _Thread_local int thread = -1;
+static _Thread_local struct OpenZone stack[PROFILE_MAX_DEPTH];
+static _Thread_local int depth = 0;
+
+static void acquire()
+{
+    while (atomic_flag_test_and_set_explicit(&lock, memory_order_acquire))
+        ;
+}
+
+static void release()
+{
+    atomic_flag_clear_explicit(&lock, memory_order_release);
+}
+
+// Seconds since the first call, under the lock
+static double now()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    double seconds = (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+    if (origin < 0.0)
+        origin = seconds;
+
+    return seconds - origin;
+}
+
+void frame_profiler()
+{
+    acquire();
+
+    double at = now();
+    struct ProfileFrame *closed = &frames[current % PROFILE_FRAMES];
+    closed->seconds = at - closed->start;
+
+    current++;
+    struct ProfileFrame *open = &frames[current % PROFILE_FRAMES];
+    open->number = current;
+    open->start = at;
+    open->seconds = 0.0;
+    open->count = 0;
+    open->dropped = 0;
+
+    release();
+}
+
+void begin_profiler(const char *name)
+{
+    if (thread < 0)
+        thread = atomic_fetch_add(&threads, 1);
+
+    acquire();
+
+    double at = now();
+    struct ProfileFrame *open = &frames[current % PROFILE_FRAMES];
+    struct OpenZone zone = {-1, 0};
+
+    if (depth < PROFILE_MAX_DEPTH && open->count < PROFILE_MAX_ZONES)
+    {
+        zone = (struct OpenZone){current, open->count++};
+        open->zones[zone.zone] = (struct ProfileZone){
+            .name = name,
+            .start = at,
+            .seconds = 0.0,
+            .depth = depth,
+            .thread = thread,
+        };
+    }
+    else
+        open->dropped++;
+
+    release();
+
+    // past the deepest level zones still pair up, they are just not kept
+    if (depth < PROFILE_MAX_DEPTH)
+        stack[depth] = zone;
+    depth++;
+}
+
+void end_profiler()
+{
+    if (depth == 0)
+        return;
+
+    depth--;
+    if (depth >= PROFILE_MAX_DEPTH || stack[depth].frame < 0)
+        return;
+
+    acquire();
+
+    double at = now();
+    struct ProfileFrame *frame = &frames[stack[depth].frame % PROFILE_FRAMES];
+    // zones longer than the ring are lost with their frame
+    if (frame->number == stack[depth].frame)
+    {
+        struct ProfileZone *zone = &frame->zones[stack[depth].zone];
+        zone->seconds = at - zone->start;
+    }
+
+    release();
+}
+
+void end_scope_profiler(const char **scope)
+{
+    (void)scope;
+    end_profiler();
+}
+
+const struct ProfileFrame *last_profiler()
+{
+    if (current == 0)
+        return NULL;
+
+    return &frames[(current - 1) % PROFILE_FRAMES];
+}
+
+static int compare_totals(const void *a, const void *b)
+{
+    const struct ProfileTotal *left = a;
+    const struct ProfileTotal *right = b;
+
+    return (left->seconds < right->seconds) - (left->seconds > right->seconds);
+}
+
+int top_profiler(struct ProfileTotal *totals, int max)
+{
+    struct ProfileTotal names[PROFILE_MAX_ZONES];
+    int count = 0;
+
+    // closed frames only, the open one is partial
+    int kept = current < PROFILE_FRAMES ? (int)current : PROFILE_FRAMES - 1;
+    if (kept == 0)
+        return 0;
+
+    acquire();
+
+    for (int i = 1; i <= kept; i++)
+    {
+        const struct ProfileFrame *frame = &frames[(current - i) % PROFILE_FRAMES];
+
+        for (int z = 0; z < frame->count; z++)
+        {
+            const struct ProfileZone *zone = &frame->zones[z];
+
+            int n = 0;
+            while (n < count && names[n].name != zone->name && strcmp(names[n].name, zone->name) != 0)
+                n++;
+            if (n == count)
+            {
+                if (count == PROFILE_MAX_ZONES)
+                    continue;
+                names[count++] = (struct ProfileTotal){zone->name, 0.0, 0.0};
+            }
+
+            names[n].seconds += zone->seconds;
+            names[n].calls += 1.0;
+        }
+    }
+
+    release();
+
+    qsort(names, (size_t)count, sizeof(*names), compare_totals);
+
+    int filled = count < max ? count : max;
+    for (int i = 0; i < filled; i++)
+    {
+        totals[i] = names[i];
+        totals[i].seconds /= kept;
+        totals[i].calls /= kept;
+    }
+
+    return filled;
+}
+
+// JSON string contents, zone names being code identifiers most of the time
+static void write_name(FILE *file, const char *name)
+{
+    for (const char *c = name; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        if ((unsigned char)*c >= 0x20)
+            fputc(*c, file);
+    }
+}
+
+bool export_profiler(const char *path)
+{
+    // a copy, so the workers are not held while writing
+    struct ProfileFrame *copy = malloc(sizeof(frames));
+    if (copy == NULL)
+        return false;
+
+    acquire();
+    memcpy(copy, frames, sizeof(frames));
+    long last = current;
+    release();
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        free(copy);
+        return false;
+    }
+
+    fputs("{\"traceEvents\":[\n", file);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"raykit\"}}", file);
+
+    int kept = last < PROFILE_FRAMES ? (int)last : PROFILE_FRAMES - 1;
+    for (int i = kept; i >= 1; i--)
+    {
+        const struct ProfileFrame *frame = &copy[(last - i) % PROFILE_FRAMES];
+
+        // frames on the first thread's track, its zones nest inside
+        fprintf(file, ",\n{\"name\":\"frame %ld\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0}",
+                frame->number, frame->start * 1e6, frame->seconds * 1e6);
+
+        for (int z = 0; z < frame->count; z++)
+        {
+            const struct ProfileZone *zone = &frame->zones[z];
+
+            fputs(",\n{\"name\":\"", file);
+            write_name(file, zone->name);
+            fprintf(file, "\",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}",
+                    zone->start * 1e6, zone->seconds * 1e6, zone->thread);
+        }
+
+        if (frame->dropped > 0)
+            fprintf(file, ",\n{\"name\":\"%d zones dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":0}",
+                    frame->dropped, (frame->start + frame->seconds) * 1e6);
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    free(copy);
+    return fclose(file) == 0;
+}
@@ -3,20 +3,41 @@
 
 #include "window/renderer.h"
 
+#include <stddef.h>
+
+#define RAYKIT_PROFILE_FILE "profile.json"
+
 int raykit_run(void)
 {
     InitWindow(CONFIG_SCREEN_WIDTH, CONFIG_SCREEN_HEIGHT, CONFIG_TITLE);
     SetTargetFPS(CONFIG_SCREEN_FPS);
 
+    struct RenderList list = create_render_list();
+
     while (!WindowShouldClose())
     {
+        PROFILE_FRAME();
+
+#if CONFIG_ENABLE_PROFILING
+        // the last PROFILE_FRAMES frames, to look at a spike right after it
+        if (IsKeyPressed(KEY_F9) && export_profiler(RAYKIT_PROFILE_FILE))
+            TraceLog(LOG_INFO, "PROFILE: Frames written to %s", RAYKIT_PROFILE_FILE);
+#endif
+
+        reset_render_list(&list);
+        render(&list);
+
         BeginDrawing();
+        ClearBackground(CONFIG_SCREEN_BACKGROUND_COLOR);
 
-        render();
+        PROFILE_BEGIN("flush");
+        flush_render_list(&list, NULL);
+        PROFILE_END();
 
         EndDrawing();
     }
 
+    destroy_render_list(&list);
     CloseWindow();
 
     return 0;
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "raylib.h"
+
+#include <stdint.h>
+
 #define CONFIG_TITLE "Playground - Window"
 #define CONFIG_VERSION "0.1.0"
 
@@ -11,4 +15,204 @@
 #define CONFIG_SCREEN_BACKGROUND_COLOR (Color){15, 15, 15, 255}
 #define CONFIG_SCREEN_FPS 60
 
-int raykit_run();
\ No newline at end of file
+int raykit_run();
+
+// Profiler
+
+#define PROFILE_FRAMES 120
+#define PROFILE_MAX_ZONES 256
+#define PROFILE_MAX_DEPTH 32
+#define PROFILE_TOP_ZONES 8
+
+struct ProfileZone
+{
+    // a string literal, or anything living as long as the program
+    const char *name;
+    // seconds since the profiler started
+    double start;
+    double seconds;
+    // nesting on its thread, 0 for the outermost
+    int depth;
+    // numbered in the order threads first profile, from 0
+    int thread;
+};
+
+struct ProfileFrame
+{
+    long number;
+    double start;
+    double seconds;
+    struct ProfileZone zones[PROFILE_MAX_ZONES];
+    int count;
+    // zones past PROFILE_MAX_ZONES
+    int dropped;
+};
+
+// Zones of one name per frame, averaged over the kept frames
+struct ProfileTotal
+{
+    const char *name;
+    double seconds;
+    double calls;
+};
+
+// Closes the frame and opens the next, once per frame; the last
+// PROFILE_FRAMES frames are kept. Zones from any thread go to the open frame.
+void frame_profiler();
+void begin_profiler(const char *name);
+// Closes the innermost zone of this thread
+void end_profiler();
+// PROFILE_ZONE's cleanup
+void end_scope_profiler(const char **scope);
+// Last closed frame, NULL before the first
+const struct ProfileFrame *last_profiler();
+// Zones with the most time per frame first; returns how many were filled
+int top_profiler(struct ProfileTotal *totals, int max);
+// The kept frames as Chrome trace events, for chrome://tracing or Perfetto
+bool export_profiler(const char *path);
+
+// Scoped zones, nothing at all without CONFIG_ENABLE_PROFILING. PROFILE_ZONE
+// lasts until the end of the enclosing block, PROFILE_BEGIN until PROFILE_END.
+#if CONFIG_ENABLE_PROFILING
+#define PROFILE_JOIN(a, b) a##b
+#define PROFILE_NAME(line) PROFILE_JOIN(profile_zone_, line)
+#define PROFILE_ZONE(name) \
+    __attribute__((cleanup(end_scope_profiler))) const char *PROFILE_NAME(__LINE__) = (begin_profiler(name), name)
+#define PROFILE_BEGIN(name) begin_profiler(name)
+#define PROFILE_END() end_profiler()
+#define PROFILE_FRAME() frame_profiler()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_BEGIN(name)
+#define PROFILE_END()
+#define PROFILE_FRAME()
+#endif
+
+// Instancing
+
+// Material drawing copies of a mesh in one DrawMeshInstanced call, or with
+// one DrawMesh per copy where instancing is off or unsupported
+struct Instancing
+{
+    Material material;
+    bool instanced;
+};
+
+// With a window; instanced false forces the per copy fallback
+struct Instancing create_instancing(Color color, bool instanced);
+void destroy_instancing(struct Instancing *instancing);
+// Inside BeginMode3D
+void draw_instanced(const Mesh *mesh, const struct Instancing *instancing, const Matrix *transforms, int count);
+
+// Render command list
+
+// Drawn in this order: the world inside BeginMode3D, then the screen on top
+enum RenderLayer
+{
+    RENDER_WORLD = 0,
+    RENDER_SCREEN = 1,
+};
+
+// Same primitive and material in a row share a batch. Meshes come first so
+// the cubes and lines drawn after them are not cut by the mesh draw calls.
+enum RenderPrimitive
+{
+    RENDER_MESH = 0,
+    RENDER_INSTANCES,
+    RENDER_CUBE,
+    RENDER_CUBE_WIRES,
+    RENDER_SPHERE,
+    RENDER_LINE,
+    RENDER_GRID,
+    RENDER_RECTANGLE,
+    RENDER_TEXT,
+    RENDER_FPS,
+};
+
+struct RenderCommand
+{
+    // layer, primitive, shader, texture, then recording order
+    uint64_t key;
+    enum RenderLayer layer;
+    enum RenderPrimitive primitive;
+    Color color;
+    // where, screen pixels in x and y on the screen layer
+    Vector3 position;
+    // cube size, sphere radius in x, line end, grid slices and spacing,
+    // rectangle width and height, font size in x
+    Vector3 size;
+    // meshes only, both kept alive by the caller until the flush
+    const Mesh *mesh;
+    const Material *material;
+    Matrix transform;
+    // instances only, copies of mesh at RenderList.transforms[transforms..]
+    const struct Instancing *instancing;
+    int transforms;
+    int instances;
+    // text only, offset in RenderList.text
+    int text;
+};
+
+struct RenderStats
+{
+    int commands;
+    // runs of commands drawn with the same state after sorting; raylib
+    // batches immediate calls, so a run of them is one draw call
+    int batches;
+    // batches, plus one per mesh past the first of its batch, and one per
+    // instance drawn without instancing
+    int draw_calls;
+    // the same for the commands in recording order
+    int unsorted_draw_calls;
+    // shader or texture switches between batches
+    int state_changes;
+};
+
+// Draw commands recorded in any order, then sorted so equal state is
+// adjacent and flushed in batches. Recording calls no raylib function, so a
+// list can be filled away from the window thread and handed over to flush.
+struct RenderList
+{
+    struct RenderCommand *commands;
+    int count;
+    int capacity;
+    // command keys, sorted; the low 32 bits are the command index
+    uint64_t *order;
+    // recorded strings, NUL terminated
+    char *text;
+    int text_size;
+    int text_capacity;
+    // recorded instance transforms
+    Matrix *transforms;
+    int transforms_count;
+    int transforms_capacity;
+    bool sorted;
+    struct RenderStats stats;
+};
+
+struct RenderList create_render_list();
+void destroy_render_list(struct RenderList *list);
+// Drops the commands, keeps the memory for the next frame
+void reset_render_list(struct RenderList *list);
+
+void record_cube(struct RenderList *list, Vector3 position, Vector3 size, Color color);
+void record_cube_wires(struct RenderList *list, Vector3 position, Vector3 size, Color color);
+void record_sphere(struct RenderList *list, Vector3 center, float radius, Color color);
+void record_line(struct RenderList *list, Vector3 start, Vector3 end, Color color);
+void record_grid(struct RenderList *list, int slices, float spacing);
+void record_mesh(struct RenderList *list, const Mesh *mesh, const Material *material, Matrix transform);
+// transforms are copied, the mesh and instancing are kept alive by the caller
+void record_instances(struct RenderList *list, const Mesh *mesh, const struct Instancing *instancing,
+                      const Matrix *transforms, int count);
+void record_rectangle(struct RenderList *list, int x, int y, int width, int height, Color color);
+void record_text(struct RenderList *list, const char *text, int x, int y, int size, Color color);
+void record_fps(struct RenderList *list, int x, int y);
+
+// The top zones, a line each from y down; returns the y after them
+int record_profiler(struct RenderList *list, int x, int y, int size, Color color);
+
+// Sorts the commands and counts batches, no window needed
+void sort_render_list(struct RenderList *list);
+// Sorts if needed and draws, inside BeginDrawing. The world layer is drawn
+// with camera, or as is when camera is NULL and the caller is in 3D mode.
+void flush_render_list(struct RenderList *list, const Camera3D *camera);
@@ -0,0 +1,360 @@
+#include "../raykit.h"
+#include "raylib.h"
+#include "raymath.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RENDER_INITIAL_COMMANDS 256
+#define RENDER_INITIAL_TEXT 1024
+#define RENDER_INITIAL_TRANSFORMS 256
+
+// key fields, from the most significant bits
+#define RENDER_KEY_LAYER_SHIFT 62
+#define RENDER_KEY_PRIMITIVE_SHIFT 58
+#define RENDER_KEY_SHADER_SHIFT 48
+#define RENDER_KEY_SHADER_MASK 0x3ffu
+#define RENDER_KEY_TEXTURE_SHIFT 32
+#define RENDER_KEY_TEXTURE_MASK 0xffffu
+#define RENDER_KEY_STATE(key) ((key) >> RENDER_KEY_TEXTURE_SHIFT)
+#define RENDER_KEY_MATERIAL(key) ((key) & 0x03ffffff00000000u)
+#define RENDER_KEY_INDEX(key) ((int)((key) & 0xffffffffu))
+
+struct RenderList create_render_list()
+{
+    return (struct RenderList){0};
+}
+
+void destroy_render_list(struct RenderList *list)
+{
+    free(list->commands);
+    free(list->order);
+    free(list->text);
+    free(list->transforms);
+    *list = (struct RenderList){0};
+}
+
+void reset_render_list(struct RenderList *list)
+{
+    list->count = 0;
+    list->text_size = 0;
+    list->transforms_count = 0;
+    list->sorted = false;
+}
+
+// Shader and texture ids past the mask share a key: they only batch worse
+static uint64_t key_command(const struct RenderCommand *command, int index)
+{
+    unsigned int shader = 0;
+    unsigned int texture = 0;
+
+    // immediate primitives all go through raylib's default shader
+    if (command->material != NULL)
+    {
+        shader = command->material->shader.id & RENDER_KEY_SHADER_MASK;
+        texture = command->material->maps[MATERIAL_MAP_DIFFUSE].texture.id & RENDER_KEY_TEXTURE_MASK;
+    }
+
+    return (uint64_t)command->layer << RENDER_KEY_LAYER_SHIFT |
+           (uint64_t)command->primitive << RENDER_KEY_PRIMITIVE_SHIFT |
+           (uint64_t)shader << RENDER_KEY_SHADER_SHIFT |
+           (uint64_t)texture << RENDER_KEY_TEXTURE_SHIFT |
+           (uint32_t)index;
+}
+
+static struct RenderCommand *add_command(struct RenderList *list, enum RenderLayer layer, enum RenderPrimitive primitive)
+{
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : RENDER_INITIAL_COMMANDS;
+
+        struct RenderCommand *commands = realloc(list->commands, (size_t)capacity * sizeof(*commands));
+        uint64_t *order = realloc(list->order, (size_t)capacity * sizeof(*order));
+        if (commands == NULL || order == NULL)
+            TraceLog(LOG_FATAL, "RENDER: Failure to allocate %d commands", capacity);
+
+        list->commands = commands;
+        list->order = order;
+        list->capacity = capacity;
+    }
+
+    struct RenderCommand *command = &list->commands[list->count++];
+    *command = (struct RenderCommand){
+        .layer = layer,
+        .primitive = primitive,
+        .transform = MatrixIdentity(),
+    };
+    list->sorted = false;
+
+    return command;
+}
+
+static int add_text(struct RenderList *list, const char *text)
+{
+    int length = (int)strlen(text) + 1;
+
+    if (list->text_size + length > list->text_capacity)
+    {
+        int capacity = list->text_capacity ? list->text_capacity : RENDER_INITIAL_TEXT;
+        while (list->text_size + length > capacity)
+            capacity *= 2;
+
+        char *grown = realloc(list->text, (size_t)capacity);
+        if (grown == NULL)
+            TraceLog(LOG_FATAL, "RENDER: Failure to allocate %d bytes of text", capacity);
+
+        list->text = grown;
+        list->text_capacity = capacity;
+    }
+
+    int offset = list->text_size;
+    memcpy(list->text + offset, text, (size_t)length);
+    list->text_size += length;
+
+    return offset;
+}
+
+static int add_transforms(struct RenderList *list, const Matrix *transforms, int count)
+{
+    if (list->transforms_count + count > list->transforms_capacity)
+    {
+        int capacity = list->transforms_capacity ? list->transforms_capacity : RENDER_INITIAL_TRANSFORMS;
+        while (list->transforms_count + count > capacity)
+            capacity *= 2;
+
+        Matrix *grown = realloc(list->transforms, (size_t)capacity * sizeof(*grown));
+        if (grown == NULL)
+            TraceLog(LOG_FATAL, "RENDER: Failure to allocate %d transforms", capacity);
+
+        list->transforms = grown;
+        list->transforms_capacity = capacity;
+    }
+
+    int offset = list->transforms_count;
+    memcpy(list->transforms + offset, transforms, (size_t)count * sizeof(*transforms));
+    list->transforms_count += count;
+
+    return offset;
+}
+
+void record_cube(struct RenderList *list, Vector3 position, Vector3 size, Color color)
+{
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_CUBE);
+    command->position = position;
+    command->size = size;
+    command->color = color;
+}
+
+void record_cube_wires(struct RenderList *list, Vector3 position, Vector3 size, Color color)
+{
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_CUBE_WIRES);
+    command->position = position;
+    command->size = size;
+    command->color = color;
+}
+
+void record_sphere(struct RenderList *list, Vector3 center, float radius, Color color)
+{
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_SPHERE);
+    command->position = center;
+    command->size = (Vector3){radius, radius, radius};
+    command->color = color;
+}
+
+void record_line(struct RenderList *list, Vector3 start, Vector3 end, Color color)
+{
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_LINE);
+    command->position = start;
+    command->size = end;
+    command->color = color;
+}
+
+void record_grid(struct RenderList *list, int slices, float spacing)
+{
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_GRID);
+    command->size = (Vector3){(float)slices, spacing, 0.0f};
+}
+
+void record_mesh(struct RenderList *list, const Mesh *mesh, const Material *material, Matrix transform)
+{
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_MESH);
+    command->mesh = mesh;
+    command->material = material;
+    command->transform = transform;
+}
+
+void record_instances(struct RenderList *list, const Mesh *mesh, const struct Instancing *instancing,
+                      const Matrix *transforms, int count)
+{
+    if (count <= 0)
+        return;
+
+    int offset = add_transforms(list, transforms, count);
+
+    struct RenderCommand *command = add_command(list, RENDER_WORLD, RENDER_INSTANCES);
+    command->mesh = mesh;
+    command->material = &instancing->material;
+    command->instancing = instancing;
+    command->transforms = offset;
+    command->instances = count;
+}
+
+void record_rectangle(struct RenderList *list, int x, int y, int width, int height, Color color)
+{
+    struct RenderCommand *command = add_command(list, RENDER_SCREEN, RENDER_RECTANGLE);
+    command->position = (Vector3){(float)x, (float)y, 0.0f};
+    command->size = (Vector3){(float)width, (float)height, 0.0f};
+    command->color = color;
+}
+
+void record_text(struct RenderList *list, const char *text, int x, int y, int size, Color color)
+{
+    int offset = add_text(list, text);
+
+    struct RenderCommand *command = add_command(list, RENDER_SCREEN, RENDER_TEXT);
+    command->position = (Vector3){(float)x, (float)y, 0.0f};
+    command->size = (Vector3){(float)size, 0.0f, 0.0f};
+    command->color = color;
+    command->text = offset;
+}
+
+void record_fps(struct RenderList *list, int x, int y)
+{
+    struct RenderCommand *command = add_command(list, RENDER_SCREEN, RENDER_FPS);
+    command->position = (Vector3){(float)x, (float)y, 0.0f};
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    uint64_t left = *(const uint64_t *)a;
+    uint64_t right = *(const uint64_t *)b;
+
+    return (left > right) - (left < right);
+}
+
+// Draw calls of a command on its own; raylib merges immediate ones
+static int draw_calls(const struct RenderCommand *command)
+{
+    switch (command->primitive)
+    {
+    case RENDER_MESH:
+        return 1;
+    case RENDER_INSTANCES:
+        return command->instancing->instanced ? 1 : command->instances;
+    default:
+        return 0;
+    }
+}
+
+// Counts batches over keys in drawing order
+static void count_batches(const struct RenderList *list, const uint64_t *keys, struct RenderStats *stats)
+{
+    stats->batches = 0;
+    stats->draw_calls = 0;
+    stats->state_changes = 0;
+
+    for (int i = 0; i < list->count; i++)
+    {
+        int calls = draw_calls(&list->commands[RENDER_KEY_INDEX(keys[i])]);
+
+        if (i == 0 || RENDER_KEY_STATE(keys[i]) != RENDER_KEY_STATE(keys[i - 1]))
+        {
+            stats->batches++;
+            stats->draw_calls += calls ? calls : 1;
+            if (i > 0 && RENDER_KEY_MATERIAL(keys[i]) != RENDER_KEY_MATERIAL(keys[i - 1]))
+                stats->state_changes++;
+        }
+        else
+            stats->draw_calls += calls;
+    }
+}
+
+void sort_render_list(struct RenderList *list)
+{
+    for (int i = 0; i < list->count; i++)
+    {
+        list->commands[i].key = key_command(&list->commands[i], i);
+        list->order[i] = list->commands[i].key;
+    }
+
+    // recording order first, to compare with
+    struct RenderStats unsorted = {0};
+    count_batches(list, list->order, &unsorted);
+
+    // the index in the low bits keeps equal state in recording order
+    qsort(list->order, (size_t)list->count, sizeof(*list->order), compare_keys);
+
+    count_batches(list, list->order, &list->stats);
+    list->stats.commands = list->count;
+    list->stats.unsorted_draw_calls = unsorted.draw_calls;
+    list->sorted = true;
+}
+
+static void draw_command(const struct RenderList *list, const struct RenderCommand *command)
+{
+    switch (command->primitive)
+    {
+    case RENDER_MESH:
+        DrawMesh(*command->mesh, *command->material, command->transform);
+        break;
+    case RENDER_INSTANCES:
+        draw_instanced(command->mesh, command->instancing, list->transforms + command->transforms, command->instances);
+        break;
+    case RENDER_CUBE:
+        DrawCubeV(command->position, command->size, command->color);
+        break;
+    case RENDER_CUBE_WIRES:
+        DrawCubeWiresV(command->position, command->size, command->color);
+        break;
+    case RENDER_SPHERE:
+        DrawSphere(command->position, command->size.x, command->color);
+        break;
+    case RENDER_LINE:
+        DrawLine3D(command->position, command->size, command->color);
+        break;
+    case RENDER_GRID:
+        DrawGrid((int)command->size.x, command->size.y);
+        break;
+    case RENDER_RECTANGLE:
+        DrawRectangle((int)command->position.x, (int)command->position.y, (int)command->size.x, (int)command->size.y,
+                      command->color);
+        break;
+    case RENDER_TEXT:
+        DrawText(list->text + command->text, (int)command->position.x, (int)command->position.y, (int)command->size.x,
+                 command->color);
+        break;
+    case RENDER_FPS:
+        DrawFPS((int)command->position.x, (int)command->position.y);
+        break;
+    }
+}
+
+void flush_render_list(struct RenderList *list, const Camera3D *camera)
+{
+    bool world = false;
+
+    if (!list->sorted)
+        sort_render_list(list);
+
+    for (int i = 0; i < list->count; i++)
+    {
+        const struct RenderCommand *command = &list->commands[RENDER_KEY_INDEX(list->order[i])];
+
+        // the world layer sorts first: one 3D mode for all of it
+        if (camera != NULL && command->layer == RENDER_WORLD && !world)
+        {
+            BeginMode3D(*camera);
+            world = true;
+        }
+        else if (world && command->layer != RENDER_WORLD)
+        {
+            EndMode3D();
+            world = false;
+        }
+
+        draw_command(list, command);
+    }
+
+    if (world)
+        EndMode3D();
+}
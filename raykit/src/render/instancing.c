@@ -0,0 +1,86 @@
+#include "../raykit.h"
+#include "raylib.h"
+#include "rlgl.h"
+
+// raylib passes the view and projection as mvp when instancing, the model
+// comes from the per instance attribute
+static const char *INSTANCING_VERTEX_SHADER =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in vec2 vertexTexCoord;\n"
+    "in vec4 vertexColor;\n"
+    "in mat4 instanceTransform;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 fragTexCoord;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fragTexCoord = vertexTexCoord;\n"
+    "    fragColor = vertexColor;\n"
+    "    gl_Position = mvp * instanceTransform * vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+static const char *INSTANCING_FRAGMENT_SHADER =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(texture0, fragTexCoord) * colDiffuse * fragColor;\n"
+    "}\n";
+
+struct Instancing create_instancing(Color color, bool instanced)
+{
+    struct Instancing instancing = {
+        .material = LoadMaterialDefault(),
+        .instanced = false,
+    };
+    instancing.material.maps[MATERIAL_MAP_DIFFUSE].color = color;
+
+    // the shaders above need desktop OpenGL 3.3
+    int version = rlGetVersion();
+    if (!instanced || (version != RL_OPENGL_33 && version != RL_OPENGL_43))
+        return instancing;
+
+    Shader shader = LoadShaderFromMemory(INSTANCING_VERTEX_SHADER, INSTANCING_FRAGMENT_SHADER);
+    // raylib hands back its default shader when these do not compile
+    if (shader.id == rlGetShaderIdDefault())
+    {
+        TraceLog(LOG_WARNING, "RENDER: Instancing shader unavailable, drawing one mesh per instance");
+        return instancing;
+    }
+
+    shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(shader, "mvp");
+    shader.locs[SHADER_LOC_COLOR_DIFFUSE] = GetShaderLocation(shader, "colDiffuse");
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+
+    instancing.material.shader = shader;
+    instancing.instanced = true;
+
+    return instancing;
+}
+
+void destroy_instancing(struct Instancing *instancing)
+{
+    // the default shader and texture are left alone
+    UnloadMaterial(instancing->material);
+    *instancing = (struct Instancing){0};
+}
+
+void draw_instanced(const Mesh *mesh, const struct Instancing *instancing, const Matrix *transforms, int count)
+{
+    if (count <= 0)
+        return;
+
+    if (instancing->instanced)
+    {
+        DrawMeshInstanced(*mesh, instancing->material, transforms, count);
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+        DrawMesh(*mesh, instancing->material, transforms[i]);
+}
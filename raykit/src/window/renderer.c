@@ -7,30 +7,36 @@
 #define RENDER_DEBUG_TABLE_Y 36
 #define RENDER_DEBUG_TABLE_GAP 5
 
-void render_debug_text(const char *str, const int x, int *y)
+void render_debug_text(struct RenderList *list, const char *str, const int x, int *y)
 {
-    DrawText(str, x, *y, RENDER_DEBUG_FONT_SIZE, RENDER_DEBUG_FONT_COLOR);
+    record_text(list, str, x, *y, RENDER_DEBUG_FONT_SIZE, RENDER_DEBUG_FONT_COLOR);
     *y += (RENDER_DEBUG_FONT_SIZE + RENDER_DEBUG_TABLE_GAP);
 }
 
-void render_debug()
+void render_debug(struct RenderList *list)
 {
     int x = RENDER_DEBUG_TABLE_X;
     int y = RENDER_DEBUG_TABLE_Y;
 
-    DrawFPS(x, x);
+    record_fps(list, x, x);
 
     // Game
-    render_debug_text("--- Game ---", x, &y);
-    render_debug_text(TextFormat("Name: %s", CONFIG_TITLE), x, &y);
-    render_debug_text(TextFormat("Version: %s", CONFIG_VERSION), x, &y);
+    render_debug_text(list, "--- Game ---", x, &y);
+    render_debug_text(list, TextFormat("Name: %s", CONFIG_TITLE), x, &y);
+    render_debug_text(list, TextFormat("Version: %s", CONFIG_VERSION), x, &y);
+
+#if CONFIG_ENABLE_PROFILING
+    // Profiler
+    render_debug_text(list, "--- Profiler ---", x, &y);
+    y = record_profiler(list, x, y, RENDER_DEBUG_FONT_SIZE, RENDER_DEBUG_FONT_COLOR);
+#endif
 }
 
-void render()
+void render(struct RenderList *list)
 {
-    ClearBackground(CONFIG_SCREEN_BACKGROUND_COLOR);
+    PROFILE_ZONE("render");
 
 #ifdef CONFIG_ENABLE_DEBUG
-    render_debug();
+    render_debug(list);
 #endif
 }
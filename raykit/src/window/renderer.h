@@ -1,3 +1,6 @@
 #pragma once
 
-void render();
\ No newline at end of file
+#include "../raykit.h"
+
+// Records the frame, drawn by the caller
+void render(struct RenderList *list);
\ No newline at end of file
@@ -0,0 +1,129 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("raykit.h");
+});
+
+const red = c.Color{ .r = 230, .g = 41, .b = 55, .a = 255 };
+const size = c.Vector3{ .x = 1, .y = 1, .z = 1 };
+
+fn at(i: c_int) c.Vector3 {
+    return c.Vector3{ .x = @floatFromInt(i), .y = 0, .z = 0 };
+}
+
+fn materialWith(shader: c_uint, texture: c_uint, maps: *[1]c.MaterialMap) c.Material {
+    maps[0] = std.mem.zeroes(c.MaterialMap);
+    maps[0].texture.id = texture;
+    var material = std.mem.zeroes(c.Material);
+    material.shader.id = shader;
+    material.maps = maps;
+    return material;
+}
+
+test "interleaved primitives sort into one batch each" {
+    var list = c.create_render_list();
+    defer c.destroy_render_list(&list);
+
+    var i: c_int = 0;
+    while (i < 100) : (i += 1) {
+        c.record_cube(&list, at(i), size, red);
+        c.record_cube_wires(&list, at(i), size, red);
+        c.record_text(&list, "label", i, 0, 10, red);
+    }
+
+    c.sort_render_list(&list);
+    try std.testing.expectEqual(@as(c_int, 300), list.stats.commands);
+    try std.testing.expectEqual(@as(c_int, 300), list.stats.unsorted_draw_calls);
+    try std.testing.expectEqual(@as(c_int, 3), list.stats.batches);
+    try std.testing.expectEqual(@as(c_int, 3), list.stats.draw_calls);
+}
+
+test "the world draws before the screen, equal state in recording order" {
+    var list = c.create_render_list();
+    defer c.destroy_render_list(&list);
+
+    c.record_text(&list, "first", 0, 0, 10, red);
+    c.record_cube(&list, at(1), size, red);
+    c.record_text(&list, "second", 0, 20, 10, red);
+    c.record_cube(&list, at(2), size, red);
+    c.record_grid(&list, 10, 1.0);
+    c.sort_render_list(&list);
+
+    const expected = [_]c_int{ 1, 3, 4, 0, 2 };
+    for (expected, 0..) |command, i| {
+        try std.testing.expectEqual(command, @as(c_int, @intCast(list.order[i] & 0xffffffff)));
+    }
+    try std.testing.expectEqualStrings("second", std.mem.span(@as([*:0]const u8, @ptrCast(list.text + @as(usize, @intCast(list.commands[2].text))))));
+}
+
+test "meshes group by material, one draw call per mesh" {
+    var list = c.create_render_list();
+    defer c.destroy_render_list(&list);
+
+    var stoneMaps: [1]c.MaterialMap = undefined;
+    var grassMaps: [1]c.MaterialMap = undefined;
+    const stone = materialWith(3, 1, &stoneMaps);
+    const grass = materialWith(3, 7, &grassMaps);
+    var mesh = std.mem.zeroes(c.Mesh);
+
+    var i: c_int = 0;
+    while (i < 10) : (i += 1) {
+        c.record_mesh(&list, &mesh, &stone, std.mem.zeroes(c.Matrix));
+        c.record_mesh(&list, &mesh, &grass, std.mem.zeroes(c.Matrix));
+        c.record_cube(&list, at(i), size, red);
+    }
+
+    c.sort_render_list(&list);
+    // stone meshes, grass meshes, cubes
+    try std.testing.expectEqual(@as(c_int, 3), list.stats.batches);
+    try std.testing.expectEqual(@as(c_int, 21), list.stats.draw_calls);
+    try std.testing.expectEqual(@as(c_int, 30), list.stats.unsorted_draw_calls);
+    try std.testing.expectEqual(@as(c_int, 2), list.stats.state_changes);
+}
+
+test "a reset keeps the memory and records again" {
+    var list = c.create_render_list();
+    defer c.destroy_render_list(&list);
+
+    var i: c_int = 0;
+    while (i < 1000) : (i += 1) c.record_sphere(&list, at(i), 0.5, red);
+    c.sort_render_list(&list);
+    const capacity = list.capacity;
+
+    c.reset_render_list(&list);
+    try std.testing.expectEqual(@as(c_int, 0), list.count);
+    try std.testing.expect(!list.sorted);
+
+    c.record_line(&list, at(0), at(1), red);
+    c.sort_render_list(&list);
+    try std.testing.expectEqual(capacity, list.capacity);
+    try std.testing.expectEqual(@as(c_int, 1), list.stats.draw_calls);
+}
+
+test "instances are one draw call, or one per copy without instancing" {
+    var list = c.create_render_list();
+    defer c.destroy_render_list(&list);
+
+    var maps: [1]c.MaterialMap = undefined;
+    var instanced = c.struct_Instancing{ .material = materialWith(4, 1, &maps), .instanced = true };
+    var fallback = c.struct_Instancing{ .material = materialWith(3, 1, &maps), .instanced = false };
+    var mesh = std.mem.zeroes(c.Mesh);
+
+    var transforms: [500]c.Matrix = undefined;
+    for (&transforms, 0..) |*transform, i| {
+        transform.* = std.mem.zeroes(c.Matrix);
+        transform.m12 = @floatFromInt(i);
+    }
+
+    c.record_instances(&list, &mesh, &instanced, &transforms, transforms.len);
+    c.sort_render_list(&list);
+    try std.testing.expectEqual(@as(c_int, 1), list.stats.draw_calls);
+    // copied, the caller can reuse its array
+    try std.testing.expectEqual(@as(f32, 499), list.transforms[499].m12);
+
+    c.reset_render_list(&list);
+    c.record_instances(&list, &mesh, &fallback, &transforms, transforms.len);
+    c.record_instances(&list, &mesh, &instanced, &transforms, 0);
+    c.sort_render_list(&list);
+    try std.testing.expectEqual(@as(c_int, 1), list.count);
+    try std.testing.expectEqual(@as(c_int, 500), list.stats.draw_calls);
+}
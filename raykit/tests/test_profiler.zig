@@ -0,0 +1,74 @@
+const std = @import("std");
+const c = @cImport({
+    @cInclude("raykit.h");
+});
+
+fn spin(microseconds: u64) void {
+    var timer = std.time.Timer.start() catch unreachable;
+    while (timer.read() < microseconds * std.time.ns_per_us) {}
+}
+
+// the profiler is global: a single test runs the frames in order
+test "zones nest, frames close, totals rank and export parses" {
+    c.frame_profiler();
+
+    c.begin_profiler("update");
+    c.begin_profiler("update_hero");
+    spin(200);
+    c.end_profiler();
+    c.begin_profiler("update_camera");
+    spin(50);
+    c.end_profiler();
+    c.end_profiler();
+    // unbalanced ends are ignored
+    c.end_profiler();
+
+    c.frame_profiler();
+    const frame = c.last_profiler();
+    try std.testing.expect(frame != null);
+    try std.testing.expectEqual(@as(c_int, 3), frame.*.count);
+    try std.testing.expectEqual(@as(c_int, 0), frame.*.zones[0].depth);
+    try std.testing.expectEqual(@as(c_int, 1), frame.*.zones[1].depth);
+    try std.testing.expectEqual(@as(c_int, 1), frame.*.zones[2].depth);
+    try std.testing.expect(frame.*.zones[0].seconds >= frame.*.zones[1].seconds + frame.*.zones[2].seconds);
+    try std.testing.expect(frame.*.seconds >= frame.*.zones[0].seconds);
+
+    // a frame too full drops the extra zones, and still pairs them
+    var i: c_int = 0;
+    while (i < c.PROFILE_MAX_ZONES + 10) : (i += 1) {
+        c.begin_profiler("small");
+        c.end_profiler();
+    }
+    c.frame_profiler();
+    try std.testing.expectEqual(@as(c_int, c.PROFILE_MAX_ZONES), c.last_profiler().*.count);
+    try std.testing.expectEqual(@as(c_int, 10), c.last_profiler().*.dropped);
+
+    var totals: [c.PROFILE_TOP_ZONES]c.struct_ProfileTotal = undefined;
+    const count = c.top_profiler(&totals, totals.len);
+    try std.testing.expectEqual(@as(c_int, 4), count);
+    try std.testing.expectEqualStrings("update", std.mem.span(totals[0].name));
+    try std.testing.expectEqualStrings("update_hero", std.mem.span(totals[1].name));
+
+    // more frames than the ring keeps
+    i = 0;
+    while (i < c.PROFILE_FRAMES * 2) : (i += 1) c.frame_profiler();
+    try std.testing.expectEqual(@as(c_int, 0), c.top_profiler(&totals, totals.len));
+
+    c.begin_profiler("quote \"and\" backslash \\");
+    c.end_profiler();
+    c.frame_profiler();
+
+    const path = "test_profiler.json";
+    try std.testing.expect(c.export_profiler(path));
+    defer std.fs.cwd().deleteFile(path) catch {};
+
+    const json = try std.fs.cwd().readFileAlloc(std.testing.allocator, path, 1 << 24);
+    defer std.testing.allocator.free(json);
+    const parsed = try std.json.parseFromSlice(std.json.Value, std.testing.allocator, json, .{});
+    defer parsed.deinit();
+
+    const events = parsed.value.object.get("traceEvents").?.array;
+    // the process name, and a frame event for every kept frame but the one with the zone
+    try std.testing.expectEqual(@as(usize, 1 + c.PROFILE_FRAMES - 1 + 1), events.items.len);
+    try std.testing.expectEqualStrings("quote \"and\" backslash \\", events.items[events.items.len - 1].object.get("name").?.string);
+}
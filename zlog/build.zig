@@ -26,6 +26,9 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
 
+    // The loggers stamp their lines with the temporal DateTime
+    lib_mod.addImport("temporal", temporal_dep.module("ztemporal"));
+
     // We will also create a module for our other entry point, 'main.zig'.
     const exe_mod = b.createModule(.{
         // `root_source_file` is the Zig "entry point" of the module. If a module
@@ -94,6 +97,23 @@ pub fn build(b: *std.Build) void {
     const run_step = b.step("run", "Run the app");
     run_step.dependOn(&run_cmd.step);
 
+    // The throughput benchmark, always optimized: `zig build bench`
+    const bench_mod = b.createModule(.{
+        .root_source_file = b.path("src/bench.zig"),
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    bench_mod.addImport("zlog_lib", lib_mod);
+
+    const bench = b.addExecutable(.{
+        .name = "zlog-bench",
+        .root_module = bench_mod,
+    });
+
+    const run_bench = b.addRunArtifact(bench);
+    const bench_step = b.step("bench", "Run the multithreaded logging benchmark");
+    bench_step.dependOn(&run_bench.step);
+
     // Creates a step for unit testing. This only builds the test executable
     // but does not run it.
     const lib_unit_tests = b.addTest(.{
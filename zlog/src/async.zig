@@ -0,0 +1,191 @@
+const std = @import("std");
+
+const line = @import("line.zig");
+const ring_module = @import("ring.zig");
+
+const Policy = ring_module.Policy;
+const Ring = ring_module.Ring;
+
+/// Logger whose callers only format into their thread's buffer and copy the
+/// line into a lock-free ring. A background thread hands the lines to the
+/// sink and flushes it whenever the ring runs empty, so a burst of lines
+/// costs one write. Sink needs write([]const u8) !void and flush() !void,
+/// and is only used from the background thread.
+pub fn AsyncLogger(comptime Sink: type) type {
+    return struct {
+        const Self = @This();
+
+        pub const Options = struct {
+            /// lines in flight, rounded up to a power of two
+            slots: usize = 4096,
+            policy: Policy = .block,
+            /// lines handed to the sink before the slots are given back
+            batch: usize = 256,
+            /// sleep of the background thread with nothing to write
+            idle_ns: u64 = std.time.ns_per_ms,
+        };
+
+        pub const Stats = struct {
+            written: u64,
+            dropped: u64,
+            // yields of callers waiting for a slot
+            waits: u64,
+            flushes: u64,
+            // failed sink writes and flushes, their lines are lost
+            errors: u64,
+        };
+
+        allocator: std.mem.Allocator,
+        sink: *Sink,
+        options: Options,
+        ring: Ring(line.capacity),
+        thread: std.Thread,
+        running: std.atomic.Value(bool) = std.atomic.Value(bool).init(true),
+        written: std.atomic.Value(u64) = std.atomic.Value(u64).init(0),
+        dropped: std.atomic.Value(u64) = std.atomic.Value(u64).init(0),
+        flushes: std.atomic.Value(u64) = std.atomic.Value(u64).init(0),
+        errors: std.atomic.Value(u64) = std.atomic.Value(u64).init(0),
+
+        /// Starts the background thread; sink must outlive the logger
+        pub fn create(allocator: std.mem.Allocator, sink: *Sink, options: Options) !*Self {
+            const self = try allocator.create(Self);
+            errdefer allocator.destroy(self);
+
+            self.* = Self{
+                .allocator = allocator,
+                .sink = sink,
+                .options = options,
+                .ring = try Ring(line.capacity).init(allocator, options.slots),
+                .thread = undefined,
+            };
+            errdefer self.ring.deinit();
+
+            self.thread = try std.Thread.spawn(.{}, run, .{self});
+            return self;
+        }
+
+        /// Writes every line already logged, flushes the sink and stops.
+        /// The other threads must be done logging.
+        pub fn destroy(self: *Self) void {
+            self.running.store(false, .release);
+            self.thread.join();
+
+            self.ring.deinit();
+            self.allocator.destroy(self);
+        }
+
+        pub fn stats(self: *Self) Stats {
+            return Stats{
+                .written = self.written.load(.monotonic),
+                .dropped = self.dropped.load(.monotonic),
+                .waits = self.ring.waits.load(.monotonic),
+                .flushes = self.flushes.load(.monotonic),
+                .errors = self.errors.load(.monotonic),
+            };
+        }
+
+        fn run(self: *Self) void {
+            var unflushed = false;
+
+            while (true) {
+                var count: usize = 0;
+                while (count < self.options.batch) : (count += 1) {
+                    const text = self.ring.peek(count) orelse break;
+                    self.sink.write(text) catch {
+                        _ = self.errors.fetchAdd(1, .monotonic);
+                    };
+                }
+
+                if (count > 0) {
+                    self.ring.release(count);
+                    _ = self.written.fetchAdd(count, .monotonic);
+                    unflushed = true;
+                    continue;
+                }
+
+                // caught up: what was gathered goes out now
+                if (unflushed) {
+                    self.sink.flush() catch {
+                        _ = self.errors.fetchAdd(1, .monotonic);
+                    };
+                    _ = self.flushes.fetchAdd(1, .monotonic);
+                    unflushed = false;
+                }
+
+                // stopped and drained, looked at again once stopped so a
+                // line logged before destroy is still written
+                if (!self.running.load(.acquire)) {
+                    if (self.ring.peek(0) == null) return;
+                    continue;
+                }
+
+                std.time.sleep(self.options.idle_ns);
+            }
+        }
+
+        /// Never blocks on the sink; under .block it waits for a slot when
+        /// the ring is full, under .drop the line is counted and lost
+        pub fn write(self: *Self, comptime level: []const u8, comptime fmt: []const u8, args: anytype) !void {
+            const text = line.format(level, fmt, args);
+            if (!self.ring.push(text, self.options.policy))
+                _ = self.dropped.fetchAdd(1, .monotonic);
+        }
+
+        pub fn debug(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.debug, fmt, args);
+        }
+
+        pub fn info(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.info, fmt, args);
+        }
+
+        pub fn warn(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.warn, fmt, args);
+        }
+
+        pub fn err(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.err, fmt, args);
+        }
+
+        pub fn fatal(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.fatal, fmt, args);
+        }
+    };
+}
+
+/// Lines kept in memory, for tests
+const MemorySink = struct {
+    lines: std.ArrayList(u8),
+    flushes: usize = 0,
+
+    pub fn write(self: *MemorySink, bytes: []const u8) !void {
+        try self.lines.appendSlice(bytes);
+    }
+
+    pub fn flush(self: *MemorySink) !void {
+        self.flushes += 1;
+    }
+};
+
+fn logMany(logger: *AsyncLogger(MemorySink), count: usize) void {
+    for (0..count) |i| logger.info("message {d}", .{i}) catch unreachable;
+}
+
+test "every line of every thread reaches the sink" {
+    var sink = MemorySink{ .lines = std.ArrayList(u8).init(std.testing.allocator) };
+    defer sink.lines.deinit();
+
+    const logger = try AsyncLogger(MemorySink).create(std.testing.allocator, &sink, .{ .slots = 64 });
+
+    const count = 5000;
+    var threads: [4]std.Thread = undefined;
+    for (&threads) |*thread| thread.* = try std.Thread.spawn(.{}, logMany, .{ logger, @as(usize, count) });
+    for (threads) |thread| thread.join();
+
+    const stats = logger.stats();
+    logger.destroy();
+
+    try std.testing.expectEqual(@as(u64, 0), stats.dropped);
+    try std.testing.expectEqual(@as(usize, 4 * count), std.mem.count(u8, sink.lines.items, "\n"));
+    try std.testing.expect(sink.flushes >= 1);
+}
@@ -0,0 +1,92 @@
+//! Messages per second from 1 to 8 threads logging at once: the mutex
+//! logger writing each line to a file, and the asynchronous logger handing
+//! them to a buffered file sink. The async time runs until the last line
+//! is in the file, not only until the callers return.
+const std = @import("std");
+
+const zlog = @import("zlog_lib");
+
+const messages_per_thread = 100_000;
+const thread_counts = [_]usize{ 1, 2, 4, 8 };
+const directory = "zlog-bench";
+
+const MutexLogger = zlog.GenericLogger(std.fs.File.Writer);
+const AsyncLogger = zlog.AsyncLogger(zlog.FileSink);
+
+fn logMutex(logger: *MutexLogger, thread: usize) void {
+    for (0..messages_per_thread) |i|
+        logger.info("thread {d}: path of {d} nodes, {d} expanded", .{ thread, i % 97, i }) catch return;
+}
+
+fn logAsync(logger: *AsyncLogger, thread: usize) void {
+    for (0..messages_per_thread) |i|
+        logger.info("thread {d}: path of {d} nodes, {d} expanded", .{ thread, i % 97, i }) catch return;
+}
+
+fn perSecond(messages: usize, ns: u64) f64 {
+    return @as(f64, @floatFromInt(messages)) / (@as(f64, @floatFromInt(ns)) / std.time.ns_per_s);
+}
+
+fn runMutex(dir: std.fs.Dir, allocator: std.mem.Allocator, count: usize) !u64 {
+    const file = try dir.createFile("mutex.log", .{});
+    defer file.close();
+    var logger = MutexLogger.init(allocator, file.writer());
+
+    var threads: [thread_counts[thread_counts.len - 1]]std.Thread = undefined;
+    var timer = try std.time.Timer.start();
+    for (threads[0..count], 0..) |*thread, t| thread.* = try std.Thread.spawn(.{}, logMutex, .{ &logger, t });
+    for (threads[0..count]) |thread| thread.join();
+
+    return timer.read();
+}
+
+fn runAsync(dir: std.fs.Dir, allocator: std.mem.Allocator, count: usize, dropped: *u64) !u64 {
+    // rotated every 16 MiB, two kept, so the run does not fill the disk
+    var sink = try zlog.FileSink.init(allocator, dir, "async.log", .{ .max_bytes = 16 * 1024 * 1024, .keep = 2 });
+    defer sink.deinit();
+
+    var threads: [thread_counts[thread_counts.len - 1]]std.Thread = undefined;
+    var timer = try std.time.Timer.start();
+    const logger = try AsyncLogger.create(allocator, &sink, .{ .slots = 16384 });
+    for (threads[0..count], 0..) |*thread, t| thread.* = try std.Thread.spawn(.{}, logAsync, .{ logger, t });
+    for (threads[0..count]) |thread| thread.join();
+
+    dropped.* = logger.stats().dropped;
+    // the last lines written and flushed
+    logger.destroy();
+    try sink.flush();
+
+    return timer.read();
+}
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const stdout = std.io.getStdOut().writer();
+
+    var dir = try std.fs.cwd().makeOpenPath(directory, .{});
+    defer {
+        dir.close();
+        std.fs.cwd().deleteTree(directory) catch {};
+    }
+
+    try stdout.print("{d} messages per thread\n", .{messages_per_thread});
+    try stdout.print("{s:>7} {s:>14} {s:>14} {s:>8}\n", .{ "threads", "mutex msg/s", "async msg/s", "dropped" });
+
+    for (thread_counts) |count| {
+        const messages = count * messages_per_thread;
+        var dropped: u64 = 0;
+
+        const mutex_ns = try runMutex(dir, allocator, count);
+        const async_ns = try runAsync(dir, allocator, count, &dropped);
+
+        try stdout.print("{d:>7} {d:>14.0} {d:>14.0} {d:>8}\n", .{
+            count,
+            perSecond(messages, mutex_ns),
+            perSecond(messages, async_ns),
+            dropped,
+        });
+    }
+}
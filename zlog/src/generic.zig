@@ -0,0 +1,66 @@
+const std = @import("std");
+
+const line = @import("line.zig");
+
+const Allocator = std.mem.Allocator;
+
+pub fn GenericLogger(comptime WriterType: type) type {
+    return struct {
+        // lines are built in per thread buffers now, kept for callers
+        allocator: Allocator,
+        writer: WriterType,
+        mutex: std.Thread.Mutex = .{},
+
+        const Self = @This();
+
+        pub fn init(allocator: Allocator, writer: WriterType) Self {
+            return Self{
+                .allocator = allocator,
+                .writer = writer,
+            };
+        }
+
+        pub fn write(self: *Self, comptime level: []const u8, comptime fmt: []const u8, args: anytype) !void {
+            // formatted outside the lock, only the write itself is serialized
+            const text = line.format(level, fmt, args);
+
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            // Write directly to the stored writer
+            try self.writer.writeAll(text);
+        }
+
+        pub fn debug(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.debug, fmt, args);
+        }
+
+        pub fn info(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.info, fmt, args);
+        }
+
+        pub fn warn(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.warn, fmt, args);
+        }
+
+        pub fn err(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.err, fmt, args);
+        }
+
+        pub fn fatal(self: *Self, comptime fmt: []const u8, args: anytype) !void {
+            try self.write(line.Level.fatal, fmt, args);
+        }
+    };
+}
+
+test "lines of a buffer logger" {
+    var buffer = std.ArrayList(u8).init(std.testing.allocator);
+    defer buffer.deinit();
+
+    var logger = GenericLogger(std.ArrayList(u8).Writer).init(std.testing.allocator, buffer.writer());
+    try logger.info("Hello {s}", .{"World"});
+    try logger.err("twice", .{});
+
+    try std.testing.expectEqual(@as(usize, 2), std.mem.count(u8, buffer.items, "\n"));
+    try std.testing.expect(std.mem.indexOf(u8, buffer.items, "\tHello World\n") != null);
+}
@@ -0,0 +1,55 @@
+const std = @import("std");
+
+const temporal = @import("temporal");
+
+/// Longest line a logger writes, longer messages are cut
+pub const capacity = 1024;
+
+/// Levels as printed
+pub const Level = struct {
+    pub const debug = "\x1b[4mDEBUG\x1b[0m";
+    pub const info = "\x1b[32mINFO\x1b[0m";
+    pub const warn = "\x1b[33mWARN\x1b[0m";
+    pub const err = "\x1b[31mERROR\x1b[0m";
+    pub const fatal = "\x1b[35mFATAL\x1b[0m";
+};
+
+// Per thread: the line being built, and the text of the last time so only
+// the digits that changed are written again
+threadlocal var buffer: [capacity]u8 = undefined;
+threadlocal var stamp: temporal.Formatter = .{};
+
+fn timestamp() []const u8 {
+    return stamp.format(std.time.milliTimestamp());
+}
+
+/// Builds "time\tlevel\tmessage\n" in this thread's buffer, without
+/// allocating. The line is valid until the thread formats the next one.
+pub fn format(comptime level: []const u8, comptime fmt: []const u8, args: anytype) []const u8 {
+    // one byte kept for the new line, a long message is cut before it
+    var stream = std.io.fixedBufferStream(buffer[0 .. capacity - 1]);
+    const w = stream.writer();
+
+    w.writeAll(timestamp()) catch {};
+    w.writeAll("\t" ++ level ++ "\t") catch {};
+    w.print(fmt, args) catch {};
+
+    const length = stream.getWritten().len;
+    buffer[length] = '\n';
+    return buffer[0 .. length + 1];
+}
+
+test "a line is time, level and message" {
+    const text = format(Level.info, "path of {d} nodes", .{42});
+
+    try std.testing.expectEqual(@as(usize, 23), std.mem.indexOfScalar(u8, text, '\t').?);
+    try std.testing.expect(std.mem.endsWith(u8, text, "\t" ++ Level.info ++ "\tpath of 42 nodes\n"));
+}
+
+test "a long message is cut, the line still ends" {
+    const long = [_]u8{'a'} ** (2 * capacity);
+    const text = format(Level.warn, "{s}", .{long[0..]});
+
+    try std.testing.expectEqual(@as(usize, capacity), text.len);
+    try std.testing.expectEqual(@as(u8, '\n'), text[text.len - 1]);
+}
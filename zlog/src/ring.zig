@@ -0,0 +1,161 @@
+const std = @import("std");
+
+/// What a push does when every slot is taken
+pub const Policy = enum {
+    /// the writer yields until the reader frees a slot
+    block,
+    /// the line is lost, the writer never waits
+    drop,
+};
+
+/// Bounded queue of lines for any number of writers and one reader, without
+/// locks (Dmitry Vyukov's bounded queue). A slot's sequence tells whose turn
+/// it is: its position for a writer, position + 1 for the reader.
+pub fn Ring(comptime line_capacity: usize) type {
+    return struct {
+        const Self = @This();
+
+        const Slot = struct {
+            sequence: std.atomic.Value(usize),
+            length: usize,
+            bytes: [line_capacity]u8,
+        };
+
+        allocator: std.mem.Allocator,
+        slots: []Slot,
+        mask: usize,
+        // next position for a writer
+        head: std.atomic.Value(usize) align(std.atomic.cache_line) = std.atomic.Value(usize).init(0),
+        // next position to read, the reader's alone
+        tail: usize align(std.atomic.cache_line) = 0,
+        // yields of writers waiting for a slot
+        waits: std.atomic.Value(u64) = std.atomic.Value(u64).init(0),
+
+        /// count is rounded up to a power of two
+        pub fn init(allocator: std.mem.Allocator, count: usize) !Self {
+            const rounded = try std.math.ceilPowerOfTwo(usize, @max(count, 2));
+            const slots = try allocator.alloc(Slot, rounded);
+            for (slots, 0..) |*slot, i| {
+                slot.sequence = std.atomic.Value(usize).init(i);
+                slot.length = 0;
+            }
+
+            return Self{
+                .allocator = allocator,
+                .slots = slots,
+                .mask = rounded - 1,
+            };
+        }
+
+        pub fn deinit(self: *Self) void {
+            self.allocator.free(self.slots);
+            self.* = undefined;
+        }
+
+        /// Copies text into the next slot, false when it was dropped
+        pub fn push(self: *Self, text: []const u8, policy: Policy) bool {
+            var at = self.head.load(.monotonic);
+
+            while (true) {
+                const slot = &self.slots[at & self.mask];
+                const sequence = slot.sequence.load(.acquire);
+                const turn: isize = @bitCast(sequence -% at);
+
+                if (turn == 0) {
+                    // another writer took it first
+                    if (self.head.cmpxchgWeak(at, at + 1, .monotonic, .monotonic)) |current| {
+                        at = current;
+                        continue;
+                    }
+
+                    const length = @min(text.len, line_capacity);
+                    @memcpy(slot.bytes[0..length], text[0..length]);
+                    slot.length = length;
+                    slot.sequence.store(at + 1, .release);
+                    return true;
+                } else if (turn < 0) {
+                    // the reader has not taken the line a lap ago yet
+                    if (policy == .drop) return false;
+
+                    _ = self.waits.fetchAdd(1, .monotonic);
+                    std.Thread.yield() catch {};
+                    at = self.head.load(.monotonic);
+                } else {
+                    at = self.head.load(.monotonic);
+                }
+            }
+        }
+
+        /// The line offset places after the next unread one, null while it
+        /// is not written yet. Valid until release.
+        pub fn peek(self: *Self, offset: usize) ?[]const u8 {
+            const position = self.tail + offset;
+            const slot = &self.slots[position & self.mask];
+            if (slot.sequence.load(.acquire) != position + 1) return null;
+
+            return slot.bytes[0..slot.length];
+        }
+
+        /// Gives the next count slots back to the writers
+        pub fn release(self: *Self, count: usize) void {
+            for (0..count) |i| {
+                const position = self.tail + i;
+                self.slots[position & self.mask].sequence.store(position + self.mask + 1, .release);
+            }
+            self.tail += count;
+        }
+    };
+}
+
+fn pushNumbers(ring: *Ring(16), writer: u8, count: usize) void {
+    var text: [16]u8 = undefined;
+    for (0..count) |i| {
+        const written = std.fmt.bufPrint(&text, "{d} {d}", .{ writer, i }) catch unreachable;
+        _ = ring.push(written, .block);
+    }
+}
+
+test "blocking writers keep every line, each in its order" {
+    var ring = try Ring(16).init(std.testing.allocator, 8);
+    defer ring.deinit();
+
+    const writers = 4;
+    const count = 10000;
+    var threads: [writers]std.Thread = undefined;
+    for (&threads, 0..) |*thread, w| thread.* = try std.Thread.spawn(.{}, pushNumbers, .{ &ring, @as(u8, @intCast(w)), @as(usize, count) });
+
+    var next = [_]usize{0} ** writers;
+    var read: usize = 0;
+    while (read < writers * count) {
+        const text = ring.peek(0) orelse {
+            std.Thread.yield() catch {};
+            continue;
+        };
+
+        var fields = std.mem.splitScalar(u8, text, ' ');
+        const w = try std.fmt.parseInt(usize, fields.next().?, 10);
+        const i = try std.fmt.parseInt(usize, fields.next().?, 10);
+        try std.testing.expectEqual(next[w], i);
+        next[w] += 1;
+
+        ring.release(1);
+        read += 1;
+    }
+
+    for (threads) |thread| thread.join();
+    try std.testing.expect(ring.peek(0) == null);
+}
+
+test "a full ring drops under .drop" {
+    var ring = try Ring(16).init(std.testing.allocator, 3);
+    defer ring.deinit();
+
+    // rounded up to 4
+    for (0..4) |_| try std.testing.expect(ring.push("line", .drop));
+    try std.testing.expect(!ring.push("line", .drop));
+
+    ring.release(1);
+    try std.testing.expect(ring.push("again", .drop));
+    try std.testing.expectEqualStrings("line", ring.peek(0).?);
+    try std.testing.expectEqualStrings("again", ring.peek(3).?);
+}
@@ -1 +1,18 @@
 const std = @import("std");
+
+pub const line = @import("line.zig");
+pub const Level = line.Level;
+
+pub const GenericLogger = @import("generic.zig").GenericLogger;
+pub const AsyncLogger = @import("async.zig").AsyncLogger;
+pub const FileSink = @import("sink.zig").FileSink;
+pub const Policy = @import("ring.zig").Policy;
+pub const Ring = @import("ring.zig").Ring;
+
+test {
+    _ = @import("line.zig");
+    _ = @import("generic.zig");
+    _ = @import("async.zig");
+    _ = @import("sink.zig");
+    _ = @import("ring.zig");
+}
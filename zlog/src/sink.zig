@@ -0,0 +1,157 @@
+const std = @import("std");
+
+/// Appends lines to a file through a buffer, and moves the file aside once
+/// it reaches a size: path becomes path.1, path.1 becomes path.2 and so on,
+/// the oldest beyond keep is deleted.
+pub const FileSink = struct {
+    pub const Options = struct {
+        /// bytes gathered before they go to the file
+        buffer_size: usize = 64 * 1024,
+        /// size at which the file is rotated, 0 to let it grow
+        max_bytes: u64 = 16 * 1024 * 1024,
+        /// rotated files kept, 0 starts the file over instead
+        keep: u8 = 5,
+    };
+
+    allocator: std.mem.Allocator,
+    dir: std.fs.Dir,
+    path: []u8,
+    options: Options,
+    file: std.fs.File,
+    buffer: []u8,
+    buffered: usize = 0,
+    // of the current file, buffered bytes included
+    size: u64,
+    rotations: u64 = 0,
+
+    /// Appends to path when it exists. dir must stay open while the sink is used.
+    pub fn init(allocator: std.mem.Allocator, dir: std.fs.Dir, path: []const u8, options: Options) !FileSink {
+        const owned = try allocator.dupe(u8, path);
+        errdefer allocator.free(owned);
+
+        const buffer = try allocator.alloc(u8, options.buffer_size);
+        errdefer allocator.free(buffer);
+
+        const file = try dir.createFile(path, .{ .truncate = false });
+        errdefer file.close();
+
+        const size = try file.getEndPos();
+        try file.seekTo(size);
+
+        return FileSink{
+            .allocator = allocator,
+            .dir = dir,
+            .path = owned,
+            .options = options,
+            .file = file,
+            .buffer = buffer,
+            .size = size,
+        };
+    }
+
+    /// Writes what is buffered first
+    pub fn deinit(self: *FileSink) void {
+        self.flush() catch {};
+        self.file.close();
+        self.allocator.free(self.buffer);
+        self.allocator.free(self.path);
+        self.* = undefined;
+    }
+
+    pub fn write(self: *FileSink, bytes: []const u8) !void {
+        // a line never spans two files
+        if (self.options.max_bytes > 0 and self.size > 0 and self.size + bytes.len > self.options.max_bytes)
+            try self.rotate();
+
+        if (self.buffered + bytes.len > self.buffer.len) {
+            try self.flush();
+
+            // larger than the whole buffer, straight to the file
+            if (bytes.len > self.buffer.len) {
+                try self.file.writeAll(bytes);
+                self.size += bytes.len;
+                return;
+            }
+        }
+
+        @memcpy(self.buffer[self.buffered..][0..bytes.len], bytes);
+        self.buffered += bytes.len;
+        self.size += bytes.len;
+    }
+
+    pub fn flush(self: *FileSink) !void {
+        if (self.buffered == 0) return;
+
+        try self.file.writeAll(self.buffer[0..self.buffered]);
+        self.buffered = 0;
+    }
+
+    // After an error here the file is closed and the sink cannot be used
+    fn rotate(self: *FileSink) !void {
+        try self.flush();
+        self.file.close();
+
+        if (self.options.keep > 0) {
+            var from_buffer: [std.fs.max_path_bytes]u8 = undefined;
+            var to_buffer: [std.fs.max_path_bytes]u8 = undefined;
+
+            // the others move up one, over the oldest
+            var i: usize = self.options.keep;
+            while (i > 1) : (i -= 1) {
+                const from = try std.fmt.bufPrint(&from_buffer, "{s}.{d}", .{ self.path, i - 1 });
+                const to = try std.fmt.bufPrint(&to_buffer, "{s}.{d}", .{ self.path, i });
+                self.dir.rename(from, to) catch |e| switch (e) {
+                    error.FileNotFound => {},
+                    else => return e,
+                };
+            }
+
+            const first = try std.fmt.bufPrint(&to_buffer, "{s}.1", .{self.path});
+            try self.dir.rename(self.path, first);
+        }
+
+        self.file = try self.dir.createFile(self.path, .{ .truncate = true });
+        self.size = 0;
+        self.rotations += 1;
+    }
+};
+
+test "lines wait in the buffer until flushed" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var sink = try FileSink.init(std.testing.allocator, tmp.dir, "app.log", .{ .buffer_size = 64 });
+    defer sink.deinit();
+
+    try sink.write("first\n");
+    try std.testing.expectEqual(@as(u64, 0), (try tmp.dir.statFile("app.log")).size);
+
+    try sink.flush();
+    try std.testing.expectEqual(@as(u64, 6), (try tmp.dir.statFile("app.log")).size);
+}
+
+test "a full file is rotated, keep files are kept" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var sink = try FileSink.init(std.testing.allocator, tmp.dir, "app.log", .{ .buffer_size = 16, .max_bytes = 100, .keep = 2 });
+
+    // 10 bytes a line, 10 lines a file, 4 files written
+    for (0..40) |i| {
+        var text: [16]u8 = undefined;
+        try sink.write(try std.fmt.bufPrint(&text, "line {d:0>4}\n", .{i}));
+    }
+    try std.testing.expectEqual(@as(u64, 3), sink.rotations);
+    sink.deinit();
+
+    const newest = try tmp.dir.readFileAlloc(std.testing.allocator, "app.log", 1024);
+    defer std.testing.allocator.free(newest);
+    try std.testing.expect(std.mem.startsWith(u8, newest, "line 0030\n"));
+    try std.testing.expectEqual(@as(usize, 100), newest.len);
+
+    const older = try tmp.dir.readFileAlloc(std.testing.allocator, "app.log.2", 1024);
+    defer std.testing.allocator.free(older);
+    try std.testing.expect(std.mem.startsWith(u8, older, "line 0010\n"));
+
+    try std.testing.expectError(error.FileNotFound, tmp.dir.access("app.log.3", .{}));
+}
@@ -100,6 +100,23 @@ pub fn build(b: *std.Build) void {
     const run_step = b.step("run", "Run the app");
     run_step.dependOn(&run_cmd.step);
 
+    // The conversion and formatting benchmark, always optimized: `zig build bench`
+    const bench_mod = b.createModule(.{
+        .root_source_file = b.path("src/bench.zig"),
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    bench_mod.addImport("ztemporal_lib", lib_mod);
+
+    const bench = b.addExecutable(.{
+        .name = "ztemporal-bench",
+        .root_module = bench_mod,
+    });
+
+    const run_bench = b.addRunArtifact(bench);
+    const bench_step = b.step("bench", "Run the date conversion and formatting benchmark");
+    bench_step.dependOn(&run_bench.step);
+
     // Creates a step for unit testing. This only builds the test executable
     // but does not run it.
     const lib_unit_tests = b.addTest(.{
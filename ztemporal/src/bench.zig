@@ -0,0 +1,75 @@
+//! Nanoseconds per timestamp: the date found by walking the years and
+//! months from 1970 as from() used to, by the constant-time conversion, and
+//! a whole "YYYY-MM-DD HH:MM:SS.mmm" line printed through std.fmt against
+//! the Formatter. The times advance 1 ms at a time from 2026, as a logger's do.
+const std = @import("std");
+
+const ztemporal = @import("ztemporal_lib");
+
+const iterations = 5_000_000;
+const start: i64 = 1767225600000; // 2026-01-01 00:00:00.000
+
+// The conversion before, kept to compare against
+fn walkFromDays(days: i64) ztemporal.Civil {
+    var year: i32 = 1970;
+    var remaining = days;
+    while (true) {
+        const leap = (@mod(year, 4) == 0 and @mod(year, 100) != 0) or @mod(year, 400) == 0;
+        const days_in_year: i64 = if (leap) 366 else 365;
+        if (remaining < days_in_year) break;
+        remaining -= days_in_year;
+        year += 1;
+    }
+
+    const leap = (@mod(year, 4) == 0 and @mod(year, 100) != 0) or @mod(year, 400) == 0;
+    const days_in_month = [_]u8{ 31, if (leap) 29 else 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    var month: u8 = 1;
+    while (remaining >= days_in_month[month - 1]) {
+        remaining -= days_in_month[month - 1];
+        month += 1;
+    }
+
+    return .{ .year = year, .month = month, .day = @intCast(remaining + 1) };
+}
+
+fn perCall(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / iterations;
+}
+
+pub fn main() !void {
+    const stdout = std.io.getStdOut().writer();
+    var timer = try std.time.Timer.start();
+
+    // every call a different day, so nothing is cached between them
+    timer.reset();
+    for (0..iterations) |i|
+        std.mem.doNotOptimizeAway(walkFromDays(20454 + @as(i64, @intCast(i % 4096))));
+    const walk_ns = timer.read();
+
+    timer.reset();
+    for (0..iterations) |i|
+        std.mem.doNotOptimizeAway(ztemporal.civilFromDays(20454 + @as(i64, @intCast(i % 4096))));
+    const civil_ns = timer.read();
+
+    var buffer: [32]u8 = undefined;
+    timer.reset();
+    for (0..iterations) |i| {
+        const text = try std.fmt.bufPrint(&buffer, "{}", .{ztemporal.DateTime.from(start + @as(i64, @intCast(i)))});
+        std.mem.doNotOptimizeAway(text.ptr);
+    }
+    const print_ns = timer.read();
+
+    var formatter = ztemporal.Formatter{};
+    timer.reset();
+    for (0..iterations) |i| {
+        const text = formatter.format(start + @as(i64, @intCast(i)));
+        std.mem.doNotOptimizeAway(text.ptr);
+    }
+    const formatter_ns = timer.read();
+
+    try stdout.print("{d} calls each\n", .{iterations});
+    try stdout.print("{s:<26} {d:>8.2} ns\n", .{ "days to date, walk", perCall(walk_ns) });
+    try stdout.print("{s:<26} {d:>8.2} ns\n", .{ "days to date, civil", perCall(civil_ns) });
+    try stdout.print("{s:<26} {d:>8.2} ns\n", .{ "timestamp, std.fmt", perCall(print_ns) });
+    try stdout.print("{s:<26} {d:>8.2} ns\n", .{ "timestamp, Formatter", perCall(formatter_ns) });
+}
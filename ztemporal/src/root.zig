@@ -2,8 +2,6 @@ const std = @import("std");
 
 // Days in each month (non-leap year)
 const DAYS_IN_MONTH = [_]u8{ 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-// Cumulative days from start of year to start of each month (non-leap year)
-const DAYS_BEFORE_MONTH = [_]u16{ 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
 
 fn isLeapYear(year: u32) bool {
     return (year % 4 == 0 and year % 100 != 0) or (year % 400 == 0);
@@ -16,56 +14,80 @@ fn daysInMonth(year: u32, month: u8) u8 {
     return DAYS_IN_MONTH[month - 1];
 }
 
-fn calculateFormMillis(unix_millis: i64) DateTime {
-    // Extract milliseconds
-    const millis = @as(u16, @intCast(@mod(unix_millis, 1000)));
+/// Years from() and Formatter cover: the ones printed in four digits,
+/// in the proleptic Gregorian calendar
+pub const min_year = 0;
+pub const max_year = 9999;
+
+const ms_per_day = std.time.ms_per_day;
+
+/// First and last millisecond of the supported years, since the Unix epoch
+pub const min_millis: i64 = daysFromCivil(min_year, 1, 1) * ms_per_day;
+pub const max_millis: i64 = (daysFromCivil(max_year + 1, 1, 1)) * ms_per_day - 1;
+
+pub const Civil = struct {
+    year: i32,
+    month: u8, // 1-12
+    day: u8, // 1-31
+};
 
-    // Convert to seconds
-    const unix_seconds = @divFloor(unix_millis, 1000);
+// Howard Hinnant's algorithms: the calendar counted from 0000-03-01 so the
+// leap day ends the year, in eras of 400 years (146097 days) which all
+// repeat the same way. No loops, any day in constant time.
 
-    // Calculate days since Unix epoch (1970-01-01)
-    const seconds_per_day = 86400;
-    const days_since_epoch = @divFloor(unix_seconds, seconds_per_day);
+/// Year, month and day of a day counted from 1970-01-01
+pub fn civilFromDays(days: i64) Civil {
+    const z = days + 719468; // from 0000-03-01
+    const era = @divFloor(z, 146097);
+    const doe = z - era * 146097; // day of era [0, 146096]
+    const yoe = @divFloor(doe - @divFloor(doe, 1460) + @divFloor(doe, 36524) - @divFloor(doe, 146096), 365); // year of era [0, 399]
+    const doy = doe - (365 * yoe + @divFloor(yoe, 4) - @divFloor(yoe, 100)); // day of the year from March [0, 365]
+    const mp = @divFloor(5 * doy + 2, 153); // month from March [0, 11]
+    const day = doy - @divFloor(153 * mp + 2, 5) + 1;
+    const month = if (mp < 10) mp + 3 else mp - 9;
+    const year = yoe + era * 400 + @intFromBool(month <= 2);
+
+    return Civil{
+        .year = @intCast(year),
+        .month = @intCast(month),
+        .day = @intCast(day),
+    };
+}
+
+/// Days from 1970-01-01 to a date, negative before it
+pub fn daysFromCivil(year: i32, month: u8, day: u8) i64 {
+    const y: i64 = if (month <= 2) year - 1 else year;
+    const era = @divFloor(y, 400);
+    const yoe = y - era * 400;
+    const mp: i64 = if (month > 2) month - 3 else month + 9;
+    const doy = @divFloor(153 * mp + 2, 5) + day - 1;
+    const doe = yoe * 365 + @divFloor(yoe, 4) - @divFloor(yoe, 100) + doy;
+    return era * 146097 + doe - 719468;
+}
+
+fn calculateFormMillis(unix_millis: i64) DateTime {
+    std.debug.assert(unix_millis >= min_millis and unix_millis <= max_millis);
 
-    // Calculate seconds within the day
-    const seconds_in_day = @mod(unix_seconds, seconds_per_day);
+    // Calculate days since Unix epoch (1970-01-01), and milliseconds within the day
+    const days_since_epoch = @divFloor(unix_millis, ms_per_day);
+    const millis_in_day = unix_millis - days_since_epoch * ms_per_day;
 
     // Calculate time components
+    const seconds_in_day = @divFloor(millis_in_day, 1000);
     const hour = @as(u8, @intCast(@divFloor(seconds_in_day, 3600)));
     const minute = @as(u8, @intCast(@divFloor(@mod(seconds_in_day, 3600), 60)));
     const second = @as(u8, @intCast(@mod(seconds_in_day, 60)));
+    const millis = @as(u16, @intCast(@mod(millis_in_day, 1000)));
 
     // Calculate weekday (January 1, 1970 was a Thursday = 4)
     const weekday = @as(u8, @intCast(@mod(days_since_epoch + 4, 7)));
 
-    // Calculate year, month, day
-    var year: u32 = 1970;
-    var remaining_days = days_since_epoch;
-
-    // Handle years
-    while (true) {
-        const days_in_year: i64 = if (isLeapYear(year)) 366 else 365;
-        if (remaining_days < days_in_year) break;
-        remaining_days -= days_in_year;
-        year += 1;
-    }
-
-    // Handle months
-    var month: u8 = 1;
-    while (month <= 12) {
-        const days_in_current_month = daysInMonth(year, month);
-        if (remaining_days < days_in_current_month) break;
-        remaining_days -= days_in_current_month;
-        month += 1;
-    }
-
-    // Remaining days is the day of month (1-based)
-    const day = @as(u8, @intCast(remaining_days + 1));
+    const civil = civilFromDays(days_since_epoch);
 
     return DateTime{
-        .year = year,
-        .month = month,
-        .day = day,
+        .year = @intCast(civil.year),
+        .month = civil.month,
+        .day = civil.day,
         .hour = hour,
         .minute = minute,
         .second = second,
@@ -111,11 +133,85 @@ pub const DateTime = struct {
         return calculateFormMillis(std.time.milliTimestamp());
     }
 
+    /// unix_millis between min_millis and max_millis
     pub fn from(unix_millis: i64) DateTime {
         return calculateFormMillis(unix_millis);
     }
+
+    /// Milliseconds since the Unix epoch, the inverse of from
+    pub fn toUnixMillis(self: DateTime) i64 {
+        const days = daysFromCivil(@intCast(self.year), self.month, self.day);
+        const seconds: i64 = @as(i64, self.hour) * 3600 + @as(i64, self.minute) * 60 + self.second;
+        return days * ms_per_day + seconds * 1000 + self.millisecond;
+    }
 };
 
+/// Formats times as DateTime.format does, "YYYY-MM-DD HH:MM:SS.mmm", for
+/// callers formatting close times over and over, like a logger. The last
+/// text is kept: the date is only worked out again when the day changes,
+/// and of the time only the fields that changed are written.
+pub const Formatter = struct {
+    text: [23]u8 = "0000-00-00 00:00:00.000".*,
+    // day of the text since the epoch, and its time fields
+    day: i64 = std.math.minInt(i64),
+    hour: u8 = 0xff,
+    minute: u8 = 0xff,
+    second: u8 = 0xff,
+
+    /// unix_millis between min_millis and max_millis. The text is valid
+    /// until the next call.
+    pub fn format(self: *Formatter, unix_millis: i64) []const u8 {
+        std.debug.assert(unix_millis >= min_millis and unix_millis <= max_millis);
+
+        const days = @divFloor(unix_millis, ms_per_day);
+        const millis_in_day: u32 = @intCast(unix_millis - days * ms_per_day);
+
+        if (days != self.day) {
+            const civil = civilFromDays(days);
+            writeDigits(self.text[0..4], @intCast(civil.year));
+            writeDigits(self.text[5..7], civil.month);
+            writeDigits(self.text[8..10], civil.day);
+            self.day = days;
+            // every time field again
+            self.hour = 0xff;
+            self.minute = 0xff;
+            self.second = 0xff;
+        }
+
+        const seconds_in_day = millis_in_day / 1000;
+        const hour: u8 = @intCast(seconds_in_day / 3600);
+        const minute: u8 = @intCast(seconds_in_day / 60 % 60);
+        const second: u8 = @intCast(seconds_in_day % 60);
+
+        if (hour != self.hour) {
+            writeDigits(self.text[11..13], hour);
+            self.hour = hour;
+        }
+        if (minute != self.minute) {
+            writeDigits(self.text[14..16], minute);
+            self.minute = minute;
+        }
+        if (second != self.second) {
+            writeDigits(self.text[17..19], second);
+            self.second = second;
+        }
+        writeDigits(self.text[20..23], millis_in_day % 1000);
+
+        return &self.text;
+    }
+};
+
+// value in out.len decimal digits, zeros first
+fn writeDigits(out: []u8, value: u32) void {
+    var rest = value;
+    var i = out.len;
+    while (i > 0) {
+        i -= 1;
+        out[i] = '0' + @as(u8, @intCast(rest % 10));
+        rest /= 10;
+    }
+}
+
 test "from 0" {
     const allocator = std.testing.allocator;
     const dt = try DateTime.from(0).ISO(allocator);
@@ -123,3 +219,72 @@ test "from 0" {
 
     try std.testing.expectEqualStrings("1970-01-01T00:00:00.000Z", dt);
 }
+
+test "known dates" {
+    var buffer: [32]u8 = undefined;
+
+    try std.testing.expectEqualStrings("2009-02-13 23:31:30.123", try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(1234567890123)}));
+    try std.testing.expectEqualStrings("2000-02-29 12:00:00.000", try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(951825600000)}));
+    try std.testing.expectEqualStrings("1969-12-31 23:59:59.999", try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(-1)}));
+    try std.testing.expectEqualStrings("0000-01-01 00:00:00.000", try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(min_millis)}));
+    try std.testing.expectEqualStrings("9999-12-31 23:59:59.999", try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(max_millis)}));
+
+    // a Friday
+    try std.testing.expectEqual(@as(u8, 5), DateTime.from(1234567890123).weekday);
+}
+
+test "every day of the supported years, both ways" {
+    // the calendar walked one day at a time, as the conversion once did
+    var year: u32 = min_year;
+    var month: u8 = 1;
+    var day: u8 = 1;
+    var days = daysFromCivil(min_year, 1, 1);
+
+    while (year <= max_year) : (days += 1) {
+        const civil = civilFromDays(days);
+        try std.testing.expectEqual(@as(i32, @intCast(year)), civil.year);
+        try std.testing.expectEqual(month, civil.month);
+        try std.testing.expectEqual(day, civil.day);
+        try std.testing.expectEqual(days, daysFromCivil(civil.year, civil.month, civil.day));
+
+        day += 1;
+        if (day > daysInMonth(year, month)) {
+            day = 1;
+            month += 1;
+            if (month > 12) {
+                month = 1;
+                year += 1;
+            }
+        }
+    }
+
+    try std.testing.expectEqual(@as(i64, 0), daysFromCivil(1970, 1, 1));
+    try std.testing.expectEqual(@divFloor(max_millis, ms_per_day) + 1, days);
+}
+
+test "from and toUnixMillis are inverses" {
+    // a stride that lands on every hour, minute, second and millisecond
+    const stride: i64 = 7 * ms_per_day + 3 * std.time.ms_per_hour + 7 * std.time.ms_per_min + 11 * std.time.ms_per_s + 13;
+    var millis = min_millis;
+    while (millis <= max_millis) : (millis += stride)
+        try std.testing.expectEqual(millis, DateTime.from(millis).toUnixMillis());
+
+    try std.testing.expectEqual(max_millis, DateTime.from(max_millis).toUnixMillis());
+}
+
+test "the formatter writes what DateTime.format does" {
+    var formatter = Formatter{};
+    var buffer: [32]u8 = undefined;
+
+    // forward by odd steps over second, minute, hour and day changes, then
+    // jumps both ways
+    var millis: i64 = 1234567890123;
+    for (0..20000) |i| {
+        millis += @intCast(i % 977);
+        try std.testing.expectEqualStrings(try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(millis)}), formatter.format(millis));
+    }
+
+    const jumps = [_]i64{ 0, -1, max_millis, min_millis, 951825600000, 951825599999, 1234567890123, 1234567890123 };
+    for (jumps) |jump|
+        try std.testing.expectEqualStrings(try std.fmt.bufPrint(&buffer, "{}", .{DateTime.from(jump)}), formatter.format(jump));
+}